@@ -1,5 +1,6 @@
 #include "App.h"
 
+#if !HEADLESS
 #include <d3d11.h>
 #pragma comment(lib, "d3d11.lib")
 
@@ -12,13 +13,49 @@
 #include <DirectXTex.h>
 #pragma comment(lib, "DirectXTex.lib")
 
+#include <DirectXMath.h>
+#endif
+
 #include <WS2tcpip.h>
 
-#include <DirectXMath.h>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Simulation.h"
+#include "Protocol.h"
+#include "Channel.h"
+#include "Concurrency.h"
+#include "Interpolation.h"
+#include "NetStats.h"
+#if !HEADLESS
+#include "DDSTextureLoader11.h"
+#include "ShaderCache.h"
+#endif
+#include "Startup.h"
+#include "TimeSync.h"
+#if USE_ROLLBACK
+#include "Rollback.h"
+#endif
+#if NET_IMPAIRMENT
+#include "Impairment.h"
+#endif
 
-#include "WICTextureLoader.h"
+static_assert(!HEADLESS || SERVER, "HEADLESS requires SERVER");
+static_assert(!NET_IMPAIRMENT || USE_UDP, "NET_IMPAIRMENT requires USE_UDP");
+static_assert(ROLLBACK_INPUT_DELAY >= 0 && ROLLBACK_INPUT_DELAY <= 8, "ROLLBACK_INPUT_DELAY must be in [0, 8]");
 
+#if !HEADLESS
 LRESULT CALLBACK WndProc(
 	const HWND hWnd,
 	const UINT message,
@@ -46,7 +83,19 @@ struct ConstantBuffer
 };
 static_assert(sizeof(ConstantBuffer) % 16 == 0, "");
 
-//  
+// 셰이더 캐시 키에도 들어가므로 바꾸면 다시 컴파일
+#if defined(_DEBUG) || defined(DEBUG)
+static constexpr UINT SHADER_COMPILE_FLAGS = D3DCOMPILE_DEBUG;
+#else
+static constexpr UINT SHADER_COMPILE_FLAGS = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+static const char* SHADER_CACHE_DIRECTORY = "ShaderCache";
+
+// SimpleNetworkTextureCooker로 만든 DDS(블록 압축, 밉 포함)가 있으면 PNG 대신 사용
+static const wchar_t* BG_TEXTURE_PNG_PATH = L"SNES - The Legend of Zelda A Link to the Past - Light World.png";
+static const wchar_t* BG_TEXTURE_DDS_PATH = L"SNES - The Legend of Zelda A Link to the Past - Light World.dds";
+
+// 윈도우 관련
 static const TCHAR* CLASS_NAME = TEXT("SimpleNetworkGame");
 static HINSTANCE shInstance = nullptr;
 static HWND shWnd = nullptr;
@@ -75,19 +124,296 @@ static ID3D11SamplerState* spSampler = nullptr;
 static D3D11_VIEWPORT sViewport;
 
 static ID3D11RenderTargetView* spRTV = nullptr;
+#endif
+
+enum
+{
+	PORT = 25565,
 
-// 
-static SOCKET sSock;
+	// 시작 단계 중 동시에 실행할 수 있는 최대 수 (장치, 셰이더 2개, PNG, 소켓)
+	MAX_STARTUP_WORKER_COUNT = 5,
+
+	// 클라이언트가 서버보다 먼저 뜨면 이 간격으로 다시 접속
+	CONNECT_RETRY_INTERVAL_MS = 500,
+
+	// 밀려서 한꺼번에 온 입력을 받아줄 최대 틱 수, 넘는 입력은 빠르게 움직이려는 것으로 보고 버림 (Server.cpp와 같음)
+	MAX_INPUT_BUDGET = Simulation::TICK_RATE_HZ
+};
+
+// 소켓
+static SOCKET sSock = INVALID_SOCKET;
+
+// 서버는 listen/UDP bind 주소, 클라이언트는 접속할 서버 주소
+static sockaddr_in sSocketAddr;
+
+// 접속은 별도 스레드에서 기다리고 메인 스레드는 그동안 창만 갱신
+// 접속 스레드가 소켓과 수신 스레드를 모두 준비한 뒤 true
+static std::atomic<bool> sbPeerConnected(false);
+static std::atomic<bool> sbConnectCanceled(false);
+static HANDLE shConnectThread = nullptr;
+#if SERVER
+// accept 중에 종료하면 닫아서 깨움, 먼저 가져간 쪽이 닫음
+static std::atomic<SOCKET> sListeningSock(INVALID_SOCKET);
+#endif
+
+// 시작 시각, 접속까지 걸린 시간 출력용
+static double sStartupTime;
 
 static HANDLE shPeerDataThread;
 static DWORD sPeerDataThreadID;
 
-static void updateMyData();
+// 송신(메인 스레드)과 수신(USE_UDP면 UDP 스레드, 아니면 TCP 스레드)이 함께 사용
+static std::mutex sChannelMutex;
+
+#if USE_UDP
+static SOCKET sUdpSock = INVALID_SOCKET;
+
+// 서버는 클라이언트의 첫 UDP 패킷을 받아야 포트를 알 수 있음
+static sockaddr_in sPeerUdpAddr;
+static std::atomic<bool> sbPeerUdpAddrKnown(false);
+
+static Channel::AckTracker sAcks;
+static Channel::UnreliableSequenced sPositionChannel;
+static Channel::ReliableOrdered sEventChannel;
+
+static HANDLE shPeerUdpThread;
+static DWORD sPeerUdpThreadID;
+
+// 상대가 보낸 신뢰성 메시지에 ack를 바로 돌려줘야 하는지
+static std::atomic<bool> sbAckPending(false);
+
+#if NET_IMPAIRMENT
+static Impairment::Config makeImpairmentConfig(const uint32_t seed)
+{
+	return {
+		IMPAIR_DELAY_MS / 1000.0,
+		IMPAIR_JITTER_MS / 1000.0,
+		IMPAIR_LOSS_PERCENT / 100.0,
+		IMPAIR_DUPLICATE_PERCENT / 100.0,
+		IMPAIR_REORDER_PERCENT / 100.0,
+		IMPAIR_REORDER_DELAY_MS / 1000.0,
+		IMPAIR_BANDWIDTH_KBPS * 1000.0 / 8.0,
+		64 * 1024,
+		seed
+	};
+}
+
+// 메인 스레드 전용, 보낼 패킷을 여기에 넣고 도착 시각이 된 것만 실제로 보냄
+static Impairment::Link sImpairedSendLink(makeImpairmentConfig(IMPAIR_SEED));
+
+// UDP 스레드가 받은 패킷을 넣고 메인 스레드가 도착 시각이 된 것만 처리, sImpairedRecvMutex로 보호
+// 메인 스레드는 틱마다 깨어나므로 지연이 틱 간격보다 짧으면 최대 한 틱 늦게 처리될 수 있음
+static std::mutex sImpairedRecvMutex;
+static Impairment::Link sImpairedRecvLink(makeImpairmentConfig(IMPAIR_SEED + 1));
+#endif
+#endif
+
+// 아래는 모두 sChannelMutex로 보호
+// 클라이언트는 위치 대신 입력을 보내고 서버가 적용한 위치를 따름
+#if USE_ROLLBACK
+// 받은 상대 입력과, 상대가 다음에 필요하다고 알려온 내 입력의 틱
+static std::vector<Protocol::InputPayload> sReceivedInputs;
+static uint32_t sPeerInputAck;
+#elif SERVER
+// 서버가 클라이언트 입력으로 움직인 클라이언트 위치의 기준
+static bool sbPeerInputReceived;
+static uint32_t sLastPeerInputTick;
+static bool sbPeerStateDirty;
+
+// 한 틱이 지날 때마다 하나씩 쌓이고 입력을 적용할 때마다 하나씩 씀
+static uint32_t sPeerInputBudget = MAX_INPUT_BUDGET;
+static uint32_t sPeerInputBudgetTick;
+static uint64_t sDroppedPeerInputCount;
+#else
+static Protocol::PlayerStatePayload sAuthoritativeState;
+static bool sbAuthoritativeStatePending;
+#endif
+
+// 위치/입력 변경 감지
+static Channel::SendThrottle sPositionThrottle(POSITION_HEARTBEAT_MS / 1000.0, MAX_POSITION_SEND_RATE);
+
+#if USE_ROLLBACK
+// 상대 입력이 예측 한도보다 늦어서 진행하지 못한 틱 수
+static uint64_t sRollbackStallCount;
+#elif SERVER
+static Protocol::PositionPayload sLastSentPosition;
+#else
+static Simulation::InputPrediction sPrediction;
+#endif
+
+// 게임 상태, 시작 위치는 서버가 왼쪽
+static constexpr Simulation::Float2 PLAYER1_START_POS = { -0.05f, 0.f };
+static constexpr Simulation::Float2 PLAYER2_START_POS = { 0.05f, 0.f };
+
+#if USE_ROLLBACK
+// 메인 스레드 전용, 서버가 0번 플레이어
+static const Simulation::Float2 ROLLBACK_START_POSITIONS[Rollback::PLAYER_COUNT] = { PLAYER1_START_POS, PLAYER2_START_POS };
+static Rollback::Session sRollbackSession(SERVER ? 0 : 1, Rollback::MakeInitialState(ROLLBACK_START_POSITIONS), ROLLBACK_INPUT_DELAY);
+#endif
+
+static Simulation::PlayerState sMyState;
+
+// 수신 스레드 전용, 서버에서는 클라이언트 입력을 적용한 권한 있는 위치
+static Simulation::Float2 sPeerPos;
+
+// 수신 스레드 -> 메인 스레드로 받은 상대 위치 전달
+// 생산자는 위치를 받는 스레드 하나뿐 (USE_UDP면 UDP 스레드, NET_IMPAIRMENT면 메인 스레드, 아니면 TCP 스레드)
+struct PeerSnapshot
+{
+	double remoteTime;
+	double receivedTime;
+	Simulation::Float2 pos;
+};
+static Concurrency::SpscQueue<PeerSnapshot, 256> sPeerSnapshotQueue;
+
+// 아래는 메인 스레드 전용
+// 받은 상대 위치를 모아두고 지연을 둔 시점으로 보간해서 그림
+static Interpolation::SnapshotBuffer sPeerSnapshots(std::max(1.0 / MAX_POSITION_SEND_RATE, Simulation::TICK_INTERVAL));
+static Simulation::Float2 sLatestPeerPos;
+
+// 지연/시계 차이 측정, 수신 스레드와 메인 스레드가 함께 사용 (sTimingMutex로 보호)
+// UDP 스레드는 sChannelMutex를 잡은 채로 들어오므로 메인 스레드는 두 락을 겹쳐 잡지 않음
+static std::mutex sTimingMutex;
+static TimeSync::Estimator sTimeSync;
+
+// 받은 ping에 대한 응답, 메인 스레드가 다음 전송 때 보낸 시각을 채워서 보냄
+static Protocol::PongPayload sPendingPong;
+static bool sbPongPending;
+
+// 송수신 스레드가 각자의 샤드에 카운터를 쌓고 메인 스레드가 합쳐서 출력
+static NetStats::Dumper sNetStatsDumper;
+
+static double getTime();
+static DWORD WINAPI connectPeer(const LPVOID lpParam);
+static void updateMyData(const uint32_t tick);
+static size_t writeStateMessages(uint8_t* pOutBuffer, const size_t bufferSize, const uint32_t tick, const double now);
 static DWORD WINAPI updatePeerData(const LPVOID lpParam);
+#if USE_UDP
+static DWORD WINAPI updatePeerDataUdp(const LPVOID lpParam);
+static void handleUdpPacket(const uint8_t* pPacket, const size_t packetSize);
+static void sendUdpDatagram(const uint8_t* pPacket, const size_t packetSize);
+static bool sendEvent(const Protocol::EMessageType type, const uint32_t tick, const void* pPayload, const size_t payloadSize);
+static void sendUdpPacket(const uint8_t* pMessages, const size_t messagesSize);
+#endif
+#if NET_IMPAIRMENT
+static void flushImpairedLink();
+#endif
+
+#if !HEADLESS
+// 실행 파일이 있는 디렉터리, 빌드가 만든 .cso와 셰이더 캐시를 여기에 둠
+static std::string getExecutableDirectory()
+{
+	char path[MAX_PATH];
+	const DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+
+	const std::string executablePath(path, length);
+
+	return executablePath.substr(0, executablePath.find_last_of("\\/") + 1);
+}
+
+static bool compileShader(const ShaderCache::ShaderDesc& desc, std::vector<uint8_t>& outBytecode)
+{
+	// define을 쓰게 되면 D3D_SHADER_MACRO로 넘겨야 함
+	assert(desc.defines.empty());
+
+	// 셰이더 파일 이름은 ASCII만 사용
+	const std::wstring sourcePath(desc.sourcePath.begin(), desc.sourcePath.end());
+
+	ID3DBlob* pShaderBlob = nullptr;
+	ID3DBlob* pErrorMsg = nullptr;
+
+	const HRESULT hr = D3DCompileFromFile(
+		sourcePath.c_str(),
+		nullptr,
+		D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		desc.entryPoint.c_str(),
+		desc.target.c_str(),
+		desc.flags,
+		0,
+		&pShaderBlob,
+		&pErrorMsg
+	);
+
+	if (pErrorMsg != nullptr)
+	{
+		std::cerr << static_cast<const char*>(pErrorMsg->GetBufferPointer()) << std::endl;
+	}
+	App::ReleaseCOM(pErrorMsg);
+
+	if (FAILED(hr))
+	{
+		return false;
+	}
+
+	const uint8_t* pBytecode = static_cast<const uint8_t*>(pShaderBlob->GetBufferPointer());
+	outBytecode.assign(pBytecode, pBytecode + pShaderBlob->GetBufferSize());
+	App::ReleaseCOM(pShaderBlob);
+
+	return true;
+}
+
+// 빌드가 만든 .cso가 소스보다 새로우면 그대로, 아니면 셰이더 캐시에서 찾고 없을 때만 컴파일
+// 장치가 필요 없으므로 다른 단계와 동시에 실행
+static std::vector<uint8_t> loadShader(const char* pSourcePath, const char* pPrebuiltName, const char* pTarget)
+{
+	ShaderCache::ShaderDesc desc;
+	desc.sourcePath = pSourcePath;
+	desc.entryPoint = "main";
+	desc.target = pTarget;
+	desc.flags = SHADER_COMPILE_FLAGS;
+
+	const std::string executableDirectory = getExecutableDirectory();
+
+	std::vector<uint8_t> bytecode;
+	const ShaderCache::ESource source = ShaderCache::Load(
+		desc,
+		executableDirectory + pPrebuiltName,
+		executableDirectory + SHADER_CACHE_DIRECTORY,
+		compileShader,
+		bytecode
+	);
+	ASSERT(source != ShaderCache::SOURCE_FAILED, "Loading shader failed");
+
+	std::ostringstream message;
+	message << pSourcePath << ": " << ShaderCache::GetSourceName(source) << " (" << bytecode.size() << " bytes)";
+	std::cout << message.str() << std::endl;
+
+	return bytecode;
+}
+#endif
 
 void App::Initialize()
 {
-	//  ʱȭ
+	sStartupTime = getTime();
+
+	// 게임 상태 초기화
+	{
+#if SERVER
+		sMyState.pos = PLAYER1_START_POS;
+		sPeerPos = PLAYER2_START_POS;
+#else
+		sMyState.pos = PLAYER2_START_POS;
+		sPeerPos = PLAYER1_START_POS;
+#endif
+		sMyState.prevPos = sMyState.pos;
+		sLatestPeerPos = sPeerPos;
+	}
+
+	// 창, 장치, 셰이더, 텍스처, 소켓을 의존 관계 순서로 동시에 준비
+	Startup::TaskGraph startup;
+
+#if !HEADLESS
+	typedef Startup::TaskGraph::TaskId TaskId;
+
+	// 단계 사이에 넘기는 중간 결과, startup.Run이 반환할 때까지만 사용
+	std::vector<uint8_t> vsBytecode;
+	std::vector<uint8_t> psBytecode;
+	ID3D11InputLayout* pInputLayout = nullptr;
+	ScratchImage bgImage;
+	bool bCookedBgTexture = false;
+
+	// 윈도우 초기화
+	const TaskId windowTask = startup.Add("window", []()
 	{
 		shInstance = static_cast<HINSTANCE>(GetModuleHandle(nullptr));
 
@@ -131,9 +457,76 @@ void App::Initialize()
 #else
 		SetWindowText(shWnd, TEXT("Client"));
 #endif
-	}
+	}, {}, Startup::TaskGraph::MAIN_THREAD);
+
+	// 장치는 스왑 체인 없이 먼저 만들어서 창을 기다리지 않고 리소스를 만들 수 있게 함
+	const TaskId deviceTask = startup.Add("device", []()
+	{
+		UINT creationFlags = 0;
+#if defined(_DEBUG) || defined(DEBUG)
+		creationFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+		const D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+
+		const HRESULT hr = D3D11CreateDevice(
+			nullptr,
+			D3D_DRIVER_TYPE_HARDWARE,
+			nullptr,
+			creationFlags,
+			&featureLevel,
+			1,
+			D3D11_SDK_VERSION,
+			&spDevice,
+			nullptr,
+			&spContext
+		);
+		ASSERT(SUCCEEDED(hr), "CreateDevice failed");
+	});
+
+	// .cso 이름은 FxCompile 기본 출력 ($(OutDir)%(Filename).cso)
+	const TaskId vsLoadTask = startup.Add("load VS", [&vsBytecode]()
+	{
+		vsBytecode = loadShader("VS.hlsl", "VS.cso", "vs_5_0");
+	});
+
+	const TaskId psLoadTask = startup.Add("load PS", [&psBytecode]()
+	{
+		psBytecode = loadShader("BgPS.hlsl", "BgPS.cso", "ps_5_0");
+	});
+
+	// PNG 디코딩과 밉 생성은 CPU에서 하므로 장치를 기다리지 않음
+	const TaskId bgDecodeTask = startup.Add("decode PNG", [&bgImage, &bCookedBgTexture]()
+	{
+		// 미리 변환한 DDS는 디코딩할 것이 없으므로 bg texture 단계에서 파일을 바로 올림
+		if (GetFileAttributesW(BG_TEXTURE_DDS_PATH) != INVALID_FILE_ATTRIBUTES)
+		{
+			bCookedBgTexture = true;
+			return;
+		}
+
+		// WIC는 COM 객체이므로 이 스레드에서 초기화, 이후로는 WIC를 쓰지 않음
+		HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+		ASSERT(SUCCEEDED(hr), "CoInitializeEx failed");
+
+		ScratchImage image;
+		hr = LoadFromWICFile(
+			BG_TEXTURE_PNG_PATH,
+			WIC_FLAGS_NONE,
+			nullptr,
+			image
+		);
+		ASSERT(SUCCEEDED(hr), "Decoding bg texture failed");
 
-	// D3D ʱȭ
+		// CreateWICTextureFromFile이 즉시 컨텍스트에서 만들던 밉을 여기서 미리 만듦
+		hr = GenerateMipMaps(*image.GetImage(0, 0, 0), TEX_FILTER_DEFAULT, 0, bgImage);
+		ASSERT(SUCCEEDED(hr), "GenerateMipMaps for bg texture failed");
+
+		CoUninitialize();
+	});
+
+	// 스왑 체인은 창에 메시지를 보내므로 창을 만든 스레드에서 생성
+	const TaskId swapChainTask = startup.Add("swap chain", []()
 	{
 		DXGI_SWAP_CHAIN_DESC swapChainDesc;
 		ZeroMemory(&swapChainDesc, sizeof(swapChainDesc));
@@ -149,99 +542,99 @@ void App::Initialize()
 		swapChainDesc.SampleDesc.Count = 1;
 		swapChainDesc.Windowed = true;
 
-		UINT creationFlags = 0;
-#if defined(_DEBUG) || defined(DEBUG)
-		creationFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
+		// 장치를 만든 팩토리에서 생성
+		IDXGIDevice* pDxgiDevice = nullptr;
+		IDXGIAdapter* pAdapter = nullptr;
+		IDXGIFactory* pFactory = nullptr;
 
-		const D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+		HRESULT hr = spDevice->QueryInterface(IID_PPV_ARGS(&pDxgiDevice));
+		ASSERT(SUCCEEDED(hr), "QueryInterface for IDXGIDevice failed");
 
-		HRESULT hr = D3D11CreateDeviceAndSwapChain(
-			nullptr,
-			D3D_DRIVER_TYPE_HARDWARE,
+		hr = pDxgiDevice->GetAdapter(&pAdapter);
+		ASSERT(SUCCEEDED(hr), "GetAdapter failed");
+
+		hr = pAdapter->GetParent(IID_PPV_ARGS(&pFactory));
+		ASSERT(SUCCEEDED(hr), "GetParent for IDXGIFactory failed");
+
+		hr = pFactory->CreateSwapChain(spDevice, &swapChainDesc, &spSwapChain);
+		ASSERT(SUCCEEDED(hr), "CreateSwapChain failed");
+
+		ReleaseCOM(pFactory);
+		ReleaseCOM(pAdapter);
+		ReleaseCOM(pDxgiDevice);
+
+		ID3D11Texture2D* pBackBuffer = nullptr;
+		hr = spSwapChain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer));
+		ASSERT(SUCCEEDED(hr), "GetBuffer for backBuffer failed");
+
+		assert(pBackBuffer != nullptr);
+		hr = spDevice->CreateRenderTargetView(
+			pBackBuffer,
 			nullptr,
-			creationFlags,
-			&featureLevel,
-			1,
-			D3D11_SDK_VERSION,
-			&swapChainDesc,
-			&spSwapChain,
-			&spDevice,
+			&spRTV
+		);
+		ReleaseCOM(pBackBuffer);
+	}, { windowTask, deviceTask }, Startup::TaskGraph::MAIN_THREAD);
+
+	const TaskId shaderTask = startup.Add("create shaders", [&vsBytecode, &psBytecode, &pInputLayout]()
+	{
+		HRESULT hr = spDevice->CreateVertexShader(
+			vsBytecode.data(),
+			vsBytecode.size(),
 			nullptr,
-			&spContext
+			&spVS
 		);
-		ASSERT(SUCCEEDED(hr), "CreateDeviceAndSwapChain failed");
-
-		ID3DBlob* pShaderBlob = nullptr;
-		ID3DBlob* pErrorMsg = nullptr;
-		{
-			hr = D3DCompileFromFile(
-				TEXT("VS.hlsl"),
-				nullptr,
-				D3D_COMPILE_STANDARD_FILE_INCLUDE,
-				"main",
-				"vs_5_0",
-				D3DCOMPILE_DEBUG,
-				0,
-				&pShaderBlob,
-				&pErrorMsg
-			);
-			ASSERT(SUCCEEDED(hr), "Compiling vertex shader failed");
+		ASSERT(SUCCEEDED(hr), "CreateVertexShader failed");
 
-			hr = spDevice->CreateVertexShader(
-				pShaderBlob->GetBufferPointer(),
-				pShaderBlob->GetBufferSize(),
-				nullptr,
-				&spVS
-			);
-			ASSERT(SUCCEEDED(hr), "CreateVertexShader failed");
+		constexpr int NUM_ELEMENTS = 2;
+		D3D11_INPUT_ELEMENT_DESC inputElements[NUM_ELEMENTS] = {
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, sizeof(BgVertex::pos), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		};
 
-			constexpr int NUM_ELEMENTS = 2;
-			D3D11_INPUT_ELEMENT_DESC inputElements[NUM_ELEMENTS] = {
-				{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-				{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, sizeof(BgVertex::pos), D3D11_INPUT_PER_VERTEX_DATA, 0},
-			};
+		hr = spDevice->CreateInputLayout(
+			inputElements,
+			NUM_ELEMENTS,
+			vsBytecode.data(),
+			vsBytecode.size(),
+			&pInputLayout
+		);
+		ASSERT(SUCCEEDED(hr), "CreateInputLayout failed");
 
-			ID3D11InputLayout* pInputLayout = nullptr;
-			{
-				hr = spDevice->CreateInputLayout(
-					inputElements,
-					NUM_ELEMENTS,
-					pShaderBlob->GetBufferPointer(),
-					pShaderBlob->GetBufferSize(),
-					&pInputLayout
-				);
-				ASSERT(SUCCEEDED(hr), "CreateInputLayout failed");
-
-				spContext->IASetInputLayout(pInputLayout);
-			}
-			ReleaseCOM(pInputLayout);
-			ReleaseCOM(pShaderBlob);
-
-			hr = D3DCompileFromFile(
-				TEXT("BgPS.hlsl"),
-				nullptr,
-				D3D_COMPILE_STANDARD_FILE_INCLUDE,
-				"main",
-				"ps_5_0",
-				D3DCOMPILE_DEBUG,
-				0,
-				&pShaderBlob,
-				&pErrorMsg
-			);
-			ASSERT(SUCCEEDED(hr), "Compiling pixel shader failed");
+		hr = spDevice->CreatePixelShader(
+			psBytecode.data(),
+			psBytecode.size(),
+			nullptr,
+			&spPS
+		);
+		ASSERT(SUCCEEDED(hr), "CreatePixelShader failed");
+	}, { deviceTask, vsLoadTask, psLoadTask });
 
-			hr = spDevice->CreatePixelShader(
-				pShaderBlob->GetBufferPointer(),
-				pShaderBlob->GetBufferSize(),
-				nullptr,
-				&spPS
-			);
-			ASSERT(SUCCEEDED(hr), "CreatePixelShader failed");
+	const TaskId bgTextureTask = startup.Add("bg texture", [&bgImage, &bCookedBgTexture]()
+	{
+		if (bCookedBgTexture)
+		{
+			// 컨텍스트를 받지 않는 오버로드는 밉 자동 생성을 하지 않으므로 작업 스레드에서 호출해도 됨
+			const HRESULT hr = CreateDDSTextureFromFile(spDevice, BG_TEXTURE_DDS_PATH, nullptr, &spBgTextureView);
+			ASSERT(SUCCEEDED(hr), "CreateDDSTextureFromFile for bg texture failed");
+
+			return;
 		}
-		ReleaseCOM(pShaderBlob);
-		ReleaseCOM(pErrorMsg);
 
+		const HRESULT hr = CreateShaderResourceView(
+			spDevice,
+			bgImage.GetImages(),
+			bgImage.GetImageCount(),
+			bgImage.GetMetadata(),
+			&spBgTextureView
+		);
+		ASSERT(SUCCEEDED(hr), "CreateBgTexture failed");
+
+		bgImage.Release();
+	}, { deviceTask, bgDecodeTask });
+
+	const TaskId bufferTask = startup.Add("buffers", []()
+	{
 		BgVertex bgVertices[BG_VERTEX_COUNT] = {
 			{ XMFLOAT3(-1.f, 1.f, 0.f), XMFLOAT2(0.f, 0.f) },
 			{ XMFLOAT3(1.f, 1.f, 0.f), XMFLOAT2(1.f, 0.f) },
@@ -262,11 +655,11 @@ void App::Initialize()
 
 		initData.pSysMem = bgVertices;
 
-		hr = spDevice->CreateBuffer(&bufferDesc, &initData, &spBgVertexBuffer);
+		HRESULT hr = spDevice->CreateBuffer(&bufferDesc, &initData, &spBgVertexBuffer);
 		ASSERT(SUCCEEDED(hr), "CreateBuffer for bgVertices failed");
 
-		sPlayer1PosBufferCPU.pos = { -0.05f, 0.f };
-		sPlayer2PosBufferCPU.pos = { 0.05f, 0.f };
+		sPlayer1PosBufferCPU.pos = { PLAYER1_START_POS.x, PLAYER1_START_POS.y };
+		sPlayer2PosBufferCPU.pos = { PLAYER2_START_POS.x, PLAYER2_START_POS.y };
 
 		bufferDesc.Usage = D3D11_USAGE_DEFAULT;
 		bufferDesc.ByteWidth = sizeof(ConstantBuffer);
@@ -290,16 +683,6 @@ void App::Initialize()
 		sViewport.MinDepth = 0.f;
 		sViewport.MaxDepth = 1.f;
 
-		assert(spDevice != nullptr);
-		hr = CreateWICTextureFromFile(
-			spDevice,
-			spContext,
-			TEXT("SNES - The Legend of Zelda A Link to the Past - Light World.png"),
-			nullptr,
-			&spBgTextureView
-		);
-		ASSERT(SUCCEEDED(hr), "CreateBgTexture failed");
-
 		D3D11_SAMPLER_DESC samplerDesc;
 		ZeroMemory(&samplerDesc, sizeof(samplerDesc));
 
@@ -312,38 +695,36 @@ void App::Initialize()
 
 		hr = spDevice->CreateSamplerState(&samplerDesc, &spSampler);
 		ASSERT(SUCCEEDED(hr), "CreateSamplerState failed");
+	}, { deviceTask });
 
-		ID3D11Texture2D* pBackBuffer = nullptr;
-		hr = spSwapChain->GetBuffer(0, IID_PPV_ARGS(&pBackBuffer));
-		ASSERT(SUCCEEDED(hr), "GetBuffer for backBuffer failed");
-
-		assert(pBackBuffer != nullptr);
-		hr = spDevice->CreateRenderTargetView(
-			pBackBuffer,
-			nullptr,
-			&spRTV
-		);
-		ReleaseCOM(pBackBuffer);
+	// 즉시 컨텍스트는 스레드에 안전하지 않으므로 메인 스레드에서만 사용
+	startup.Add("bind", [&pInputLayout]()
+	{
+		spContext->IASetInputLayout(pInputLayout);
+		ReleaseCOM(pInputLayout);
 
 		spContext->OMSetRenderTargets(1, &spRTV, nullptr);
 
 		std::cout << "D3D init Success" << std::endl;
-	}
+	}, { swapChainTask, shaderTask, bgTextureTask, bufferTask }, Startup::TaskGraph::MAIN_THREAD);
+#endif
 
-	//
+	// 소켓, 접속은 기다리지 않고 connectPeer 스레드에 맡김
+	startup.Add("socket", []()
 	{
-		enum
-		{
-			PORT = 25565
-		};
-
 		WSADATA wsaData;
 
 		int errorCode = WSAStartup(MAKEWORD(2, 2), &wsaData);
 		ASSERT(errorCode == ERROR_SUCCESS, "WSAStartup failed");
 
+		ZeroMemory(&sSocketAddr, sizeof(sSocketAddr));
+
+		sSocketAddr.sin_family = AF_INET;
+		sSocketAddr.sin_port = htons(PORT);
+
 #if SERVER
-		SOCKET listeningSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		// bind 실패는 접속을 기다리기 전에 바로 알 수 있도록 여기서 처리
+		const SOCKET listeningSock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 		if (listeningSock == INVALID_SOCKET)
 		{
 			ASSERT(false, "socket failed");
@@ -353,14 +734,9 @@ void App::Initialize()
 			return;
 		}
 
-		sockaddr_in hint;
-		ZeroMemory(&hint, sizeof(hint));
-
-		hint.sin_family = AF_INET;
-		hint.sin_addr.S_un.S_addr = htonl(INADDR_ANY);
-		hint.sin_port = htons(PORT);
+		sSocketAddr.sin_addr.S_un.S_addr = htonl(INADDR_ANY);
 
-		errorCode = bind(listeningSock, reinterpret_cast<sockaddr*>(&hint), sizeof(hint));
+		errorCode = bind(listeningSock, reinterpret_cast<sockaddr*>(&sSocketAddr), sizeof(sSocketAddr));
 		if (errorCode == SOCKET_ERROR)
 		{
 			ASSERT(false, "bind failed");
@@ -382,41 +758,11 @@ void App::Initialize()
 			return;
 		}
 
-		sockaddr_in clientSockInfo;
-		int clientSize = sizeof(clientSockInfo);
-
-		sSock = accept(listeningSock, reinterpret_cast<sockaddr*>(&clientSockInfo), &clientSize);
-		if (sSock == INVALID_SOCKET)
-		{
-			ASSERT(false, "accept failed");
-
-			closesocket(listeningSock);
-			WSACleanup();
-
-			return;
-		}
-
-		closesocket(listeningSock);
+		sListeningSock = listeningSock;
 #else
-		sSock = socket(AF_INET, SOCK_STREAM, 0);
-		if (sSock == INVALID_SOCKET)
-		{
-			ASSERT(false, "socket failed");
-
-			WSACleanup();
-
-			return;
-		}
-
-		sockaddr_in hint;
-		ZeroMemory(&hint, sizeof(hint));
-
-		hint.sin_family = AF_INET;
-		hint.sin_port = htons(PORT);
-
 		const char* SERVER_IP = "127.0.0.1";
 
-		errorCode = inet_pton(AF_INET, SERVER_IP, &hint.sin_addr);
+		errorCode = inet_pton(AF_INET, SERVER_IP, &sSocketAddr.sin_addr);
 
 		if (errorCode != 1)
 		{
@@ -426,50 +772,216 @@ void App::Initialize()
 
 			return;
 		}
-
-		errorCode = connect(sSock, reinterpret_cast<sockaddr*>(&hint), sizeof(hint));
-		if (errorCode == SOCKET_ERROR)
-		{
-			ASSERT(false, "connect fialed");
-
-			closesocket(sSock);
-			WSACleanup();
-
-			return;
-		}
-#endif
-
-#if 0
-		DWORD recvTimeout = 17;
-		setsockopt(sSock, SOL_SOCKET, SO_RCVTIMEO, (char*)&recvTimeout, sizeof(recvTimeout));
 #endif
-	}
 
-	// 
-	{
-		shPeerDataThread = CreateThread(
+		shConnectThread = CreateThread(
 			nullptr,
 			0,
-			updatePeerData,
+			connectPeer,
 			nullptr,
 			0,
-			&sPeerDataThreadID
+			nullptr
 		);
 
-		DWORD errorCode = GetLastError();
-		ASSERT(errorCode == ERROR_SUCCESS, "CreateThread failed");
-	}
+		const DWORD threadErrorCode = GetLastError();
+		ASSERT(threadErrorCode == ERROR_SUCCESS, "CreateThread for connect failed");
+	});
+
+	// 동시에 실행할 수 있는 단계 수보다 스레드를 많이 만들지 않음
+	const unsigned hardwareThreadCount = std::thread::hardware_concurrency();
+	startup.Run(std::min(std::max(hardwareThreadCount, 2u) - 1, static_cast<unsigned>(MAX_STARTUP_WORKER_COUNT)));
+	startup.PrintProfile(std::cout);
+
+	sNetStatsDumper.Initialize(NET_STATS_FILE, NET_STATS_INTERVAL_MS / 1000.0, getTime());
 }
 
-void App::Destroy()
+// 접속 스레드, 상대가 접속하면 UDP 소켓과 수신 스레드를 준비한 뒤 sbPeerConnected를 켬
+static DWORD WINAPI connectPeer(const LPVOID lpParam)
 {
-	CloseHandle(shPeerDataThread);
+#if SERVER
+	sockaddr_in clientSockInfo;
+	int clientSize = sizeof(clientSockInfo);
 
-	closesocket(sSock);
-	WSACleanup();
+	const SOCKET listeningSock = sListeningSock;
+	sSock = accept(listeningSock, reinterpret_cast<sockaddr*>(&clientSockInfo), &clientSize);
 
-	ReleaseCOM(spRTV);
-	ReleaseCOM(spBgTextureView);
+	// 기다리는 동안 종료하면 App::Destroy가 먼저 닫아서 accept가 실패함
+	if (sListeningSock.exchange(INVALID_SOCKET) != INVALID_SOCKET)
+	{
+		closesocket(listeningSock);
+	}
+
+	if (sSock == INVALID_SOCKET)
+	{
+		if (!sbConnectCanceled)
+		{
+			ASSERT(false, "accept failed");
+		}
+
+		return 1;
+	}
+#else
+	// 서버가 아직 떠 있지 않으면 다시 시도
+	while (true)
+	{
+		if (sbConnectCanceled)
+		{
+			return 1;
+		}
+
+		sSock = socket(AF_INET, SOCK_STREAM, 0);
+		if (sSock == INVALID_SOCKET)
+		{
+			ASSERT(false, "socket failed");
+
+			return 1;
+		}
+
+		const int errorCode = connect(sSock, reinterpret_cast<sockaddr*>(&sSocketAddr), sizeof(sSocketAddr));
+		if (errorCode != SOCKET_ERROR)
+		{
+			break;
+		}
+
+		closesocket(sSock);
+		sSock = INVALID_SOCKET;
+
+		Sleep(CONNECT_RETRY_INTERVAL_MS);
+	}
+#endif
+
+#if 0
+	DWORD recvTimeout = 17;
+	setsockopt(sSock, SOL_SOCKET, SO_RCVTIMEO, (char*)&recvTimeout, sizeof(recvTimeout));
+#endif
+
+#if USE_UDP
+	sUdpSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sUdpSock == INVALID_SOCKET)
+	{
+		ASSERT(false, "udp socket failed");
+
+		closesocket(sSock);
+
+		return 1;
+	}
+
+#if SERVER
+	// TCP로 접속한 클라이언트와 같은 IP에서 온 패킷만 받음
+	ZeroMemory(&sPeerUdpAddr, sizeof(sPeerUdpAddr));
+	sPeerUdpAddr.sin_family = AF_INET;
+	sPeerUdpAddr.sin_addr = clientSockInfo.sin_addr;
+
+	const int errorCode = bind(sUdpSock, reinterpret_cast<sockaddr*>(&sSocketAddr), sizeof(sSocketAddr));
+#else
+	const int errorCode = connect(sUdpSock, reinterpret_cast<sockaddr*>(&sSocketAddr), sizeof(sSocketAddr));
+#endif
+	if (errorCode == SOCKET_ERROR)
+	{
+		ASSERT(false, "udp bind/connect failed");
+
+		closesocket(sUdpSock);
+		closesocket(sSock);
+
+		return 1;
+	}
+#endif
+
+	// 스레드
+	{
+		shPeerDataThread = CreateThread(
+			nullptr,
+			0,
+			updatePeerData,
+			nullptr,
+			0,
+			&sPeerDataThreadID
+		);
+
+		DWORD threadErrorCode = GetLastError();
+		ASSERT(threadErrorCode == ERROR_SUCCESS, "CreateThread failed");
+
+#if USE_UDP
+		shPeerUdpThread = CreateThread(
+			nullptr,
+			0,
+			updatePeerDataUdp,
+			nullptr,
+			0,
+			&sPeerUdpThreadID
+		);
+
+		threadErrorCode = GetLastError();
+		ASSERT(threadErrorCode == ERROR_SUCCESS, "CreateThread for udp failed");
+
+		sendEvent(Protocol::MSG_JOIN, 0, nullptr, 0);
+#endif
+	}
+
+	std::ostringstream message;
+	message << "Peer connected " << std::fixed << std::setprecision(1) << (getTime() - sStartupTime) * 1000.0 << " ms after startup";
+	std::cout << message.str() << std::endl;
+
+	// 메인 스레드는 이 값을 본 뒤에만 소켓과 수신 스레드를 사용
+	sbPeerConnected.store(true, std::memory_order_release);
+
+	return 0;
+}
+
+void App::Destroy()
+{
+	// 아직 접속 중이면 멈추고 접속 스레드가 끝날 때까지 기다림
+	sbConnectCanceled = true;
+#if SERVER
+	const SOCKET listeningSock = sListeningSock.exchange(INVALID_SOCKET);
+	if (listeningSock != INVALID_SOCKET)
+	{
+		closesocket(listeningSock);
+	}
+#endif
+
+	if (shConnectThread != nullptr)
+	{
+		WaitForSingleObject(shConnectThread, INFINITE);
+		CloseHandle(shConnectThread);
+		shConnectThread = nullptr;
+	}
+
+	if (sbPeerConnected)
+	{
+		CloseHandle(shPeerDataThread);
+
+#if USE_UDP
+		// 종료는 한 번만 알림, 도착 여부는 기다리지 않음
+		sendEvent(Protocol::MSG_LEAVE, 0, nullptr, 0);
+		sendUdpPacket(nullptr, 0);
+
+#if NET_IMPAIRMENT
+		// 늦춰둔 패킷은 도착 시각을 기다리지 않고 바로 보냄 (MSG_LEAVE 포함), 받은 패킷은 처리하지 않고 버림
+		const size_t flushedCount = sImpairedSendLink.GetQueuedCount();
+		sImpairedSendLink.ForEachArrived(std::numeric_limits<double>::infinity(), sendUdpDatagram);
+
+		size_t droppedCount;
+		{
+			std::lock_guard<std::mutex> lock(sImpairedRecvMutex);
+			droppedCount = sImpairedRecvLink.GetQueuedCount();
+		}
+
+		std::cout << "Impairment on shutdown: flushed " << flushedCount << " delayed sends, dropped " << droppedCount << " delayed receives" << std::endl;
+#endif
+
+		CloseHandle(shPeerUdpThread);
+		closesocket(sUdpSock);
+#endif
+
+		closesocket(sSock);
+	}
+
+	WSACleanup();
+
+#if !HEADLESS
+	ReleaseCOM(spRTV);
+	ReleaseCOM(spBgTextureView);
 	ReleaseCOM(spBgTexture);
 	ReleaseCOM(spBgVertexBuffer);
 	ReleaseCOM(spPlayer1PosBufferGPU);
@@ -478,13 +990,81 @@ void App::Destroy()
 	ReleaseCOM(spSwapChain);
 	ReleaseCOM(spContext);
 	ReleaseCOM(spDevice);
+#endif
 }
 
-static void render();
+static void receivePeerSnapshots();
+#if !HEADLESS
+static void updateWindowTitle();
+static void render(const float alpha);
 static void resizeScreen(const WORD width, const WORD height);
+#endif
 
 int App::Run()
 {
+	Simulation::FixedTimestep timestep;
+
+#if HEADLESS
+	// 그릴 것이 없으므로 다음 틱까지 잠들어 있다가 진행, 상대 연결이 끊기면 종료
+	while (true)
+	{
+		if (!sbPeerConnected.load(std::memory_order_acquire))
+		{
+			// 접속 전에는 틱만 흘려보냄, 접속하지 못한 채로 접속 스레드가 끝났으면 종료
+			timestep.Advance();
+
+			const DWORD waitMs = static_cast<DWORD>(timestep.GetTimeUntilNextTick() * 1000.0) + 1;
+			if (WaitForSingleObject(shConnectThread, waitMs) == WAIT_OBJECT_0 && !sbPeerConnected.load(std::memory_order_acquire))
+			{
+				break;
+			}
+
+			continue;
+		}
+
+#if NET_IMPAIRMENT
+		flushImpairedLink();
+#endif
+		receivePeerSnapshots();
+
+		const int tickCount = timestep.Advance();
+		const uint32_t firstTick = timestep.GetTick() - tickCount;
+		for (int i = 0; i < tickCount; ++i)
+		{
+			updateMyData(firstTick + i);
+		}
+
+		double waitTime = timestep.GetTimeUntilNextTick();
+#if NET_IMPAIRMENT
+		// 늦춰둔 패킷이 있으면 그 도착 시각에 맞춰 깨어남
+		double nextArrivalTime = sImpairedSendLink.GetNextArrivalTime();
+		{
+			std::lock_guard<std::mutex> lock(sImpairedRecvMutex);
+
+			const double nextRecvArrivalTime = sImpairedRecvLink.GetNextArrivalTime();
+			if (nextRecvArrivalTime >= 0.0 && (nextArrivalTime < 0.0 || nextRecvArrivalTime < nextArrivalTime))
+			{
+				nextArrivalTime = nextRecvArrivalTime;
+			}
+		}
+
+		if (nextArrivalTime >= 0.0)
+		{
+			waitTime = std::min(waitTime, std::max(nextArrivalTime - getTime(), 0.0));
+		}
+#endif
+
+		const DWORD waitMs = static_cast<DWORD>(waitTime * 1000.0) + 1;
+		if (WaitForSingleObject(shPeerDataThread, waitMs) == WAIT_OBJECT_0)
+		{
+			break;
+		}
+	}
+
+	App::Destroy();
+
+	return 0;
+#else
 	MSG msg;
 	while (true)
 	{
@@ -498,16 +1078,37 @@ int App::Run()
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
 		}
+		else if (!sbPeerConnected.load(std::memory_order_acquire))
+		{
+			// 접속 전에는 창만 갱신하고 틱은 흘려보냄
+			timestep.Advance();
+
+			render(timestep.GetAlpha());
+		}
 		else
 		{
-			updateMyData();
-			render();
+#if NET_IMPAIRMENT
+			flushImpairedLink();
+#endif
+			receivePeerSnapshots();
+
+			const int tickCount = timestep.Advance();
+			const uint32_t firstTick = timestep.GetTick() - tickCount;
+			for (int i = 0; i < tickCount; ++i)
+			{
+				updateMyData(firstTick + i);
+			}
+
+			render(timestep.GetAlpha());
+			updateWindowTitle();
 		}
 	}
 
 	return (int)msg.message;
+#endif
 }
 
+#if !HEADLESS
 static bool sbKeyPressed[UINT8_MAX];
 
 LRESULT WndProc(const HWND hWnd, const UINT message, const WPARAM wParam, const LPARAM lParam)
@@ -540,9 +1141,71 @@ LRESULT WndProc(const HWND hWnd, const UINT message, const WPARAM wParam, const
 
 	return 0;
 }
+#endif
+
+// 수신 스레드가 넘긴 상대 위치를 보간 버퍼로 옮김
+static void receivePeerSnapshots()
+{
+	PeerSnapshot snapshot;
+	int64_t snapshotCount = 0;
+	while (sPeerSnapshotQueue.TryPop(snapshot))
+	{
+		sPeerSnapshots.Push(snapshot.remoteTime, snapshot.pos, snapshot.receivedTime);
+		sLatestPeerPos = snapshot.pos;
+		++snapshotCount;
+	}
+
+	// 큐에 쌓여 있던 깊이
+	NetStats::SetGauge(NetStats::PENDING_PACKETS, snapshotCount);
+}
+
+#if !HEADLESS
+// 창 제목에 지연과 시계 차이 표시
+static void updateWindowTitle()
+{
+	static double sLastUpdateTime = 0.0;
+
+	const double now = getTime();
+	if (now - sLastUpdateTime < 0.5)
+	{
+		return;
+	}
+
+	sLastUpdateTime = now;
+
+	const App::LinkTiming timing = App::GetLinkTiming();
+	if (!timing.bValid)
+	{
+		return;
+	}
+
+	std::ostringstream title;
+	title << (SERVER ? "Server" : "Client") << std::fixed << std::setprecision(1)
+		<< " | RTT " << timing.rtt * 1000.0 << " ms"
+		<< ", jitter " << timing.jitter * 1000.0 << " ms"
+		<< ", clock offset " << std::showpos << timing.clockOffset * 1000.0 << " ms";
+
+	SetWindowTextA(shWnd, title.str().c_str());
+}
 
-static void render()
+static void render(const float alpha)
 {
+	const Simulation::Float2 myPos = Simulation::Lerp(sMyState.prevPos, sMyState.pos, alpha);
+
+	Simulation::Float2 peerPos;
+	if (!sPeerSnapshots.Sample(getTime(), peerPos))
+	{
+		peerPos = sLatestPeerPos;
+	}
+
+#if SERVER
+	sPlayer1PosBufferCPU.pos = { myPos.x, myPos.y };
+	sPlayer2PosBufferCPU.pos = { peerPos.x, peerPos.y };
+#else
+	sPlayer1PosBufferCPU.pos = { peerPos.x, peerPos.y };
+	sPlayer2PosBufferCPU.pos = { myPos.x, myPos.y };
+#endif
+
 	const UINT stride = sizeof(BgVertex);
 	const UINT offset = 0;
 
@@ -600,68 +1263,911 @@ static void resizeScreen(const WORD width, const WORD height)
 	spContext->RSSetViewports(1, &sViewport);
 	spContext->OMSetRenderTargets(1, &spRTV, nullptr);
 }
+#endif
+
+static bool sendAll(const SOCKET sock, const uint8_t* pData, const size_t size)
+{
+	size_t sentSize = 0;
+	while (sentSize < size)
+	{
+		const int result = send(sock, reinterpret_cast<const char*>(pData + sentSize), static_cast<int>(size - sentSize), 0);
+		if (result == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() == WSAEWOULDBLOCK)
+			{
+				NetStats::Add(NetStats::WOULD_BLOCK_SENDS);
+			}
+
+			return false;
+		}
+
+		NetStats::Add(NetStats::BYTES_OUT, result);
+		NetStats::Add(NetStats::PACKETS_OUT);
+		if (static_cast<size_t>(result) < size - sentSize)
+		{
+			NetStats::Add(NetStats::PARTIAL_SENDS);
+		}
+
+		sentSize += result;
+	}
+
+	return true;
+}
 
-constexpr float DELTA_DIST = 0.005f;
+static uint32_t sSendSequence;
 
-static void updateMyData()
+static double getTime()
 {
-#if SERVER
-	if (sbKeyPressed[VK_UP])
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+App::LinkTiming App::GetLinkTiming()
+{
+	std::lock_guard<std::mutex> lock(sTimingMutex);
+
+	LinkTiming timing;
+	timing.bValid = sTimeSync.HasSample();
+	timing.rtt = sTimeSync.GetRtt();
+	timing.jitter = sTimeSync.GetJitter();
+	timing.clockOffset = sTimeSync.GetClockOffset();
+
+	return timing;
+}
+
+double App::PeerTickToLocalTime(const uint32_t tick)
+{
+	std::lock_guard<std::mutex> lock(sTimingMutex);
+
+	return sTimeSync.RemoteTickToLocalTime(tick);
+}
+
+// 주기적인 ping과 밀린 pong을 pOutBuffer에 기록, 기록한 바이트 수 반환
+static size_t writeTimingMessages(uint8_t* pOutBuffer, const size_t bufferSize, const uint32_t tick, const double now)
+{
+	size_t size = 0;
+
+	static double sNextPingTime = 0.0;
+	if (now >= sNextPingTime)
 	{
-		sPlayer1PosBufferCPU.pos.y -= DELTA_DIST;
+		sNextPingTime = now + PING_INTERVAL_MS / 1000.0;
+
+		const Protocol::PingPayload ping = { TimeSync::ToWireTime(getTime()) };
+		size += Protocol::WriteMessage(pOutBuffer + size, bufferSize - size, Protocol::MSG_PING, sSendSequence++, tick, &ping, sizeof(ping));
 	}
 
-	if (sbKeyPressed[VK_DOWN])
+	Protocol::PongPayload pong;
+	bool bPongPending;
 	{
-		sPlayer1PosBufferCPU.pos.y += DELTA_DIST;
+		std::lock_guard<std::mutex> lock(sTimingMutex);
+
+		bPongPending = sbPongPending;
+		sbPongPending = false;
+		pong = sPendingPong;
 	}
 
-	if (sbKeyPressed[VK_LEFT])
+	if (bPongPending)
 	{
-		sPlayer1PosBufferCPU.pos.x -= DELTA_DIST;
+		pong.sendTime = TimeSync::ToWireTime(getTime());
+		size += Protocol::WriteMessage(pOutBuffer + size, bufferSize - size, Protocol::MSG_PONG, sSendSequence++, tick, &pong, sizeof(pong));
 	}
 
-	if (sbKeyPressed[VK_RIGHT])
+	return size;
+}
+
+// 방향키를 입력 비트로, 클라이언트는 기존처럼 위쪽 키가 +y
+static uint8_t sampleInput()
+{
+	using namespace Simulation;
+
+#if HEADLESS
+	// 키 입력을 받을 창이 없음
+	return INPUT_NONE;
+#else
+	uint8_t input = INPUT_NONE;
+
+#if SERVER
+	if (sbKeyPressed[VK_UP])
 	{
-		sPlayer1PosBufferCPU.pos.x += DELTA_DIST;
+		input |= INPUT_UP;
 	}
 
-	send(sSock, (char*)(&sPlayer1PosBufferCPU.pos), sizeof(ConstantBuffer::pos), 0);
+	if (sbKeyPressed[VK_DOWN])
+	{
+		input |= INPUT_DOWN;
+	}
 #else
 	if (sbKeyPressed[VK_UP])
 	{
-		sPlayer2PosBufferCPU.pos.y += DELTA_DIST;
+		input |= INPUT_DOWN;
 	}
 
 	if (sbKeyPressed[VK_DOWN])
 	{
-		sPlayer2PosBufferCPU.pos.y -= DELTA_DIST;
+		input |= INPUT_UP;
 	}
+#endif
 
 	if (sbKeyPressed[VK_LEFT])
 	{
-		sPlayer2PosBufferCPU.pos.x -= DELTA_DIST;
+		input |= INPUT_LEFT;
 	}
 
 	if (sbKeyPressed[VK_RIGHT])
 	{
-		sPlayer2PosBufferCPU.pos.x += DELTA_DIST;
+		input |= INPUT_RIGHT;
 	}
 
-	send(sSock, (char*)(&sPlayer2PosBufferCPU.pos), sizeof(ConstantBuffer::pos), 0);
+	return input;
 #endif
 }
 
-static DWORD WINAPI updatePeerData(const LPVOID lpParam)
+static void updateMyData(const uint32_t tick)
 {
-	while (true)
+	using namespace Simulation;
+
+	const uint8_t input = sampleInput();
+	const double now = getTime();
+
+#if USE_ROLLBACK
+	// 받은 상대 입력을 넣고, 틀린 예측이 있으면 되돌려서 다시 계산한 뒤 한 틱 진행
 	{
-#if SERVER
-		recv(sSock, (char*)(&sPlayer2PosBufferCPU.pos), sizeof(ConstantBuffer::pos), 0);
+		static std::vector<Protocol::InputPayload> sDrainedInputs;
+		{
+			std::lock_guard<std::mutex> lock(sChannelMutex);
+			sDrainedInputs.swap(sReceivedInputs);
+		}
+
+		for (const Protocol::InputPayload& payload : sDrainedInputs)
+		{
+			Protocol::ForEachInput(payload, [](const uint32_t inputTick, const uint8_t peerInput)
+			{
+				sRollbackSession.AddRemoteInput(inputTick, peerInput);
+			});
+		}
+
+		sDrainedInputs.clear();
+	}
+
+	if (sRollbackSession.CanAdvance())
+	{
+		sRollbackSession.AdvanceFrame(input);
+	}
+	else
+	{
+		// 상대가 너무 늦으면 기다림, 그동안 받은 입력으로 되돌리는 것만 함
+		sRollbackSession.Synchronize();
+		++sRollbackStallCount;
+	}
+
+	// 상대 위치도 같은 시뮬레이션 결과라 보간 버퍼를 거치지 않음
+	const int localPlayer = sRollbackSession.GetLocalPlayer();
+	sMyState.prevPos = sMyState.pos;
+	sMyState.pos = Rollback::GetPosition(sRollbackSession.GetState(), localPlayer);
+	sLatestPeerPos = Rollback::GetPosition(sRollbackSession.GetState(), 1 - localPlayer);
+#elif !SERVER
+	// 서버가 확인한 위치가 왔으면 그 위에 아직 확인 안 된 입력을 다시 적용
+	{
+		bool bHasState;
+		Protocol::PlayerStatePayload state;
+		{
+			std::lock_guard<std::mutex> lock(sChannelMutex);
+
+			bHasState = sbAuthoritativeStatePending;
+			state = sAuthoritativeState;
+			sbAuthoritativeStatePending = false;
+		}
+
+		if (bHasState)
+		{
+			Float2 authoritativePos;
+			Protocol::DecodePosition(state.pos, authoritativePos.x, authoritativePos.y);
+
+			sMyState.pos = sPrediction.Reconcile(state.lastInputTick, authoritativePos, sMyState.pos);
+		}
+	}
+
+	// 서버 응답을 기다리지 않고 바로 이동
+	sMyState.prevPos = sMyState.pos;
+	sMyState.pos = sPrediction.PushInput(tick, input, sMyState.pos);
 #else
-		recv(sSock, (char*)(&sPlayer1PosBufferCPU.pos), sizeof(ConstantBuffer::pos), 0);
+	sMyState.prevPos = sMyState.pos;
+	sMyState.pos = ApplyInput(sMyState.pos, input);
 #endif
-	}
 
-	return 0;
-}
+	sNetStatsDumper.Update(now);
+
+	static double sLastReportTime = now;
+	if (now - sLastReportTime >= 10.0)
+	{
+		sLastReportTime = now;
+		std::cout << "Position packets sent " << sPositionThrottle.GetSentCount()
+			<< ", suppressed " << sPositionThrottle.GetSuppressedCount() << std::endl;
+
+		std::cout << "Peer snapshots buffered " << sPeerSnapshots.GetDepth()
+			<< ", delay " << sPeerSnapshots.GetDelay() * 1000.0
+			<< " ms, jitter " << sPeerSnapshots.GetJitter() * 1000.0
+			<< " ms, starved " << sPeerSnapshots.GetStarvationCount() << std::endl;
+
+		const App::LinkTiming timing = App::GetLinkTiming();
+		if (timing.bValid)
+		{
+			std::cout << "RTT " << timing.rtt * 1000.0
+				<< " ms, jitter " << timing.jitter * 1000.0
+				<< " ms, clock offset " << timing.clockOffset * 1000.0 << " ms" << std::endl;
+		}
+#if NET_IMPAIRMENT
+		std::cout << "Impaired sent packets " << sImpairedSendLink.GetPushedCount()
+			<< ": lost " << sImpairedSendLink.GetLostCount()
+			<< ", duplicated " << sImpairedSendLink.GetDuplicatedCount()
+			<< ", reordered " << sImpairedSendLink.GetReorderedCount()
+			<< ", queue drops " << sImpairedSendLink.GetQueueDropCount() << std::endl;
+		{
+			std::lock_guard<std::mutex> lock(sImpairedRecvMutex);
+
+			std::cout << "Impaired received packets " << sImpairedRecvLink.GetPushedCount()
+				<< ": lost " << sImpairedRecvLink.GetLostCount()
+				<< ", duplicated " << sImpairedRecvLink.GetDuplicatedCount()
+				<< ", reordered " << sImpairedRecvLink.GetReorderedCount()
+				<< ", queue drops " << sImpairedRecvLink.GetQueueDropCount() << std::endl;
+		}
+#endif
+#if USE_ROLLBACK
+		std::cout << "Rollbacks " << sRollbackSession.GetRollbackCount()
+			<< ", resimulated frames " << sRollbackSession.GetResimulatedFrameCount()
+			<< " (max " << sRollbackSession.GetMaxRollbackFrames()
+			<< "), stalled ticks " << sRollbackStallCount << std::endl;
+#elif SERVER
+		{
+			std::lock_guard<std::mutex> lock(sChannelMutex);
+			std::cout << "Dropped peer input ticks " << sDroppedPeerInputCount << std::endl;
+		}
+#else
+		std::cout << "Prediction error " << sPrediction.GetLastError()
+			<< " (max " << sPrediction.GetMaxError()
+			<< "), pending inputs " << sPrediction.GetPendingCount() << std::endl;
+#endif
+	}
+
+#if USE_UDP
+	uint8_t messages[Protocol::MAX_PACKET_SIZE / 2];
+	size_t messagesSize = 0;
+
+#if SERVER
+	// 겹침 판정은 서버가 하고 클라이언트에 반드시 전달
+	static bool sbOverlapped = false;
+
+	const float PLAYER_RADIUS = 0.03f;
+	const float dx = sMyState.pos.x - sLatestPeerPos.x;
+	const float dy = sMyState.pos.y - sLatestPeerPos.y;
+	const bool bOverlapped = dx * dx + dy * dy < (2.f * PLAYER_RADIUS) * (2.f * PLAYER_RADIUS);
+
+	if (bOverlapped != sbOverlapped)
+	{
+		const Protocol::OverlapPayload overlap = { static_cast<uint8_t>(bOverlapped) };
+		if (sendEvent(Protocol::MSG_OVERLAP, tick, &overlap, sizeof(overlap)))
+		{
+			sbOverlapped = bOverlapped;
+		}
+	}
+#endif
+
+	messagesSize += writeStateMessages(messages + messagesSize, sizeof(messages) - messagesSize, tick, now);
+	messagesSize += writeTimingMessages(messages + messagesSize, sizeof(messages) - messagesSize, tick, now);
+
+	if (messagesSize > 0)
+	{
+		sendUdpPacket(messages, messagesSize);
+	}
+	else
+	{
+		// 보낼 게 없어도 신뢰성 메시지와 ack는 늦추지 않음
+		bool bReliablePending;
+		{
+			std::lock_guard<std::mutex> lock(sChannelMutex);
+			bReliablePending = sEventChannel.HasMessagesToSend(now, sAcks.GetResendTimeout());
+		}
+
+		if (bReliablePending || sbAckPending.load(std::memory_order_relaxed))
+		{
+			sendUdpPacket(nullptr, 0);
+		}
+	}
+#else
+	uint8_t messages[Protocol::MAX_MESSAGE_SIZE];
+	size_t messagesSize = writeTimingMessages(messages, sizeof(messages), tick, now);
+	messagesSize += writeStateMessages(messages + messagesSize, sizeof(messages) - messagesSize, tick, now);
+
+	if (messagesSize > 0)
+	{
+		sendAll(sSock, messages, messagesSize);
+	}
+#endif
+}
+
+#if USE_ROLLBACK
+// 상대가 아직 받지 못한 내 입력을 오래된 틱부터 빠짐없이, 다음에 필요한 상대 입력의 틱과 함께 보냄
+// 양쪽 모두 매 틱 입력이 생기므로 상대가 따라오는 동안은 매 틱 보냄
+static size_t writeStateMessages(uint8_t* pOutBuffer, const size_t bufferSize, const uint32_t tick, const double now)
+{
+	uint32_t peerInputAck;
+	{
+		std::lock_guard<std::mutex> lock(sChannelMutex);
+		peerInputAck = sPeerInputAck;
+	}
+
+	// 보관 중인 입력보다 오래된 ack는 상대가 멈춰 있는 경우뿐, 보관 중인 것부터 보냄
+	const uint32_t inputEnd = sRollbackSession.GetLocalInputEnd();
+	const uint32_t oldestTick = inputEnd > Rollback::HISTORY_SIZE ? inputEnd - Rollback::HISTORY_SIZE : 0;
+	const uint32_t firstTick = std::max(peerInputAck, oldestTick);
+
+	if (!sPositionThrottle.ShouldSend(firstTick < inputEnd, now))
+	{
+		return 0;
+	}
+
+	uint8_t inputs[Rollback::HISTORY_SIZE];
+	size_t inputCount = 0;
+	for (uint32_t inputTick = firstTick; inputTick < inputEnd; ++inputTick)
+	{
+		inputs[inputCount++] = sRollbackSession.GetLocalInput(inputTick);
+	}
+
+	// 상대는 순서대로만 받으므로 run에 다 들어가지 않으면 뒤쪽을 다음에 보냄
+	inputCount = Protocol::GetEncodableInputCount(inputs, inputCount);
+
+	Protocol::InputPayload inputPayload;
+	Protocol::EncodeInputs(inputs, inputCount, firstTick + static_cast<uint32_t>(inputCount) - 1, inputPayload);
+
+	size_t size = Protocol::WriteMessage(
+		pOutBuffer,
+		bufferSize,
+		Protocol::MSG_INPUT,
+		sSendSequence++,
+		tick,
+		&inputPayload,
+		Protocol::GetInputPayloadSize(inputPayload)
+	);
+
+	const Protocol::InputAckPayload ack = { sRollbackSession.GetRemoteInputEnd() };
+	size += Protocol::WriteMessage(
+		pOutBuffer + size,
+		bufferSize - size,
+		Protocol::MSG_INPUT_ACK,
+		sSendSequence++,
+		tick,
+		&ack,
+		sizeof(ack)
+	);
+
+	return size;
+}
+#elif SERVER
+// 내 위치와, 클라이언트 입력을 적용한 클라이언트 위치
+static size_t writeStateMessages(uint8_t* pOutBuffer, const size_t bufferSize, const uint32_t tick, const double now)
+{
+	Protocol::PositionPayload payload;
+	Protocol::EncodePosition(sMyState.pos.x, sMyState.pos.y, payload);
+
+	bool bPeerInputReceived;
+	bool bPeerStateChanged;
+	Protocol::PlayerStatePayload peerState;
+	{
+		std::lock_guard<std::mutex> lock(sChannelMutex);
+
+		bPeerInputReceived = sbPeerInputReceived;
+		bPeerStateChanged = sbPeerStateDirty;
+		sbPeerStateDirty = false;
+
+		peerState.lastInputTick = sLastPeerInputTick;
+		Protocol::EncodePosition(sPeerPos.x, sPeerPos.y, peerState.pos);
+	}
+
+	// 양자화된 값으로 비교해서 전송 정밀도 아래의 변화는 무시
+	const bool bChanged = memcmp(&payload, &sLastSentPosition, sizeof(payload)) != 0 || bPeerStateChanged;
+	if (!sPositionThrottle.ShouldSend(bChanged, now))
+	{
+		return 0;
+	}
+
+	sLastSentPosition = payload;
+
+	size_t size = Protocol::WriteMessage(
+		pOutBuffer,
+		bufferSize,
+		Protocol::MSG_POSITION,
+		sSendSequence++,
+		tick,
+		&payload,
+		sizeof(payload)
+	);
+
+	if (bPeerInputReceived)
+	{
+		size += Protocol::WriteMessage(
+			pOutBuffer + size,
+			bufferSize - size,
+			Protocol::MSG_PLAYER_STATE,
+			sSendSequence++,
+			tick,
+			&peerState,
+			sizeof(peerState)
+		);
+	}
+
+	return size;
+}
+#else
+// 확인 안 된 입력이 있는 동안은 매 틱 최근 입력들을 run으로 묶어 겹쳐 보내서 손실을 메움
+// TCP는 손실이 없지만 같은 메시지를 쓰고, 대부분 한두 run이라 겹쳐도 몇 바이트
+static size_t writeStateMessages(uint8_t* pOutBuffer, const size_t bufferSize, const uint32_t tick, const double now)
+{
+	if (!sPositionThrottle.ShouldSend(sPrediction.HasPendingInputs(), now))
+	{
+		return 0;
+	}
+
+	const size_t pendingCount = sPrediction.GetPendingCount();
+
+	uint8_t inputs[Simulation::InputPrediction::MAX_PENDING_INPUTS];
+	for (size_t i = 0; i < pendingCount; ++i)
+	{
+		inputs[i] = sPrediction.GetPendingInput(i);
+	}
+
+	// 들어가지 못한 오래된 입력은 서버가 빠진 틱으로 보고 입력 없음으로 처리
+	Protocol::InputPayload inputPayload;
+	Protocol::EncodeInputs(inputs, pendingCount, pendingCount > 0 ? sPrediction.GetNewestTick() : tick, inputPayload);
+
+	return Protocol::WriteMessage(
+		pOutBuffer,
+		bufferSize,
+		Protocol::MSG_INPUT,
+		sSendSequence++,
+		tick,
+		&inputPayload,
+		Protocol::GetInputPayloadSize(inputPayload)
+	);
+}
+#endif
+
+#if SERVER && !USE_ROLLBACK
+// 클라이언트 입력을 틱 순서대로 한 번씩만 적용, sChannelMutex 안에서 호출
+static void applyPeerInputs(const Protocol::InputPayload& payload)
+{
+	const double now = getTime();
+
+	// 받는 스레드는 시뮬레이션 틱을 모르므로 시간으로 틱을 셈, 첫 입력부터 쌓기 시작
+	const uint32_t tick = static_cast<uint32_t>(now * Simulation::TICK_RATE_HZ);
+	if (!sbPeerInputReceived)
+	{
+		sPeerInputBudgetTick = tick;
+	}
+
+	sPeerInputBudget = std::min<uint32_t>(sPeerInputBudget + (tick - sPeerInputBudgetTick), MAX_INPUT_BUDGET);
+	sPeerInputBudgetTick = tick;
+
+	Protocol::ForEachInput(payload, [now](const uint32_t inputTick, const uint8_t input)
+	{
+		if (sbPeerInputReceived && inputTick <= sLastPeerInputTick)
+		{
+			return;
+		}
+
+		// 클라이언트 틱이 서버보다 빨리 갈 수 없음
+		if (sPeerInputBudget == 0)
+		{
+			++sDroppedPeerInputCount;
+			return;
+		}
+
+		--sPeerInputBudget;
+
+		// 빠진 틱은 입력 없음으로 처리, 클라이언트가 보정함
+		sPeerPos = Simulation::ApplyInput(sPeerPos, input);
+		sLastPeerInputTick = inputTick;
+		sbPeerInputReceived = true;
+		sbPeerStateDirty = true;
+
+		// 클라이언트 틱을 스냅샷 시각으로 사용, 가득 차면 버리고 다음 것으로 이어감
+		const PeerSnapshot snapshot = { inputTick * Simulation::TICK_INTERVAL, now, sPeerPos };
+		sPeerSnapshotQueue.TryPush(snapshot);
+	});
+}
+#endif
+
+static void handlePeerMessage(const Protocol::MessageView& message)
+{
+	switch (message.header.type)
+	{
+#if USE_ROLLBACK
+	case Protocol::MSG_INPUT:
+		{
+			Protocol::InputPayload payload;
+			if (Protocol::ReadInputPayload(message, payload))
+			{
+				sReceivedInputs.push_back(payload);
+			}
+		}
+		break;
+
+	case Protocol::MSG_INPUT_ACK:
+		{
+			Protocol::InputAckPayload ack;
+			if (message.payloadSize != sizeof(ack))
+			{
+				break;
+			}
+
+			// 순서가 뒤바뀐 패킷의 ack로 되돌아가지 않도록
+			memcpy(&ack, message.pPayload, sizeof(ack));
+			sPeerInputAck = std::max(sPeerInputAck, ack.nextTick);
+		}
+		break;
+#elif !SERVER
+	// 클라이언트 위치는 서버가 입력으로 계산하므로 서버 쪽 위치만 받음
+	case Protocol::MSG_POSITION:
+		{
+			Protocol::PositionPayload payload;
+			if (message.payloadSize != sizeof(payload))
+			{
+				break;
+			}
+
+			memcpy(&payload, message.pPayload, sizeof(payload));
+			Protocol::DecodePosition(payload, sPeerPos.x, sPeerPos.y);
+
+			const PeerSnapshot snapshot = { message.header.tick * Simulation::TICK_INTERVAL, getTime(), sPeerPos };
+			sPeerSnapshotQueue.TryPush(snapshot);
+		}
+		break;
+
+	case Protocol::MSG_PLAYER_STATE:
+		if (message.payloadSize == sizeof(sAuthoritativeState))
+		{
+			memcpy(&sAuthoritativeState, message.pPayload, sizeof(sAuthoritativeState));
+			sbAuthoritativeStatePending = true;
+		}
+		break;
+#else
+	case Protocol::MSG_INPUT:
+		{
+			Protocol::InputPayload payload;
+			if (Protocol::ReadInputPayload(message, payload))
+			{
+				applyPeerInputs(payload);
+			}
+		}
+		break;
+#endif
+
+	case Protocol::MSG_PING:
+		{
+			Protocol::PingPayload ping;
+			if (message.payloadSize != sizeof(ping))
+			{
+				break;
+			}
+
+			memcpy(&ping, message.pPayload, sizeof(ping));
+
+			std::lock_guard<std::mutex> lock(sTimingMutex);
+
+			sPendingPong.pingSendTime = ping.sendTime;
+			sPendingPong.receiveTime = TimeSync::ToWireTime(getTime());
+			sPendingPong.tickTime = 0;
+			sbPongPending = true;
+		}
+		break;
+
+	case Protocol::MSG_PONG:
+		{
+			Protocol::PongPayload pong;
+			if (message.payloadSize != sizeof(pong))
+			{
+				break;
+			}
+
+			memcpy(&pong, message.pPayload, sizeof(pong));
+			const double now = getTime();
+
+			std::lock_guard<std::mutex> lock(sTimingMutex);
+
+			sTimeSync.AddSample(
+				TimeSync::FromWireTime(pong.pingSendTime),
+				TimeSync::FromWireTime(pong.receiveTime),
+				TimeSync::FromWireTime(pong.sendTime),
+				now,
+				message.header.tick
+			);
+		}
+		break;
+
+	case Protocol::MSG_JOIN:
+		std::cout << "Peer joined" << std::endl;
+		break;
+
+	case Protocol::MSG_LEAVE:
+		std::cout << "Peer left" << std::endl;
+		break;
+
+	case Protocol::MSG_OVERLAP:
+		{
+			Protocol::OverlapPayload payload;
+			if (message.payloadSize != sizeof(payload))
+			{
+				break;
+			}
+
+			memcpy(&payload, message.pPayload, sizeof(payload));
+			std::cout << (payload.bOverlapped ? "Overlap begin" : "Overlap end") << std::endl;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+static DWORD WINAPI updatePeerData(const LPVOID lpParam)
+{
+	static Protocol::StreamBuffer sRecvBuffer;
+
+	while (true)
+	{
+		sRecvBuffer.Compact();
+
+		const int receivedSize = recv(
+			sSock,
+			reinterpret_cast<char*>(sRecvBuffer.GetWritePtr()),
+			static_cast<int>(sRecvBuffer.GetWritableSize()),
+			0
+		);
+
+		// 연결 종료 혹은 오류
+		if (receivedSize <= 0)
+		{
+			break;
+		}
+
+		NetStats::Add(NetStats::BYTES_IN, receivedSize);
+		NetStats::Add(NetStats::PACKETS_IN);
+
+		sRecvBuffer.CommitWrite(receivedSize);
+
+		Protocol::MessageView message;
+		Protocol::EParseResult result;
+		while ((result = sRecvBuffer.Parse(message)) == Protocol::PARSE_OK)
+		{
+#if USE_UDP
+			// UDP를 쓰면 TCP는 연결 유지용, 상대 데이터는 UDP 스레드만 처리
+			continue;
+#else
+			std::lock_guard<std::mutex> lock(sChannelMutex);
+			handlePeerMessage(message);
+#endif
+		}
+
+		if (result == Protocol::PARSE_ERROR)
+		{
+			ASSERT(false, "invalid message from peer");
+			break;
+		}
+
+		if (sRecvBuffer.GetPendingSize() > 0)
+		{
+			NetStats::Add(NetStats::PARTIAL_FRAMES);
+		}
+
+		NetStats::SetGauge(NetStats::RECV_QUEUE_BYTES, static_cast<int64_t>(sRecvBuffer.GetPendingSize()));
+	}
+
+	return 0;
+}
+
+#if USE_UDP
+static DWORD WINAPI updatePeerDataUdp(const LPVOID lpParam)
+{
+	uint8_t packet[Protocol::MAX_PACKET_SIZE];
+
+	while (true)
+	{
+		sockaddr_in from;
+		int fromSize = sizeof(from);
+
+		const int receivedSize = recvfrom(
+			sUdpSock,
+			reinterpret_cast<char*>(packet),
+			sizeof(packet),
+			0,
+			reinterpret_cast<sockaddr*>(&from),
+			&fromSize
+		);
+
+		if (receivedSize == SOCKET_ERROR)
+		{
+			// 상대가 닫힌 포트로 보낸 경우 등은 무시하고 계속 받음
+			if (WSAGetLastError() == WSAECONNRESET)
+			{
+				continue;
+			}
+
+			break;
+		}
+
+		NetStats::Add(NetStats::BYTES_IN, receivedSize);
+		NetStats::Add(NetStats::PACKETS_IN);
+
+		Protocol::PacketHeader packetHeader;
+		if (receivedSize < static_cast<int>(sizeof(packetHeader)))
+		{
+			continue;
+		}
+
+		memcpy(&packetHeader, packet, sizeof(packetHeader));
+		if (packetHeader.protocolId != Protocol::PROTOCOL_ID)
+		{
+			continue;
+		}
+
+#if SERVER
+		if (from.sin_addr.s_addr != sPeerUdpAddr.sin_addr.s_addr)
+		{
+			continue;
+		}
+
+		if (!sbPeerUdpAddrKnown.load(std::memory_order_relaxed))
+		{
+			sPeerUdpAddr.sin_port = from.sin_port;
+			sbPeerUdpAddrKnown.store(true, std::memory_order_release);
+		}
+#endif
+
+#if NET_IMPAIRMENT
+		// 메인 스레드가 도착 시각에 handleUdpPacket으로 처리
+		std::lock_guard<std::mutex> lock(sImpairedRecvMutex);
+		sImpairedRecvLink.Push(packet, receivedSize, getTime());
+#else
+		handleUdpPacket(packet, receivedSize);
+#endif
+	}
+
+	return 0;
+}
+
+// 헤더를 확인한 패킷의 ack와 메시지를 처리
+static void handleUdpPacket(const uint8_t* pPacket, const size_t packetSize)
+{
+	Protocol::PacketHeader packetHeader;
+	memcpy(&packetHeader, pPacket, sizeof(packetHeader));
+
+	std::lock_guard<std::mutex> lock(sChannelMutex);
+
+	sAcks.OnPacketReceived(packetHeader.sequence);
+	sAcks.ProcessAcks(packetHeader.ack, packetHeader.ackBits, getTime(), [](const uint16_t ackedSequence)
+	{
+		sEventChannel.OnPacketAcked(ackedSequence);
+	});
+
+	// 늦게 도착하거나 순서가 뒤바뀐 패킷의 위치는 버리고 이벤트는 그대로 받음
+	const bool bFreshPosition = sPositionChannel.Accept(packetHeader.sequence);
+
+	const uint8_t* pData = pPacket + sizeof(packetHeader);
+	size_t remainingSize = packetSize - sizeof(packetHeader);
+
+	Protocol::MessageView message;
+	size_t messageLength;
+	while (Protocol::ParseMessage(pData, remainingSize, message, messageLength) == Protocol::PARSE_OK)
+	{
+		if (Protocol::IsReliableMessage(message.header.type))
+		{
+			sEventChannel.Receive(message);
+			sbAckPending.store(true, std::memory_order_relaxed);
+		}
+		else if (bFreshPosition || message.header.type == Protocol::MSG_PING || message.header.type == Protocol::MSG_PONG)
+		{
+			// 지연 측정 메시지는 늦게 온 패킷에 있어도 받음
+			handlePeerMessage(message);
+		}
+
+		pData += messageLength;
+		remainingSize -= messageLength;
+	}
+
+	while (sEventChannel.PopMessage(message))
+	{
+		handlePeerMessage(message);
+	}
+}
+
+static bool sendEvent(const Protocol::EMessageType type, const uint32_t tick, const void* pPayload, const size_t payloadSize)
+{
+	std::lock_guard<std::mutex> lock(sChannelMutex);
+
+	const bool bQueued = sEventChannel.Send(type, tick, pPayload, payloadSize);
+	ASSERT(bQueued, "reliable window is full");
+
+	return bQueued;
+}
+
+static void sendUdpDatagram(const uint8_t* pPacket, const size_t packetSize)
+{
+#if SERVER
+	const int result = sendto(sUdpSock, reinterpret_cast<const char*>(pPacket), static_cast<int>(packetSize), 0, reinterpret_cast<const sockaddr*>(&sPeerUdpAddr), sizeof(sPeerUdpAddr));
+#else
+	const int result = send(sUdpSock, reinterpret_cast<const char*>(pPacket), static_cast<int>(packetSize), 0);
+#endif
+
+	if (result == SOCKET_ERROR)
+	{
+		if (WSAGetLastError() == WSAEWOULDBLOCK)
+		{
+			NetStats::Add(NetStats::WOULD_BLOCK_SENDS);
+		}
+
+		return;
+	}
+
+	NetStats::Add(NetStats::BYTES_OUT, result);
+	NetStats::Add(NetStats::PACKETS_OUT);
+}
+
+static void sendUdpPacket(const uint8_t* pMessages, const size_t messagesSize)
+{
+#if SERVER
+	if (!sbPeerUdpAddrKnown.load(std::memory_order_acquire))
+	{
+		return;
+	}
+#endif
+
+	uint8_t packet[Protocol::MAX_PACKET_SIZE];
+	size_t packetSize = sizeof(Protocol::PacketHeader);
+	{
+		std::lock_guard<std::mutex> lock(sChannelMutex);
+
+		const double now = getTime();
+
+		Protocol::PacketHeader packetHeader;
+		packetHeader.protocolId = Protocol::PROTOCOL_ID;
+		packetHeader.sequence = sAcks.NextSendSequence(now);
+		sAcks.GetAcks(packetHeader.ack, packetHeader.ackBits);
+		sbAckPending.store(false, std::memory_order_relaxed);
+		memcpy(packet, &packetHeader, sizeof(packetHeader));
+
+		// 비신뢰 메시지를 먼저 실어서 신뢰성 메시지가 위치 전송을 막지 않도록 함
+		if (messagesSize > 0)
+		{
+			memcpy(packet + packetSize, pMessages, messagesSize);
+			packetSize += messagesSize;
+		}
+
+		packetSize += sEventChannel.WriteMessages(
+			packetHeader.sequence,
+			packet + packetSize,
+			sizeof(packet) - packetSize,
+			now,
+			sAcks.GetResendTimeout()
+		);
+	}
+
+#if NET_IMPAIRMENT
+	sImpairedSendLink.Push(packet, packetSize, getTime());
+	flushImpairedLink();
+#else
+	sendUdpDatagram(packet, packetSize);
+#endif
+}
+#endif
+
+#if NET_IMPAIRMENT
+// 도착 시각이 된 패킷을 보내고 받은 패킷을 처리, 메인 스레드가 매 프레임 호출
+static void flushImpairedLink()
+{
+	const double now = getTime();
+
+	sImpairedSendLink.ForEachArrived(now, sendUdpDatagram);
+
+	std::lock_guard<std::mutex> lock(sImpairedRecvMutex);
+	sImpairedRecvLink.ForEachArrived(now, handleUdpPacket);
+}
+#endif
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 
 #include <WinSock2.h>
@@ -11,12 +12,62 @@
 
 #define SERVER (true)
 
+// 창과 D3D 없이 게임 상태와 소켓만 실행 (SERVER일 때만)
+#define HEADLESS (false)
+
+// 위치 갱신을 UDP로 전송 (false면 기존 TCP 연결 사용)
+#define USE_UDP (true)
+
+// 위치가 그대로일 때 보내는 간격(ms)과 위치 패킷의 초당 최대 전송 횟수
+#define POSITION_HEARTBEAT_MS (250)
+#define MAX_POSITION_SEND_RATE (60)
+
+// 위치 대신 입력만 주고받고 양쪽이 같은 시뮬레이션을 돌림 (Rollback.h)
+// 상대 입력이 아직 없으면 예측으로 진행하고, 실제 입력이 다르면 되돌려서 다시 계산
+#define USE_ROLLBACK (false)
+#define ROLLBACK_INPUT_DELAY (2) // 로컬 입력을 늦게 적용할 틱 수, 늘리면 롤백이 줄고 조작 반응이 늦어짐
+
+// 지연과 시계 차이를 재는 MSG_PING 전송 간격(ms)
+#define PING_INTERVAL_MS (500)
+
+// 소켓 계측 카운터 출력 간격(ms), 0이면 끔
+#define NET_STATS_INTERVAL_MS (10000)
+#define NET_STATS_FILE (nullptr) // 파일 경로 문자열, nullptr이면 stdout
+
+// UDP 송수신 경로에 지연/손실 등을 넣어 실제 네트워크를 흉내 냄
+// 한쪽만 켜도 왕복에 적용, 양쪽 모두 켜면 한 방향에 두 번 적용됨
+#define NET_IMPAIRMENT (false)
+#define IMPAIR_DELAY_MS (50)
+#define IMPAIR_JITTER_MS (10)
+#define IMPAIR_LOSS_PERCENT (2)
+#define IMPAIR_DUPLICATE_PERCENT (1)
+#define IMPAIR_REORDER_PERCENT (1)
+#define IMPAIR_REORDER_DELAY_MS (40)
+#define IMPAIR_BANDWIDTH_KBPS (0) // 0이면 제한 없음
+#define IMPAIR_SEED (1)
+
 namespace App
 {
 	void Initialize();
 	void Destroy();
 	int Run();
 
+	// 상대와의 지연과 시계 차이, 아직 pong을 받지 못했으면 bValid == false (단위 초)
+	struct LinkTiming
+	{
+		bool bValid;
+		double rtt;
+		double jitter;
+
+		// 상대 시계 - 로컬 시계
+		double clockOffset;
+	};
+
+	LinkTiming GetLinkTiming();
+
+	// 상대가 tick을 시뮬레이션한 시각을 로컬 단조 시계(초)로, 받은 위치가 얼마나 오래됐는지 알 수 있음
+	double PeerTickToLocalTime(const uint32_t tick);
+
 	template <class COM>
 	static inline void ReleaseCOM(COM*& com)
 	{
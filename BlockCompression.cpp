@@ -0,0 +1,698 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(BLOCK_COMPRESSION_NO_SIMD)
+#define BLOCK_COMPRESSION_SSE2 (1)
+#include <emmintrin.h>
+#else
+#define BLOCK_COMPRESSION_SSE2 (0)
+#endif
+
+namespace BlockCompression
+{
+	enum
+	{
+		MAX_CHANNEL_COUNT = 4,
+		BC1_PALETTE_SIZE = 4,
+		BC7_PALETTE_SIZE = 16,
+
+		// 고른 번호로 끝점을 다시 맞추는 최대 횟수, 오차가 줄지 않으면 먼저 멈춤
+		REFINE_ITERATION_COUNT = 2,
+
+		// 주축을 찾는 거듭제곱법 반복 횟수
+		POWER_ITERATION_COUNT = 8
+	};
+
+	// 번호별로 끝점 1 쪽에 두는 비율
+	static const float BC1_WEIGHTS[BC1_PALETTE_SIZE] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+
+	// BC7 4비트 번호의 보간 가중치 (/64)
+	static const int BC7_WEIGHTS[BC7_PALETTE_SIZE] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// 채널별로 모은 텍셀, SIMD로 4개씩 처리
+	struct Texels
+	{
+		alignas(16) float channels[MAX_CHANNEL_COUNT][BLOCK_TEXEL_COUNT];
+	};
+
+	static void loadTexels(const uint8_t* pTexels, Texels& outTexels)
+	{
+		for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+			{
+				outTexels.channels[c][i] = static_cast<float>(pTexels[i * MAX_CHANNEL_COUNT + c]);
+			}
+		}
+	}
+
+	// 텍셀마다 팔레트에서 가장 가까운 색의 번호를 고르고 제곱 오차의 합을 반환
+	// 거리가 같으면 앞 번호, SIMD와 스칼라가 같은 순서로 더해서 결과가 같음
+	static float selectIndices(
+		const Texels& texels,
+		const int channelCount,
+		const float (*pPalette)[MAX_CHANNEL_COUNT],
+		const int paletteSize,
+		uint8_t* pOutIndices
+	)
+	{
+#if BLOCK_COMPRESSION_SSE2
+		__m128 totalError = _mm_setzero_ps();
+
+		for (int group = 0; group < BLOCK_TEXEL_COUNT; group += 4)
+		{
+			__m128 bestError = _mm_set1_ps(FLT_MAX);
+			__m128i bestIndex = _mm_setzero_si128();
+
+			for (int p = 0; p < paletteSize; ++p)
+			{
+				__m128 error = _mm_setzero_ps();
+				for (int c = 0; c < channelCount; ++c)
+				{
+					const __m128 diff = _mm_sub_ps(_mm_load_ps(&texels.channels[c][group]), _mm_set1_ps(pPalette[p][c]));
+					error = _mm_add_ps(error, _mm_mul_ps(diff, diff));
+				}
+
+				const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, bestError));
+				bestError = _mm_min_ps(error, bestError);
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(p)), _mm_andnot_si128(closer, bestIndex));
+			}
+
+			alignas(16) int32_t indices[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(indices), bestIndex);
+
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				pOutIndices[group + lane] = static_cast<uint8_t>(indices[lane]);
+			}
+
+			totalError = _mm_add_ps(totalError, bestError);
+		}
+
+		alignas(16) float laneErrors[4];
+		_mm_store_ps(laneErrors, totalError);
+#else
+		float laneErrors[4] = { 0.f, 0.f, 0.f, 0.f };
+
+		for (int group = 0; group < BLOCK_TEXEL_COUNT; group += 4)
+		{
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				const int texel = group + lane;
+
+				float bestError = FLT_MAX;
+				int bestIndex = 0;
+
+				for (int p = 0; p < paletteSize; ++p)
+				{
+					float error = 0.f;
+					for (int c = 0; c < channelCount; ++c)
+					{
+						const float diff = texels.channels[c][texel] - pPalette[p][c];
+						error = error + diff * diff;
+					}
+
+					if (error < bestError)
+					{
+						bestError = error;
+						bestIndex = p;
+					}
+				}
+
+				pOutIndices[texel] = static_cast<uint8_t>(bestIndex);
+				laneErrors[lane] += bestError;
+			}
+		}
+#endif
+
+		return (laneErrors[0] + laneErrors[1]) + (laneErrors[2] + laneErrors[3]);
+	}
+
+	// 평균과 분산이 가장 큰 방향 (공분산 행렬에 거듭제곱법), 모든 텍셀이 같으면 방향은 0
+	static void computePrincipalAxis(const Texels& texels, const int channelCount, float* pOutMean, float* pOutAxis)
+	{
+		for (int c = 0; c < channelCount; ++c)
+		{
+			float sum = 0.f;
+			for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+			{
+				sum += texels.channels[c][i];
+			}
+
+			pOutMean[c] = sum / BLOCK_TEXEL_COUNT;
+		}
+
+		float covariance[MAX_CHANNEL_COUNT][MAX_CHANNEL_COUNT] = {};
+		for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			for (int a = 0; a < channelCount; ++a)
+			{
+				const float diffA = texels.channels[a][i] - pOutMean[a];
+				for (int b = a; b < channelCount; ++b)
+				{
+					covariance[a][b] += diffA * (texels.channels[b][i] - pOutMean[b]);
+				}
+			}
+		}
+
+		for (int a = 0; a < channelCount; ++a)
+		{
+			for (int b = 0; b < a; ++b)
+			{
+				covariance[a][b] = covariance[b][a];
+			}
+		}
+
+		// 가장 넓게 퍼진 채널의 행에서 시작
+		int widestChannel = 0;
+		for (int c = 1; c < channelCount; ++c)
+		{
+			if (covariance[c][c] > covariance[widestChannel][widestChannel])
+			{
+				widestChannel = c;
+			}
+		}
+
+		float axis[MAX_CHANNEL_COUNT];
+		for (int c = 0; c < channelCount; ++c)
+		{
+			axis[c] = covariance[widestChannel][c];
+		}
+
+		for (int iteration = 0; iteration < POWER_ITERATION_COUNT; ++iteration)
+		{
+			float next[MAX_CHANNEL_COUNT];
+			float maxComponent = 0.f;
+			for (int a = 0; a < channelCount; ++a)
+			{
+				next[a] = 0.f;
+				for (int b = 0; b < channelCount; ++b)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+
+				maxComponent = std::max(maxComponent, std::fabs(next[a]));
+			}
+
+			if (maxComponent < 1e-6f)
+			{
+				break;
+			}
+
+			for (int c = 0; c < channelCount; ++c)
+			{
+				axis[c] = next[c] / maxComponent;
+			}
+		}
+
+		float lengthSq = 0.f;
+		for (int c = 0; c < channelCount; ++c)
+		{
+			lengthSq += axis[c] * axis[c];
+		}
+
+		const float invLength = lengthSq > 1e-12f ? 1.f / std::sqrt(lengthSq) : 0.f;
+		for (int c = 0; c < channelCount; ++c)
+		{
+			pOutAxis[c] = axis[c] * invLength;
+		}
+	}
+
+	// 주축 위로 투영한 텍셀의 양 끝, insetDivisor가 0이 아니면 범위의 1/insetDivisor만큼 안쪽으로
+	static void computeEndpoints(
+		const Texels& texels,
+		const int channelCount,
+		const float* pMean,
+		const float* pAxis,
+		const float insetDivisor,
+		float* pOutStart,
+		float* pOutEnd
+	)
+	{
+		float minProjection = 0.f;
+		float maxProjection = 0.f;
+
+		for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			float projection = 0.f;
+			for (int c = 0; c < channelCount; ++c)
+			{
+				projection += (texels.channels[c][i] - pMean[c]) * pAxis[c];
+			}
+
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		if (insetDivisor > 0.f)
+		{
+			const float inset = (maxProjection - minProjection) / insetDivisor;
+			minProjection += inset;
+			maxProjection -= inset;
+		}
+
+		for (int c = 0; c < channelCount; ++c)
+		{
+			pOutStart[c] = std::min(std::max(pMean[c] + pAxis[c] * minProjection, 0.f), 255.f);
+			pOutEnd[c] = std::min(std::max(pMean[c] + pAxis[c] * maxProjection, 0.f), 255.f);
+		}
+	}
+
+	// (1 - w) * start + w * end가 텍셀에 가장 가깝도록 끝점을 최소제곱으로 맞춤, 모든 번호가 같으면 false
+	static bool fitEndpoints(
+		const Texels& texels,
+		const int channelCount,
+		const uint8_t* pIndices,
+		const float* pWeights,
+		float* pOutStart,
+		float* pOutEnd
+	)
+	{
+		float aa = 0.f;
+		float ab = 0.f;
+		float bb = 0.f;
+		float ax[MAX_CHANNEL_COUNT] = {};
+		float bx[MAX_CHANNEL_COUNT] = {};
+
+		for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			const float b = pWeights[pIndices[i]];
+			const float a = 1.f - b;
+
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+
+			for (int c = 0; c < channelCount; ++c)
+			{
+				ax[c] += a * texels.channels[c][i];
+				bx[c] += b * texels.channels[c][i];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+
+		for (int c = 0; c < channelCount; ++c)
+		{
+			pOutStart[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) / determinant, 0.f), 255.f);
+			pOutEnd[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) / determinant, 0.f), 255.f);
+		}
+
+		return true;
+	}
+
+	// 128비트 블록에 낮은 비트부터 채움
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(uint8_t* pOut)
+			: mpOut(pOut)
+			, mPosition(0)
+		{
+			memset(pOut, 0, BC7_BLOCK_BYTES);
+		}
+
+		void Write(const uint32_t value, const uint32_t bitCount)
+		{
+			for (uint32_t i = 0; i < bitCount; ++i, ++mPosition)
+			{
+				mpOut[mPosition / 8] |= static_cast<uint8_t>(((value >> i) & 1) << (mPosition % 8));
+			}
+		}
+
+	private:
+		uint8_t* mpOut;
+		uint32_t mPosition;
+	};
+
+	class BitReader
+	{
+	public:
+		explicit BitReader(const uint8_t* pBlock)
+			: mpBlock(pBlock)
+			, mPosition(0)
+		{
+		}
+
+		uint32_t Read(const uint32_t bitCount)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < bitCount; ++i, ++mPosition)
+			{
+				value |= static_cast<uint32_t>((mpBlock[mPosition / 8] >> (mPosition % 8)) & 1) << i;
+			}
+
+			return value;
+		}
+
+	private:
+		const uint8_t* mpBlock;
+		uint32_t mPosition;
+	};
+
+	static uint16_t quantize565(const float* pColor)
+	{
+		const uint32_t r = static_cast<uint32_t>(pColor[0] * 31.f / 255.f + 0.5f);
+		const uint32_t g = static_cast<uint32_t>(pColor[1] * 63.f / 255.f + 0.5f);
+		const uint32_t b = static_cast<uint32_t>(pColor[2] * 31.f / 255.f + 0.5f);
+
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	static void expand565(const uint16_t color, int* pOutColor)
+	{
+		const int r = (color >> 11) & 31;
+		const int g = (color >> 5) & 63;
+		const int b = color & 31;
+
+		pOutColor[0] = (r << 3) | (r >> 2);
+		pOutColor[1] = (g << 2) | (g >> 4);
+		pOutColor[2] = (b << 3) | (b >> 2);
+	}
+
+	struct BC1Candidate
+	{
+		uint16_t color0;
+		uint16_t color1;
+		uint8_t indices[BLOCK_TEXEL_COUNT];
+		float error;
+	};
+
+	// color0 > color1 (4색 모드)로 정렬하고 번호를 고름
+	static void evaluateBC1(const Texels& texels, const uint16_t colorA, const uint16_t colorB, BC1Candidate& outCandidate)
+	{
+		outCandidate.color0 = std::max(colorA, colorB);
+		outCandidate.color1 = std::min(colorA, colorB);
+
+		int endpoints[2][3];
+		expand565(outCandidate.color0, endpoints[0]);
+		expand565(outCandidate.color1, endpoints[1]);
+
+		float palette[BC1_PALETTE_SIZE][MAX_CHANNEL_COUNT] = {};
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[0][c] = static_cast<float>(endpoints[0][c]);
+			palette[1][c] = static_cast<float>(endpoints[1][c]);
+			palette[2][c] = static_cast<float>((2 * endpoints[0][c] + endpoints[1][c]) / 3);
+			palette[3][c] = static_cast<float>((endpoints[0][c] + 2 * endpoints[1][c]) / 3);
+		}
+
+		// 두 끝점이 같으면 3색 모드가 되어 3번이 투명한 검정이므로 0번만 사용
+		const int paletteSize = outCandidate.color0 == outCandidate.color1 ? 1 : BC1_PALETTE_SIZE;
+
+		outCandidate.error = selectIndices(texels, 3, palette, paletteSize, outCandidate.indices);
+	}
+
+	void EncodeBC1(const uint8_t* pTexels, uint8_t* pOutBlock)
+	{
+		Texels texels;
+		loadTexels(pTexels, texels);
+
+		float mean[MAX_CHANNEL_COUNT];
+		float axis[MAX_CHANNEL_COUNT];
+		computePrincipalAxis(texels, 3, mean, axis);
+
+		// 양 끝의 튀는 텍셀에 끌려가지 않도록 범위의 1/16만큼 안쪽에서 시작 (stb_dxt와 같은 방식)
+		float start[MAX_CHANNEL_COUNT];
+		float end[MAX_CHANNEL_COUNT];
+		computeEndpoints(texels, 3, mean, axis, 16.f, start, end);
+
+		BC1Candidate best;
+		evaluateBC1(texels, quantize565(start), quantize565(end), best);
+
+		for (int iteration = 0; iteration < REFINE_ITERATION_COUNT && best.color0 != best.color1; ++iteration)
+		{
+			if (!fitEndpoints(texels, 3, best.indices, BC1_WEIGHTS, start, end))
+			{
+				break;
+			}
+
+			BC1Candidate candidate;
+			evaluateBC1(texels, quantize565(start), quantize565(end), candidate);
+
+			if (candidate.error >= best.error)
+			{
+				break;
+			}
+
+			best = candidate;
+		}
+
+		uint32_t indexBits = 0;
+		for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			indexBits |= static_cast<uint32_t>(best.indices[i]) << (i * 2);
+		}
+
+		pOutBlock[0] = static_cast<uint8_t>(best.color0);
+		pOutBlock[1] = static_cast<uint8_t>(best.color0 >> 8);
+		pOutBlock[2] = static_cast<uint8_t>(best.color1);
+		pOutBlock[3] = static_cast<uint8_t>(best.color1 >> 8);
+		pOutBlock[4] = static_cast<uint8_t>(indexBits);
+		pOutBlock[5] = static_cast<uint8_t>(indexBits >> 8);
+		pOutBlock[6] = static_cast<uint8_t>(indexBits >> 16);
+		pOutBlock[7] = static_cast<uint8_t>(indexBits >> 24);
+	}
+
+	void DecodeBC1(const uint8_t* pBlock, uint8_t* pOutTexels)
+	{
+		const uint16_t color0 = static_cast<uint16_t>(pBlock[0] | (pBlock[1] << 8));
+		const uint16_t color1 = static_cast<uint16_t>(pBlock[2] | (pBlock[3] << 8));
+		const uint32_t indexBits = pBlock[4] | (pBlock[5] << 8) | (pBlock[6] << 16) | (static_cast<uint32_t>(pBlock[7]) << 24);
+
+		int endpoints[2][3];
+		expand565(color0, endpoints[0]);
+		expand565(color1, endpoints[1]);
+
+		uint8_t palette[BC1_PALETTE_SIZE][MAX_CHANNEL_COUNT];
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[0][c] = static_cast<uint8_t>(endpoints[0][c]);
+			palette[1][c] = static_cast<uint8_t>(endpoints[1][c]);
+
+			if (color0 > color1)
+			{
+				palette[2][c] = static_cast<uint8_t>((2 * endpoints[0][c] + endpoints[1][c]) / 3);
+				palette[3][c] = static_cast<uint8_t>((endpoints[0][c] + 2 * endpoints[1][c]) / 3);
+			}
+			else
+			{
+				palette[2][c] = static_cast<uint8_t>((endpoints[0][c] + endpoints[1][c]) / 2);
+				palette[3][c] = 0;
+			}
+		}
+
+		palette[0][3] = 255;
+		palette[1][3] = 255;
+		palette[2][3] = 255;
+		palette[3][3] = color0 > color1 ? 255 : 0;
+
+		for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			memcpy(pOutTexels + i * MAX_CHANNEL_COUNT, palette[(indexBits >> (i * 2)) & 3], MAX_CHANNEL_COUNT);
+		}
+	}
+
+	struct BC7Candidate
+	{
+		// p비트를 포함한 8비트 끝점
+		uint8_t endpoints[2][MAX_CHANNEL_COUNT];
+		uint32_t pBits[2];
+		uint8_t indices[BLOCK_TEXEL_COUNT];
+		float error;
+	};
+
+	// 7비트 값과 공유 p비트로 가장 가까운 끝점
+	static void quantizeBC7Endpoint(const float* pColor, uint8_t* pOutValues, uint32_t& outPBit)
+	{
+		float bestError = FLT_MAX;
+
+		for (uint32_t pBit = 0; pBit < 2; ++pBit)
+		{
+			uint8_t values[MAX_CHANNEL_COUNT];
+			float error = 0.f;
+
+			for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+			{
+				const int quantized = std::min(std::max(static_cast<int>(std::floor((pColor[c] - pBit) * 0.5f + 0.5f)), 0), 127);
+				values[c] = static_cast<uint8_t>((quantized << 1) | pBit);
+
+				const float diff = values[c] - pColor[c];
+				error += diff * diff;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				outPBit = pBit;
+				memcpy(pOutValues, values, sizeof(values));
+			}
+		}
+	}
+
+	static void makeBC7Palette(const uint8_t (*pEndpoints)[MAX_CHANNEL_COUNT], uint8_t (*pOutPalette)[MAX_CHANNEL_COUNT])
+	{
+		for (int i = 0; i < BC7_PALETTE_SIZE; ++i)
+		{
+			const int weight = BC7_WEIGHTS[i];
+			for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+			{
+				pOutPalette[i][c] = static_cast<uint8_t>(((64 - weight) * pEndpoints[0][c] + weight * pEndpoints[1][c] + 32) >> 6);
+			}
+		}
+	}
+
+	static void evaluateBC7(const Texels& texels, const float* pStart, const float* pEnd, BC7Candidate& outCandidate)
+	{
+		quantizeBC7Endpoint(pStart, outCandidate.endpoints[0], outCandidate.pBits[0]);
+		quantizeBC7Endpoint(pEnd, outCandidate.endpoints[1], outCandidate.pBits[1]);
+
+		uint8_t palette[BC7_PALETTE_SIZE][MAX_CHANNEL_COUNT];
+		makeBC7Palette(outCandidate.endpoints, palette);
+
+		float paletteValues[BC7_PALETTE_SIZE][MAX_CHANNEL_COUNT];
+		for (int i = 0; i < BC7_PALETTE_SIZE; ++i)
+		{
+			for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+			{
+				paletteValues[i][c] = palette[i][c];
+			}
+		}
+
+		outCandidate.error = selectIndices(texels, MAX_CHANNEL_COUNT, paletteValues, BC7_PALETTE_SIZE, outCandidate.indices);
+	}
+
+	void EncodeBC7(const uint8_t* pTexels, uint8_t* pOutBlock)
+	{
+		static float sWeights[BC7_PALETTE_SIZE];
+		static const bool sbWeightsReady = []()
+		{
+			for (int i = 0; i < BC7_PALETTE_SIZE; ++i)
+			{
+				sWeights[i] = BC7_WEIGHTS[i] / 64.f;
+			}
+
+			return true;
+		}();
+		(void)sbWeightsReady;
+
+		Texels texels;
+		loadTexels(pTexels, texels);
+
+		float mean[MAX_CHANNEL_COUNT];
+		float axis[MAX_CHANNEL_COUNT];
+		computePrincipalAxis(texels, MAX_CHANNEL_COUNT, mean, axis);
+
+		// 16단계라 BC1보다 양 끝에 가까운 색이 많으므로 안쪽으로 당기지 않음
+		float start[MAX_CHANNEL_COUNT];
+		float end[MAX_CHANNEL_COUNT];
+		computeEndpoints(texels, MAX_CHANNEL_COUNT, mean, axis, 0.f, start, end);
+
+		BC7Candidate best;
+		evaluateBC7(texels, start, end, best);
+
+		for (int iteration = 0; iteration < REFINE_ITERATION_COUNT && best.error > 0.f; ++iteration)
+		{
+			if (!fitEndpoints(texels, MAX_CHANNEL_COUNT, best.indices, sWeights, start, end))
+			{
+				break;
+			}
+
+			BC7Candidate candidate;
+			evaluateBC7(texels, start, end, candidate);
+
+			if (candidate.error >= best.error)
+			{
+				break;
+			}
+
+			best = candidate;
+		}
+
+		// 0번 텍셀 번호의 최상위 비트는 저장하지 않으므로 0이 되도록 끝점을 바꿈
+		if ((best.indices[0] & 8) != 0)
+		{
+			for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+			{
+				std::swap(best.endpoints[0][c], best.endpoints[1][c]);
+			}
+
+			std::swap(best.pBits[0], best.pBits[1]);
+
+			for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+			{
+				best.indices[i] = static_cast<uint8_t>(BC7_PALETTE_SIZE - 1 - best.indices[i]);
+			}
+		}
+
+		BitWriter writer(pOutBlock);
+
+		// 모드 번호만큼 0 다음에 1
+		writer.Write(1 << 6, 7);
+
+		for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+		{
+			writer.Write(best.endpoints[0][c] >> 1, 7);
+			writer.Write(best.endpoints[1][c] >> 1, 7);
+		}
+
+		writer.Write(best.pBits[0], 1);
+		writer.Write(best.pBits[1], 1);
+
+		writer.Write(best.indices[0], 3);
+		for (int i = 1; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			writer.Write(best.indices[i], 4);
+		}
+	}
+
+	bool DecodeBC7(const uint8_t* pBlock, uint8_t* pOutTexels)
+	{
+		if ((pBlock[0] & 0x7f) != (1 << 6))
+		{
+			return false;
+		}
+
+		BitReader reader(pBlock);
+		reader.Read(7);
+
+		uint8_t endpoints[2][MAX_CHANNEL_COUNT];
+		for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+		{
+			endpoints[0][c] = static_cast<uint8_t>(reader.Read(7) << 1);
+			endpoints[1][c] = static_cast<uint8_t>(reader.Read(7) << 1);
+		}
+
+		const uint32_t pBit0 = reader.Read(1);
+		const uint32_t pBit1 = reader.Read(1);
+		for (int c = 0; c < MAX_CHANNEL_COUNT; ++c)
+		{
+			endpoints[0][c] |= pBit0;
+			endpoints[1][c] |= pBit1;
+		}
+
+		uint8_t palette[BC7_PALETTE_SIZE][MAX_CHANNEL_COUNT];
+		makeBC7Palette(endpoints, palette);
+
+		for (int i = 0; i < BLOCK_TEXEL_COUNT; ++i)
+		{
+			const uint32_t index = reader.Read(i == 0 ? 3 : 4);
+			memcpy(pOutTexels + i * MAX_CHANNEL_COUNT, palette[index], MAX_CHANNEL_COUNT);
+		}
+
+		return true;
+	}
+
+	const char* GetInstructionSetName()
+	{
+		return BLOCK_COMPRESSION_SSE2 ? "SSE2" : "scalar";
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// 4x4 텍셀 블록 압축 (BC1, BC7)
+// 블록마다 주성분 방향으로 끝점을 잡고, 팔레트에서 가장 가까운 색 고르기를 SIMD(SSE2)로 계산한 뒤
+// 고른 번호로 끝점을 최소제곱으로 다시 맞춤
+// BLOCK_COMPRESSION_NO_SIMD를 정의하면 같은 결과를 내는 스칼라 코드만 사용
+namespace BlockCompression
+{
+	enum
+	{
+		BLOCK_DIMENSION = 4,
+		BLOCK_TEXEL_COUNT = BLOCK_DIMENSION * BLOCK_DIMENSION,
+
+		BC1_BLOCK_BYTES = 8,
+		BC7_BLOCK_BYTES = 16
+	};
+
+	// pTexels는 4x4 RGBA8 (행 우선 64바이트)
+
+	// 불투명 전용, 알파는 무시하고 항상 4색 모드
+	void EncodeBC1(const uint8_t* pTexels, uint8_t* pOutBlock);
+
+	// 모드 6 (한 영역, RGBA 7비트 + p비트 끝점, 4비트 번호)
+	void EncodeBC7(const uint8_t* pTexels, uint8_t* pOutBlock);
+
+	void DecodeBC1(const uint8_t* pBlock, uint8_t* pOutTexels);
+
+	// 검증용이라 EncodeBC7이 만드는 모드 6만 풀 수 있음, 다른 모드면 false
+	bool DecodeBC7(const uint8_t* pBlock, uint8_t* pOutTexels);
+
+	// "SSE2" 또는 "scalar"
+	const char* GetInstructionSetName();
+}
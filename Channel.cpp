@@ -0,0 +1,372 @@
+#include "Channel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace Channel
+{
+	UnreliableSequenced::UnreliableSequenced()
+		: mLastReceivedSequence(0)
+		, mbReceivedAny(false)
+		, mDroppedCount(0)
+	{
+	}
+
+	bool UnreliableSequenced::Accept(const uint16_t sequence)
+	{
+		if (mbReceivedAny && !IsNewerSequence(sequence, mLastReceivedSequence))
+		{
+			++mDroppedCount;
+			return false;
+		}
+
+		mLastReceivedSequence = sequence;
+		mbReceivedAny = true;
+
+		return true;
+	}
+
+	SendThrottle::SendThrottle(const double heartbeatInterval, const double maxSendRate)
+		: mHeartbeatInterval(heartbeatInterval)
+		, mMinSendInterval(maxSendRate > 0.0 ? 1.0 / maxSendRate : 0.0)
+		, mLastSentTime(0.0)
+		, mbSentAny(false)
+		, mbChangePending(false)
+		, mbSettlePending(false)
+		, mSentCount(0)
+		, mSuppressedCount(0)
+	{
+		assert(heartbeatInterval > 0.0);
+	}
+
+	bool SendThrottle::ShouldSend(const bool bChanged, const double now)
+	{
+		mbChangePending = mbChangePending || bChanged;
+
+		// 틱 간격의 배수로 설정해도 부동소수 오차로 한 틱 밀리지 않도록
+		const double elapsed = now - mLastSentTime + 1e-6;
+
+		bool bSend;
+		if (!mbSentAny)
+		{
+			bSend = true;
+		}
+		else if (elapsed < mMinSendInterval)
+		{
+			bSend = false;
+		}
+		else
+		{
+			bSend = mbChangePending || mbSettlePending || elapsed >= mHeartbeatInterval;
+		}
+
+		if (!bSend)
+		{
+			++mSuppressedCount;
+			return false;
+		}
+
+		mLastSentTime = now;
+		mbSentAny = true;
+		mbSettlePending = mbChangePending;
+		mbChangePending = false;
+		++mSentCount;
+
+		return true;
+	}
+
+	static constexpr double INITIAL_RESEND_TIMEOUT = 0.2;
+	static constexpr double MIN_RESEND_TIMEOUT = 0.02;
+	static constexpr double MAX_RESEND_TIMEOUT = 1.0;
+
+	AckTracker::AckTracker()
+		: mSendSequence(0)
+		, mRemoteSequence(0)
+		, mRemoteAckBits(0)
+		, mbReceivedAny(false)
+		, mbHasRttSample(false)
+		, mSmoothedRtt(0.0)
+		, mRttVariance(0.0)
+		, mResendTimeout(INITIAL_RESEND_TIMEOUT)
+	{
+		memset(mSentPackets, 0, sizeof(mSentPackets));
+	}
+
+	uint16_t AckTracker::NextSendSequence(const double now)
+	{
+		// 한 바퀴 돌 때 NO_ACK는 건너뜀
+		if (mSendSequence == NO_ACK)
+		{
+			++mSendSequence;
+		}
+
+		const uint16_t sequence = mSendSequence++;
+
+		SentPacket& sentPacket = mSentPackets[sequence % SENT_PACKET_HISTORY];
+		sentPacket.sequence = sequence;
+		sentPacket.bValid = true;
+		sentPacket.bAcked = false;
+		sentPacket.sentTime = now;
+
+		return sequence;
+	}
+
+	void AckTracker::OnPacketReceived(const uint16_t sequence)
+	{
+		if (!mbReceivedAny)
+		{
+			mRemoteSequence = sequence;
+			mRemoteAckBits = 0;
+			mbReceivedAny = true;
+
+			return;
+		}
+
+		if (IsNewerSequence(sequence, mRemoteSequence))
+		{
+			const uint16_t shift = static_cast<uint16_t>(sequence - mRemoteSequence);
+
+			// 이전 최신 시퀀스도 비트 필드로 밀려 들어감
+			if (shift > ACK_BITS)
+			{
+				mRemoteAckBits = 0;
+			}
+			else if (shift == ACK_BITS)
+			{
+				mRemoteAckBits = 1u << (ACK_BITS - 1);
+			}
+			else
+			{
+				mRemoteAckBits = (mRemoteAckBits << shift) | (1u << (shift - 1));
+			}
+
+			mRemoteSequence = sequence;
+		}
+		else
+		{
+			const uint16_t distance = static_cast<uint16_t>(mRemoteSequence - sequence);
+			if (distance >= 1 && distance <= ACK_BITS)
+			{
+				mRemoteAckBits |= 1u << (distance - 1);
+			}
+		}
+	}
+
+	void AckTracker::GetAcks(uint16_t& outAck, uint32_t& outAckBits) const
+	{
+		// 아직 받은 게 없으면 상대가 무시하는 값을 보냄
+		// 내 시퀀스로 만든 값은 상대가 실제로 보냈다가 잃은 패킷과 겹칠 수 있음
+		outAck = mbReceivedAny ? mRemoteSequence : static_cast<uint16_t>(NO_ACK);
+		outAckBits = mbReceivedAny ? mRemoteAckBits : 0;
+	}
+
+	bool AckTracker::markAcked(const uint16_t sequence, const double now)
+	{
+		if (sequence == NO_ACK)
+		{
+			return false;
+		}
+
+		SentPacket& sentPacket = mSentPackets[sequence % SENT_PACKET_HISTORY];
+		if (!sentPacket.bValid || sentPacket.sequence != sequence || sentPacket.bAcked)
+		{
+			return false;
+		}
+
+		sentPacket.bAcked = true;
+
+		const double rtt = now - sentPacket.sentTime;
+		if (!mbHasRttSample)
+		{
+			mSmoothedRtt = rtt;
+			mRttVariance = rtt * 0.5;
+			mbHasRttSample = true;
+		}
+		else
+		{
+			mRttVariance = 0.75 * mRttVariance + 0.25 * std::fabs(mSmoothedRtt - rtt);
+			mSmoothedRtt = 0.875 * mSmoothedRtt + 0.125 * rtt;
+		}
+
+		mResendTimeout = std::min(std::max(mSmoothedRtt + 4.0 * mRttVariance, MIN_RESEND_TIMEOUT), MAX_RESEND_TIMEOUT);
+
+		return true;
+	}
+
+	ReliableOrdered::ReliableOrdered()
+		: mNextSendId(0)
+		, mOldestUnackedId(0)
+		, mResendCount(0)
+		, mNextReceiveId(0)
+	{
+		memset(mSendSlots, 0, sizeof(mSendSlots));
+		memset(mSentPackets, 0, sizeof(mSentPackets));
+		memset(mReceiveSlots, 0, sizeof(mReceiveSlots));
+	}
+
+	bool ReliableOrdered::Send(
+		const Protocol::EMessageType type,
+		const uint32_t tick,
+		const void* pPayload,
+		const size_t payloadSize
+	)
+	{
+		if (GetPendingCount() >= WINDOW_SIZE)
+		{
+			return false;
+		}
+
+		SendSlot& slot = mSendSlots[mNextSendId % WINDOW_SIZE];
+		assert(!slot.bInUse);
+
+		const size_t size = Protocol::WriteMessage(slot.data, sizeof(slot.data), type, mNextSendId, tick, pPayload, payloadSize);
+		if (size == 0)
+		{
+			return false;
+		}
+
+		slot.bInUse = true;
+		slot.bAcked = false;
+		slot.bSent = false;
+		slot.lastSentTime = 0.0;
+		slot.size = static_cast<uint16_t>(size);
+
+		++mNextSendId;
+
+		return true;
+	}
+
+	size_t ReliableOrdered::WriteMessages(
+		const uint16_t packetSequence,
+		uint8_t* pOutBuffer,
+		const size_t bufferSize,
+		const double now,
+		const double resendTimeout
+	)
+	{
+		SentPacketMessages& sentPacket = mSentPackets[packetSequence % AckTracker::SENT_PACKET_HISTORY];
+		sentPacket.packetSequence = packetSequence;
+		sentPacket.bValid = true;
+		sentPacket.count = 0;
+
+		const size_t capacity = std::min<size_t>(bufferSize, MAX_BYTES_PER_PACKET);
+		size_t writtenSize = 0;
+
+		for (uint16_t id = mOldestUnackedId; id != mNextSendId; ++id)
+		{
+			SendSlot& slot = mSendSlots[id % WINDOW_SIZE];
+			if (slot.bAcked || (slot.bSent && now - slot.lastSentTime < resendTimeout))
+			{
+				continue;
+			}
+
+			if (writtenSize + slot.size > capacity)
+			{
+				break;
+			}
+
+			memcpy(pOutBuffer + writtenSize, slot.data, slot.size);
+			writtenSize += slot.size;
+
+			if (slot.bSent)
+			{
+				++mResendCount;
+			}
+
+			slot.bSent = true;
+			slot.lastSentTime = now;
+
+			sentPacket.messageIds[sentPacket.count++] = id;
+			if (sentPacket.count == MAX_MESSAGES_PER_PACKET)
+			{
+				break;
+			}
+		}
+
+		return writtenSize;
+	}
+
+	bool ReliableOrdered::HasMessagesToSend(const double now, const double resendTimeout) const
+	{
+		for (uint16_t id = mOldestUnackedId; id != mNextSendId; ++id)
+		{
+			const SendSlot& slot = mSendSlots[id % WINDOW_SIZE];
+			if (!slot.bAcked && (!slot.bSent || now - slot.lastSentTime >= resendTimeout))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ReliableOrdered::OnPacketAcked(const uint16_t packetSequence)
+	{
+		SentPacketMessages& sentPacket = mSentPackets[packetSequence % AckTracker::SENT_PACKET_HISTORY];
+		if (!sentPacket.bValid || sentPacket.packetSequence != packetSequence)
+		{
+			return;
+		}
+
+		for (int i = 0; i < sentPacket.count; ++i)
+		{
+			const uint16_t id = sentPacket.messageIds[i];
+			if (static_cast<uint16_t>(id - mOldestUnackedId) >= GetPendingCount())
+			{
+				continue;
+			}
+
+			mSendSlots[id % WINDOW_SIZE].bAcked = true;
+		}
+
+		sentPacket.bValid = false;
+
+		// 앞에서부터 ack된 슬롯을 비워 윈도우를 전진
+		while (mOldestUnackedId != mNextSendId && mSendSlots[mOldestUnackedId % WINDOW_SIZE].bAcked)
+		{
+			mSendSlots[mOldestUnackedId % WINDOW_SIZE].bInUse = false;
+			++mOldestUnackedId;
+		}
+	}
+
+	void ReliableOrdered::Receive(const Protocol::MessageView& message)
+	{
+		const uint16_t id = static_cast<uint16_t>(message.header.sequence);
+		const size_t size = sizeof(Protocol::MessageHeader) + message.payloadSize;
+
+		if (static_cast<uint16_t>(id - mNextReceiveId) >= WINDOW_SIZE || size > MAX_MESSAGE_SIZE)
+		{
+			return;
+		}
+
+		ReceiveSlot& slot = mReceiveSlots[id % WINDOW_SIZE];
+		if (slot.bReceived)
+		{
+			return;
+		}
+
+		memcpy(slot.data, &message.header, sizeof(Protocol::MessageHeader));
+		memcpy(slot.data + sizeof(Protocol::MessageHeader), message.pPayload, message.payloadSize);
+		slot.size = static_cast<uint16_t>(size);
+		slot.bReceived = true;
+	}
+
+	bool ReliableOrdered::PopMessage(Protocol::MessageView& outMessage)
+	{
+		ReceiveSlot& slot = mReceiveSlots[mNextReceiveId % WINDOW_SIZE];
+		if (!slot.bReceived)
+		{
+			return false;
+		}
+
+		// 슬롯은 바로 재사용될 수 있으므로 전달용 버퍼로 옮김
+		memcpy(mDeliveredData, slot.data, slot.size);
+		slot.bReceived = false;
+		++mNextReceiveId;
+
+		size_t length;
+		return Protocol::ParseMessage(mDeliveredData, slot.size, outMessage, length) == Protocol::PARSE_OK;
+	}
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Protocol.h"
+
+namespace Channel
+{
+	// 16비트 시퀀스 비교, 래핑 고려
+	inline bool IsNewerSequence(const uint16_t s1, const uint16_t s2)
+	{
+		return static_cast<int16_t>(static_cast<uint16_t>(s1 - s2)) > 0;
+	}
+
+	// 최신 상태만 의미 있는 데이터용, 늦게 오거나 중복된 패킷은 버림
+	class UnreliableSequenced
+	{
+	public:
+		UnreliableSequenced();
+
+		// 마지막으로 받은 것보다 새로운 패킷이면 true
+		bool Accept(const uint16_t sequence);
+
+		uint32_t GetDroppedCount() const
+		{
+			return mDroppedCount;
+		}
+
+	private:
+		uint16_t mLastReceivedSequence;
+		bool mbReceivedAny;
+
+		uint32_t mDroppedCount;
+	};
+
+	// 값이 바뀌었을 때만 보내고, 그대로면 heartbeat 간격마다 한 번 보냄
+	// 바뀌었어도 최대 전송률을 넘으면 다음 기회로 미룸
+	// 멈춘 뒤에는 한 번 더 보내서 받는 쪽이 멈춘 걸 알 수 있도록 함
+	class SendThrottle
+	{
+	public:
+		SendThrottle(const double heartbeatInterval, const double maxSendRate);
+
+		bool ShouldSend(const bool bChanged, const double now);
+
+		uint64_t GetSentCount() const
+		{
+			return mSentCount;
+		}
+
+		uint64_t GetSuppressedCount() const
+		{
+			return mSuppressedCount;
+		}
+
+	private:
+		double mHeartbeatInterval;
+		double mMinSendInterval;
+
+		double mLastSentTime;
+		bool mbSentAny;
+		bool mbChangePending;
+		bool mbSettlePending;
+
+		uint64_t mSentCount;
+		uint64_t mSuppressedCount;
+	};
+
+	// 패킷 시퀀스 발급과 ack/ackBits 관리, ack로 RTT 추정
+	class AckTracker
+	{
+	public:
+		enum
+		{
+			ACK_BITS = 32,
+			SENT_PACKET_HISTORY = 256,
+
+			// 아직 받은 패킷이 없을 때 보내는 ack, 이 시퀀스는 발급하지 않으므로 받는 쪽은 무시
+			NO_ACK = 0xffff
+		};
+
+		AckTracker();
+
+		uint16_t NextSendSequence(const double now);
+
+		void OnPacketReceived(const uint16_t sequence);
+		void GetAcks(uint16_t& outAck, uint32_t& outAckBits) const;
+
+		// 처음으로 ack된 패킷마다 onAcked(sequence) 호출
+		template <class Callback>
+		void ProcessAcks(const uint16_t ack, const uint32_t ackBits, const double now, Callback onAcked)
+		{
+			if (ack == NO_ACK)
+			{
+				return;
+			}
+
+			for (int i = 0; i <= ACK_BITS; ++i)
+			{
+				if (i > 0 && (ackBits & (1u << (i - 1))) == 0)
+				{
+					continue;
+				}
+
+				const uint16_t sequence = static_cast<uint16_t>(ack - i);
+				if (markAcked(sequence, now))
+				{
+					onAcked(sequence);
+				}
+			}
+		}
+
+		// 재전송 타이머 (RFC 6298 방식 srtt + 4 * rttvar)
+		double GetResendTimeout() const
+		{
+			return mResendTimeout;
+		}
+
+		double GetSmoothedRtt() const
+		{
+			return mSmoothedRtt;
+		}
+
+	private:
+		bool markAcked(const uint16_t sequence, const double now);
+
+	private:
+		struct SentPacket
+		{
+			uint16_t sequence;
+			bool bValid;
+			bool bAcked;
+			double sentTime;
+		};
+
+		uint16_t mSendSequence;
+		SentPacket mSentPackets[SENT_PACKET_HISTORY];
+
+		uint16_t mRemoteSequence;
+		uint32_t mRemoteAckBits;
+		bool mbReceivedAny;
+
+		bool mbHasRttSample;
+		double mSmoothedRtt;
+		double mRttVariance;
+		double mResendTimeout;
+	};
+
+	// 반드시 도착해야 하는 이벤트용, 패킷 ack 기반 선택적 재전송과 순서 보장
+	class ReliableOrdered
+	{
+	public:
+		enum
+		{
+			// 동시에 ack를 기다릴 수 있는 최대 메시지 수
+			WINDOW_SIZE = 64,
+
+			MAX_MESSAGE_SIZE = 128,
+			MAX_MESSAGES_PER_PACKET = 8,
+
+			// 위치 데이터 자리를 남기기 위해 패킷 하나에 싣는 최대 바이트
+			MAX_BYTES_PER_PACKET = 512
+		};
+
+		ReliableOrdered();
+
+		ReliableOrdered(const ReliableOrdered&) = delete;
+		ReliableOrdered& operator=(const ReliableOrdered&) = delete;
+
+		// 윈도우가 가득 차면 false
+		bool Send(
+			const Protocol::EMessageType type,
+			const uint32_t tick,
+			const void* pPayload,
+			const size_t payloadSize
+		);
+
+		// 새 메시지와 재전송 시간이 지난 메시지를 패킷에 채우고 기록한 바이트 수 반환
+		size_t WriteMessages(
+			const uint16_t packetSequence,
+			uint8_t* pOutBuffer,
+			const size_t bufferSize,
+			const double now,
+			const double resendTimeout
+		);
+
+		void OnPacketAcked(const uint16_t packetSequence);
+
+		// 받은 메시지를 순서 버퍼에 저장, 중복이거나 윈도우 밖이면 버림
+		void Receive(const Protocol::MessageView& message);
+
+		// 순서대로 전달할 수 있는 다음 메시지, 다음 Receive 전까지만 유효
+		bool PopMessage(Protocol::MessageView& outMessage);
+
+		size_t GetPendingCount() const
+		{
+			return static_cast<uint16_t>(mNextSendId - mOldestUnackedId);
+		}
+
+		// 아직 안 보냈거나 재전송 시간이 지난 메시지가 있으면 true
+		bool HasMessagesToSend(const double now, const double resendTimeout) const;
+
+		uint32_t GetResendCount() const
+		{
+			return mResendCount;
+		}
+
+	private:
+		struct SendSlot
+		{
+			bool bInUse;
+			bool bAcked;
+			bool bSent;
+			double lastSentTime;
+
+			uint16_t size;
+			uint8_t data[MAX_MESSAGE_SIZE];
+		};
+
+		struct SentPacketMessages
+		{
+			uint16_t packetSequence;
+			bool bValid;
+
+			uint8_t count;
+			uint16_t messageIds[MAX_MESSAGES_PER_PACKET];
+		};
+
+		struct ReceiveSlot
+		{
+			bool bReceived;
+
+			uint16_t size;
+			uint8_t data[MAX_MESSAGE_SIZE];
+		};
+
+		// 송신
+		uint16_t mNextSendId;
+		uint16_t mOldestUnackedId;
+		SendSlot mSendSlots[WINDOW_SIZE];
+		SentPacketMessages mSentPackets[AckTracker::SENT_PACKET_HISTORY];
+
+		uint32_t mResendCount;
+
+		// 수신
+		uint16_t mNextReceiveId;
+		ReceiveSlot mReceiveSlots[WINDOW_SIZE];
+		uint8_t mDeliveredData[MAX_MESSAGE_SIZE];
+	};
+}
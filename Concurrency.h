@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace Concurrency
+{
+	enum
+	{
+		CACHE_LINE_SIZE = 64
+	};
+
+	// 단일 생산자/단일 소비자 큐, 양쪽 모두 잠금과 대기 없음
+	// 생산자와 소비자 인덱스를 다른 캐시 라인에 둬서 서로의 쓰기가 간섭하지 않도록 함
+	// 정렬 요구 때문에 정적/지역 변수로만 사용 (C++14의 new는 정렬을 보장하지 않음)
+	template <class T, size_t CAPACITY>
+	class SpscQueue
+	{
+		static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+	public:
+		SpscQueue()
+			: mTail(0)
+			, mCachedHead(0)
+			, mHead(0)
+			, mCachedTail(0)
+		{
+		}
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		// 생산자 스레드 전용, 가득 차면 false
+		bool TryPush(const T& item)
+		{
+			const size_t tail = mTail.load(std::memory_order_relaxed);
+			if (tail - mCachedHead == CAPACITY)
+			{
+				mCachedHead = mHead.load(std::memory_order_acquire);
+				if (tail - mCachedHead == CAPACITY)
+				{
+					return false;
+				}
+			}
+
+			mItems[tail & (CAPACITY - 1)] = item;
+			mTail.store(tail + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		// 소비자 스레드 전용, 비어 있으면 false
+		bool TryPop(T& outItem)
+		{
+			const size_t head = mHead.load(std::memory_order_relaxed);
+			if (head == mCachedTail)
+			{
+				mCachedTail = mTail.load(std::memory_order_acquire);
+				if (head == mCachedTail)
+				{
+					return false;
+				}
+			}
+
+			outItem = mItems[head & (CAPACITY - 1)];
+			mHead.store(head + 1, std::memory_order_release);
+
+			return true;
+		}
+
+	private:
+		// 생산자가 쓰는 값
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> mTail;
+		size_t mCachedHead;
+
+		// 소비자가 쓰는 값
+		alignas(CACHE_LINE_SIZE) std::atomic<size_t> mHead;
+		size_t mCachedTail;
+
+		alignas(CACHE_LINE_SIZE) T mItems[CAPACITY];
+	};
+}
@@ -15,6 +15,7 @@
 //--------------------------------------------------------------------------------------
 
 #include "DDSTextureLoader11.h"
+#include "DdsFile.h"
 
 #include <algorithm>
 #include <cassert>
@@ -126,15 +127,13 @@ struct DDS_HEADER_DXT10
 
 #pragma pack(pop)
 
+// Header validation and file mapping are shared with the portable DdsFile code
+static_assert(sizeof(DDS_HEADER) == sizeof(DdsFile::Header), "DDS header mismatch");
+static_assert(sizeof(DDS_HEADER_DXT10) == sizeof(DdsFile::HeaderDx10), "DDS DX10 header mismatch");
+
 //--------------------------------------------------------------------------------------
 namespace
 {
-    struct handle_closer { void operator()(HANDLE h) noexcept { if (h) CloseHandle(h); } };
-
-    using ScopedHandle = std::unique_ptr<void, handle_closer>;
-
-    inline HANDLE safe_handle(HANDLE h) noexcept { return (h == INVALID_HANDLE_VALUE) ? nullptr : h; }
-
 #if defined(_DEBUG) || defined(PROFILE)
     template<UINT TNameLength>
     inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char(&name)[TNameLength]) noexcept
@@ -163,51 +162,14 @@ namespace
 
         *bitSize = 0;
 
-        if (ddsDataSize > UINT32_MAX)
-        {
-            return E_FAIL;
-        }
-
-        if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
-        {
-            return E_FAIL;
-        }
-
-        // DDS files always start with the same magic number ("DDS ")
-        auto const dwMagicNumber = *reinterpret_cast<const uint32_t*>(ddsData);
-        if (dwMagicNumber != DDS_MAGIC)
-        {
-            return E_FAIL;
-        }
-
-        auto hdr = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
-
-        // Verify header to validate DDS file
-        if (hdr->size != sizeof(DDS_HEADER) ||
-            hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+        size_t offset = 0;
+        if (!DdsFile::ParsePrefix(ddsData, ddsDataSize, offset))
         {
             return E_FAIL;
         }
 
-        // Check for DX10 extension
-        bool bDXT10Header = false;
-        if ((hdr->ddspf.flags & DDS_FOURCC) &&
-            (MAKEFOURCC('D', 'X', '1', '0') == hdr->ddspf.fourCC))
-        {
-            // Must be long enough for both headers and magic value
-            if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)))
-            {
-                return E_FAIL;
-            }
-
-            bDXT10Header = true;
-        }
-
         // setup the pointers in the process request
-        *header = hdr;
-        auto offset = sizeof(uint32_t)
-            + sizeof(DDS_HEADER)
-            + (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0u);
+        *header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
         *bitData = ddsData + offset;
         *bitSize = ddsDataSize - offset;
 
@@ -218,7 +180,7 @@ namespace
     //--------------------------------------------------------------------------------------
     HRESULT LoadTextureDataFromFile(
         _In_z_ const wchar_t* fileName,
-        std::unique_ptr<uint8_t[]>& ddsData,
+        DdsFile::MappedFile& ddsFile,
         const DDS_HEADER** header,
         const uint8_t** bitData,
         size_t* bitSize) noexcept
@@ -230,110 +192,24 @@ namespace
 
         *bitSize = 0;
 
-        // open the file
-#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-        ScopedHandle hFile(safe_handle(CreateFile2(
-            fileName,
-            GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
-            nullptr)));
-#else
-        ScopedHandle hFile(safe_handle(CreateFileW(
-            fileName,
-            GENERIC_READ, FILE_SHARE_READ,
-            nullptr,
-            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
-            nullptr)));
-#endif
-
-        if (!hFile)
-        {
-            return HRESULT_FROM_WIN32(GetLastError());
-        }
-
-        // Get the file size
-        FILE_STANDARD_INFO fileInfo;
-        if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
-        {
-            return HRESULT_FROM_WIN32(GetLastError());
-        }
-
-        // File is too big for 32-bit allocation, so reject read
-        if (fileInfo.EndOfFile.HighPart > 0)
-        {
-            return E_FAIL;
-        }
-
-        // Need at least enough data to fill the header and magic number to be a valid DDS
-        if (fileInfo.EndOfFile.LowPart < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
-        {
-            return E_FAIL;
-        }
-
-        // create enough space for the file data
-        ddsData.reset(new (std::nothrow) uint8_t[fileInfo.EndOfFile.LowPart]);
-        if (!ddsData)
-        {
-            return E_OUTOFMEMORY;
-        }
-
-        // read the data in
-        DWORD bytesRead = 0;
-        if (!ReadFile(hFile.get(),
-            ddsData.get(),
-            fileInfo.EndOfFile.LowPart,
-            &bytesRead,
-            nullptr
-        ))
+        // map the file rather than reading it into a heap copy, so the subresource
+        // data handed to CreateTexture* points straight into the mapping
+        if (!ddsFile.Open(fileName))
         {
-            ddsData.reset();
             return HRESULT_FROM_WIN32(GetLastError());
         }
 
-        if (bytesRead < fileInfo.EndOfFile.LowPart)
-        {
-            ddsData.reset();
-            return E_FAIL;
-        }
-
-        // DDS files always start with the same magic number ("DDS ")
-        auto const dwMagicNumber = *reinterpret_cast<const uint32_t*>(ddsData.get());
-        if (dwMagicNumber != DDS_MAGIC)
-        {
-            ddsData.reset();
-            return E_FAIL;
-        }
-
-        auto hdr = reinterpret_cast<const DDS_HEADER*>(ddsData.get() + sizeof(uint32_t));
-
-        // Verify header to validate DDS file
-        if (hdr->size != sizeof(DDS_HEADER) ||
-            hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+        size_t offset = 0;
+        if (!DdsFile::ParsePrefix(ddsFile.GetData(), ddsFile.GetSize(), offset))
         {
-            ddsData.reset();
+            ddsFile.Close();
             return E_FAIL;
         }
 
-        // Check for DX10 extension
-        bool bDXT10Header = false;
-        if ((hdr->ddspf.flags & DDS_FOURCC) &&
-            (MAKEFOURCC('D', 'X', '1', '0') == hdr->ddspf.fourCC))
-        {
-            // Must be long enough for both headers and magic value
-            if (fileInfo.EndOfFile.LowPart < (sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)))
-            {
-                ddsData.reset();
-                return E_FAIL;
-            }
-
-            bDXT10Header = true;
-        }
-
         // setup the pointers in the process request
-        *header = hdr;
-        auto offset = sizeof(uint32_t) + sizeof(DDS_HEADER)
-            + (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0u);
-        *bitData = ddsData.get() + offset;
-        *bitSize = fileInfo.EndOfFile.LowPart - offset;
+        *header = reinterpret_cast<const DDS_HEADER*>(ddsFile.GetData() + sizeof(uint32_t));
+        *bitData = ddsFile.GetData() + offset;
+        *bitSize = ddsFile.GetSize() - offset;
 
         return S_OK;
     }
@@ -1008,7 +884,8 @@ namespace
         _Out_ size_t& theight,
         _Out_ size_t& tdepth,
         _Out_ size_t& skipMip,
-        _Out_writes_(mipCount* arraySize) D3D11_SUBRESOURCE_DATA* initData) noexcept
+        _Out_writes_(mipCount* arraySize) D3D11_SUBRESOURCE_DATA* initData,
+        _In_opt_ const DdsFile::MappedFile* ddsFile) noexcept
     {
         if (!bitData || !initData)
         {
@@ -1055,6 +932,13 @@ namespace
                     initData[index].SysMemPitch = static_cast<UINT>(RowBytes);
                     initData[index].SysMemSlicePitch = static_cast<UINT>(NumBytes);
                     ++index;
+
+                    // Only the retained subresources are paged in from a mapped file,
+                    // mips skipped for maxsize are never read from disk
+                    if (ddsFile)
+                    {
+                        ddsFile->Prefetch(pSrcBits, NumBytes * d);
+                    }
                 }
                 else if (!j)
                 {
@@ -1346,7 +1230,8 @@ namespace
         _In_ unsigned int miscFlags,
         _In_ DDS_LOADER_FLAGS loadFlags,
         _Outptr_opt_ ID3D11Resource** texture,
-        _Outptr_opt_ ID3D11ShaderResourceView** textureView) noexcept
+        _Outptr_opt_ ID3D11ShaderResourceView** textureView,
+        _In_opt_ const DdsFile::MappedFile* ddsFile) noexcept
     {
         HRESULT hr = S_OK;
 
@@ -1667,7 +1552,7 @@ namespace
             size_t tdepth = 0;
             hr = FillInitData(width, height, depth, mipCount, arraySize,
                 format, maxsize, bitSize, bitData,
-                twidth, theight, tdepth, skipMip, initData.get());
+                twidth, theight, tdepth, skipMip, initData.get(), ddsFile);
 
             if (SUCCEEDED(hr))
             {
@@ -1713,7 +1598,7 @@ namespace
                     }
 
                     hr = FillInitData(width, height, depth, mipCount, arraySize, format, maxsize, bitSize, bitData,
-                        twidth, theight, tdepth, skipMip, initData.get());
+                        twidth, theight, tdepth, skipMip, initData.get(), ddsFile);
                     if (SUCCEEDED(hr))
                     {
                         hr = CreateD3DResources(d3dDevice,
@@ -1931,7 +1816,8 @@ HRESULT DirectX::CreateDDSTextureFromMemoryEx(
         maxsize,
         usage, bindFlags, cpuAccessFlags, miscFlags,
         loadFlags,
-        texture, textureView);
+        texture, textureView,
+        nullptr);
     if (SUCCEEDED(hr))
     {
         if (texture && *texture)
@@ -2050,9 +1936,9 @@ HRESULT DirectX::CreateDDSTextureFromFileEx(
     const uint8_t* bitData = nullptr;
     size_t bitSize = 0;
 
-    std::unique_ptr<uint8_t[]> ddsData;
+    DdsFile::MappedFile ddsFile;
     HRESULT hr = LoadTextureDataFromFile(fileName,
-        ddsData,
+        ddsFile,
         &header,
         &bitData,
         &bitSize
@@ -2067,7 +1953,8 @@ HRESULT DirectX::CreateDDSTextureFromFileEx(
         maxsize,
         usage, bindFlags, cpuAccessFlags, miscFlags,
         loadFlags,
-        texture, textureView);
+        texture, textureView,
+        &ddsFile);
 
     if (SUCCEEDED(hr))
     {
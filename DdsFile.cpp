@@ -0,0 +1,313 @@
+#include "DdsFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace DdsFile
+{
+	bool ParsePrefix(const uint8_t* pData, const size_t size, size_t& outBitDataOffset)
+	{
+		// DDSTextureLoader11은 32비트 크기까지만 다룸
+		if (size > UINT32_MAX || size < sizeof(MAGIC) + sizeof(Header))
+		{
+			return false;
+		}
+
+		uint32_t magic;
+		memcpy(&magic, pData, sizeof(magic));
+
+		Header header;
+		memcpy(&header, pData + sizeof(MAGIC), sizeof(header));
+
+		if (magic != MAGIC || header.size != sizeof(Header) || header.pixelFormat.size != sizeof(PixelFormat))
+		{
+			return false;
+		}
+
+		outBitDataOffset = sizeof(MAGIC) + sizeof(Header);
+
+		if ((header.pixelFormat.flags & PIXELFORMAT_FOURCC) != 0 && header.pixelFormat.fourCC == FOURCC_DX10)
+		{
+			if (size < DX10_PREFIX_SIZE)
+			{
+				return false;
+			}
+
+			outBitDataOffset = DX10_PREFIX_SIZE;
+		}
+
+		return true;
+	}
+
+	MappedFile::MappedFile()
+		: mpData(nullptr)
+		, mSize(0)
+	{
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const PathChar* pPath)
+	{
+		Close();
+
+		// 뷰가 매핑을 유지하므로 파일과 매핑 핸들은 바로 닫음
+#if defined(_WIN32)
+		const HANDLE hFile = CreateFileW(pPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(hFile, &fileSize))
+		{
+			CloseHandle(hFile);
+			return false;
+		}
+
+		// 빈 파일이면 여기서 ERROR_FILE_INVALID로 실패
+		const HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(hFile);
+
+		if (hMapping == nullptr)
+		{
+			return false;
+		}
+
+		const void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(hMapping);
+
+		if (pView == nullptr)
+		{
+			return false;
+		}
+
+		mSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+		const int file = open(pPath, O_RDONLY | O_CLOEXEC);
+		if (file < 0)
+		{
+			return false;
+		}
+
+		struct stat fileStat;
+		if (fstat(file, &fileStat) != 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// 빈 파일이면 여기서 EINVAL로 실패
+		void* pView = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+
+		if (pView == MAP_FAILED)
+		{
+			return false;
+		}
+
+		mSize = static_cast<size_t>(fileStat.st_size);
+
+		// 헤더를 읽을 때 주변(건너뛸 mip 0)까지 미리 읽지 않도록 함, 쓸 범위는 Prefetch로 읽음
+		madvise(pView, mSize, MADV_RANDOM);
+#endif
+
+		mpData = static_cast<const uint8_t*>(pView);
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (mpData == nullptr)
+		{
+			return;
+		}
+
+#if defined(_WIN32)
+		UnmapViewOfFile(mpData);
+#else
+		munmap(const_cast<uint8_t*>(mpData), mSize);
+#endif
+
+		mpData = nullptr;
+		mSize = 0;
+	}
+
+	void MappedFile::Prefetch(const uint8_t* pBegin, const size_t size) const
+	{
+		const uint8_t* pEnd = pBegin + size;
+		pBegin = std::max(pBegin, mpData);
+		pEnd = std::min(pEnd, mpData + mSize);
+
+		if (pBegin >= pEnd)
+		{
+			return;
+		}
+
+#if defined(_WIN32)
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = const_cast<uint8_t*>(pBegin);
+		range.NumberOfBytes = static_cast<size_t>(pEnd - pBegin);
+
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+		// madvise는 페이지 경계에서 시작해야 함
+		static const uintptr_t sPageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+		const uintptr_t begin = reinterpret_cast<uintptr_t>(pBegin) & ~(sPageSize - 1);
+		const size_t length = reinterpret_cast<uintptr_t>(pEnd) - begin;
+
+		// 읽는 중인 페이지에 접근해도 한 페이지씩 읽지 않고 앞으로 이어서 읽도록 함
+		madvise(reinterpret_cast<void*>(begin), length, MADV_SEQUENTIAL);
+		madvise(reinterpret_cast<void*>(begin), length, MADV_WILLNEED);
+#endif
+	}
+
+	// DXGI_FORMAT_BC1_TYPELESS(70)부터 BC7_UNORM_SRGB(99)까지의 블록 크기, 블록 압축이 아니면 0
+	static uint32_t getBlockBytes(const uint32_t dxgiFormat)
+	{
+		if ((dxgiFormat >= 70 && dxgiFormat <= 72) || (dxgiFormat >= 79 && dxgiFormat <= 81))
+		{
+			return 8;
+		}
+
+		if ((dxgiFormat >= 73 && dxgiFormat <= 84) || (dxgiFormat >= 94 && dxgiFormat <= 99))
+		{
+			return 16;
+		}
+
+		return 0;
+	}
+
+	bool GetRetainedRanges(
+		const uint8_t* pPrefix,
+		const size_t prefixSize,
+		const size_t fileSize,
+		const uint32_t maxSize,
+		std::vector<ByteRange>& outRanges
+	)
+	{
+		outRanges.clear();
+
+		size_t offset = 0;
+		if (prefixSize > fileSize || !ParsePrefix(pPrefix, prefixSize, offset) || offset != DX10_PREFIX_SIZE)
+		{
+			return false;
+		}
+
+		Header header;
+		memcpy(&header, pPrefix + sizeof(MAGIC), sizeof(header));
+
+		HeaderDx10 headerDx10;
+		memcpy(&headerDx10, pPrefix + sizeof(MAGIC) + sizeof(Header), sizeof(headerDx10));
+
+		const uint32_t blockBytes = getBlockBytes(headerDx10.dxgiFormat);
+		if (blockBytes == 0 || headerDx10.resourceDimension != RESOURCE_DIMENSION_TEXTURE2D || headerDx10.arraySize == 0)
+		{
+			return false;
+		}
+
+		const uint32_t mipCount = header.mipMapCount != 0 ? header.mipMapCount : 1;
+		const uint64_t arraySize = static_cast<uint64_t>(headerDx10.arraySize)
+			* ((headerDx10.miscFlag & MISC_TEXTURECUBE) != 0 ? CUBE_FACE_COUNT : 1);
+
+		// 슬라이스마다 mip 0부터 차례로 저장
+		for (uint64_t slice = 0; slice < arraySize; ++slice)
+		{
+			uint32_t width = header.width;
+			uint32_t height = header.height;
+
+			for (uint32_t mip = 0; mip < mipCount; ++mip)
+			{
+				const size_t size = GetBlockCompressedSize(width, height, blockBytes);
+				if (size > fileSize - offset)
+				{
+					return false;
+				}
+
+				if (mipCount <= 1 || maxSize == 0 || (width <= maxSize && height <= maxSize))
+				{
+					if (!outRanges.empty() && outRanges.back().offset + outRanges.back().size == offset)
+					{
+						outRanges.back().size += size;
+					}
+					else
+					{
+						const ByteRange range = { offset, size };
+						outRanges.push_back(range);
+					}
+				}
+
+				offset += size;
+				width = std::max(width >> 1, 1u);
+				height = std::max(height >> 1, 1u);
+			}
+		}
+
+		return !outRanges.empty();
+	}
+
+	size_t GetBlockCompressedSize(const uint32_t width, const uint32_t height, const uint32_t blockBytes)
+	{
+		const size_t blockCountX = (static_cast<size_t>(width) + 3) / 4;
+		const size_t blockCountY = (static_cast<size_t>(height) + 3) / 4;
+
+		return (blockCountX > 0 ? blockCountX : 1) * (blockCountY > 0 ? blockCountY : 1) * blockBytes;
+	}
+
+	void WriteTexture2DPrefix(
+		uint8_t* pOut,
+		const uint32_t width,
+		const uint32_t height,
+		const uint32_t mipCount,
+		const uint32_t dxgiFormat,
+		const uint32_t blockBytes
+	)
+	{
+		Header header;
+		memset(&header, 0, sizeof(header));
+
+		header.size = sizeof(Header);
+		header.flags = HEADER_FLAGS_CAPS | HEADER_FLAGS_HEIGHT | HEADER_FLAGS_WIDTH | HEADER_FLAGS_PIXELFORMAT | HEADER_FLAGS_LINEARSIZE;
+		header.height = height;
+		header.width = width;
+		header.pitchOrLinearSize = static_cast<uint32_t>(GetBlockCompressedSize(width, height, blockBytes));
+		header.mipMapCount = mipCount;
+		header.pixelFormat.size = sizeof(PixelFormat);
+		header.pixelFormat.flags = PIXELFORMAT_FOURCC;
+		header.pixelFormat.fourCC = FOURCC_DX10;
+		header.caps = CAPS_TEXTURE;
+
+		if (mipCount > 1)
+		{
+			header.flags |= HEADER_FLAGS_MIPMAPCOUNT;
+			header.caps |= CAPS_COMPLEX | CAPS_MIPMAP;
+		}
+
+		HeaderDx10 headerDx10;
+		memset(&headerDx10, 0, sizeof(headerDx10));
+
+		headerDx10.dxgiFormat = dxgiFormat;
+		headerDx10.resourceDimension = RESOURCE_DIMENSION_TEXTURE2D;
+		headerDx10.arraySize = 1;
+
+		memcpy(pOut, &MAGIC, sizeof(MAGIC));
+		memcpy(pOut + sizeof(MAGIC), &header, sizeof(header));
+		memcpy(pOut + sizeof(MAGIC) + sizeof(header), &headerDx10, sizeof(headerDx10));
+	}
+}
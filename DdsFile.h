@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// DDS 파일 구조 (DDSTextureLoader11.cpp와 같은 배치)
+// Windows 헤더 없이 쓸 수 있도록 DXGI 포맷은 숫자로만 다룸
+namespace DdsFile
+{
+	constexpr uint32_t MakeFourCC(const char ch0, const char ch1, const char ch2, const char ch3)
+	{
+		return static_cast<uint32_t>(static_cast<uint8_t>(ch0))
+			| (static_cast<uint32_t>(static_cast<uint8_t>(ch1)) << 8)
+			| (static_cast<uint32_t>(static_cast<uint8_t>(ch2)) << 16)
+			| (static_cast<uint32_t>(static_cast<uint8_t>(ch3)) << 24);
+	}
+
+	constexpr uint32_t MAGIC = MakeFourCC('D', 'D', 'S', ' ');
+	constexpr uint32_t FOURCC_DX10 = MakeFourCC('D', 'X', '1', '0');
+
+	enum
+	{
+		// DDS_HEADER::flags
+		HEADER_FLAGS_CAPS = 0x1,
+		HEADER_FLAGS_HEIGHT = 0x2,
+		HEADER_FLAGS_WIDTH = 0x4,
+		HEADER_FLAGS_PIXELFORMAT = 0x1000,
+		HEADER_FLAGS_MIPMAPCOUNT = 0x20000,
+		HEADER_FLAGS_LINEARSIZE = 0x80000,
+
+		// DDS_PIXELFORMAT::flags
+		PIXELFORMAT_FOURCC = 0x4,
+
+		// DDS_HEADER::caps
+		CAPS_COMPLEX = 0x8,
+		CAPS_TEXTURE = 0x1000,
+		CAPS_MIPMAP = 0x400000,
+
+		// DDS_HEADER_DXT10::resourceDimension (D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+		RESOURCE_DIMENSION_TEXTURE2D = 3,
+
+		// DDS_HEADER_DXT10::miscFlag (D3D11_RESOURCE_MISC_TEXTURECUBE)
+		MISC_TEXTURECUBE = 0x4,
+		CUBE_FACE_COUNT = 6,
+
+		// DXGI_FORMAT
+		FORMAT_BC1_UNORM = 71,
+		FORMAT_BC7_UNORM = 98
+	};
+
+#pragma pack(push, 1)
+	struct PixelFormat
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t rBitMask;
+		uint32_t gBitMask;
+		uint32_t bBitMask;
+		uint32_t aBitMask;
+	};
+
+	struct Header
+	{
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		PixelFormat pixelFormat;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	};
+
+	struct HeaderDx10
+	{
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+#pragma pack(pop)
+
+	static_assert(sizeof(PixelFormat) == 32, "DDS_PIXELFORMAT is 32 bytes");
+	static_assert(sizeof(Header) == 124, "DDS_HEADER is 124 bytes");
+	static_assert(sizeof(HeaderDx10) == 20, "DDS_HEADER_DXT10 is 20 bytes");
+
+	// 매직 + 헤더 + DX10 헤더
+	constexpr size_t DX10_PREFIX_SIZE = sizeof(uint32_t) + sizeof(Header) + sizeof(HeaderDx10);
+
+#if defined(_WIN32)
+	typedef wchar_t PathChar;
+#else
+	typedef char PathChar;
+#endif
+
+	// 매직, 헤더 크기, DX10 헤더 길이를 확인하고 텍셀 데이터가 시작하는 위치를 구함 (DDSTextureLoader11과 같은 검사)
+	// 헤더는 pData + sizeof(MAGIC)에 있음
+	bool ParsePrefix(const uint8_t* pData, const size_t size, size_t& outBitDataOffset);
+
+	// 읽기 전용으로 매핑한 파일, 힙에 복사하지 않고 서브리소스가 매핑을 바로 가리키게 할 때 사용
+	// 매핑한 동안 다른 프로세스가 파일을 줄이면 접근할 때 예외(SIGBUS)가 나므로 배포된 에셋에만 사용
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// 실패하면 false, 원인은 GetLastError/errno에 남음
+		// 페이지는 처음 접근할 때 읽으므로 쓸 범위만 Prefetch
+		bool Open(const PathChar* pPath);
+		void Close();
+
+		// 매핑 안의 범위를 미리 읽도록 요청 (매핑 밖은 잘라냄)
+		void Prefetch(const uint8_t* pBegin, const size_t size) const;
+
+		const uint8_t* GetData() const { return mpData; }
+		size_t GetSize() const { return mSize; }
+
+	private:
+		const uint8_t* mpData;
+		size_t mSize;
+	};
+
+	// 파일 안의 바이트 범위
+	struct ByteRange
+	{
+		size_t offset;
+		size_t size;
+	};
+
+	// 헤더만으로 maxSize보다 큰 mip을 건너뛰고 남는 서브리소스의 범위를 구함 (FillInitData와 같은 규칙, 0이면 모두)
+	// 이어지는 범위는 하나로 합침, DX10 헤더의 블록 압축(BC1~BC7) 2D 텍스처, 배열, 큐브맵만 지원
+	bool GetRetainedRanges(
+		const uint8_t* pPrefix,
+		const size_t prefixSize,
+		const size_t fileSize,
+		const uint32_t maxSize,
+		std::vector<ByteRange>& outRanges
+	);
+
+	// 4x4 블록 압축 포맷에서 한 mip의 바이트 수
+	size_t GetBlockCompressedSize(const uint32_t width, const uint32_t height, const uint32_t blockBytes);
+
+	// 블록 압축 2D 텍스처 하나의 매직과 헤더를 pOut에 기록 (DX10_PREFIX_SIZE 바이트)
+	void WriteTexture2DPrefix(
+		uint8_t* pOut,
+		const uint32_t width,
+		const uint32_t height,
+		const uint32_t mipCount,
+		const uint32_t dxgiFormat,
+		const uint32_t blockBytes
+	);
+}
@@ -0,0 +1,300 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "DdsFile.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(const Clock::time_point startTime)
+{
+	return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+// /proc/self/status(kB)나 /proc/self/io(바이트)의 항목, 없으면 0
+static uint64_t readProcValue(const char* pProcPath, const char* pName)
+{
+	std::ifstream status(pProcPath);
+	const size_t nameLength = strlen(pName);
+
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, nameLength, pName) == 0 && line.size() > nameLength && line[nameLength] == ':')
+		{
+			return strtoull(line.c_str() + nameLength + 1, nullptr, 10);
+		}
+	}
+
+	return 0;
+}
+
+// 페이지 캐시에서 파일을 내려서 디스크에서 읽는 경우를 흉내 냄 (매핑이 없을 때만 내려감)
+static void evictFromPageCache(const char* pPath)
+{
+	const int file = open(pPath, O_RDONLY);
+	if (file >= 0)
+	{
+		posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+		close(file);
+	}
+}
+
+// 드라이버가 서브리소스 데이터를 읽어 가는 것처럼 범위를 모두 읽음
+static uint64_t touchRanges(const uint8_t* pBase, const std::vector<DdsFile::ByteRange>& ranges)
+{
+	uint64_t checksum = 0;
+
+	for (const DdsFile::ByteRange& range : ranges)
+	{
+		const uint8_t* pData = pBase + range.offset;
+		for (size_t i = 0; i + sizeof(uint64_t) <= range.size; i += sizeof(uint64_t))
+		{
+			uint64_t value;
+			memcpy(&value, pData + i, sizeof(value));
+			checksum += value;
+		}
+	}
+
+	return checksum;
+}
+
+static size_t sumRangeSizes(const std::vector<DdsFile::ByteRange>& ranges)
+{
+	size_t size = 0;
+	for (const DdsFile::ByteRange& range : ranges)
+	{
+		size += range.size;
+	}
+
+	return size;
+}
+
+struct LoadResult
+{
+	bool bSucceeded;
+	double seconds;
+	uint64_t checksum;
+
+	// 서브리소스로 넘긴 바이트, 저장 장치에서 실제로 읽은 바이트
+	size_t retainedBytes;
+	int64_t storageReadBytes;
+
+	// 서브리소스를 넘기는 시점의 익명(힙) 메모리와 파일 매핑 메모리 (kB)
+	int64_t anonymousKilobytes;
+	int64_t fileKilobytes;
+};
+
+// load 함수가 버퍼나 매핑을 해제하기 전에 호출
+static void recordResidentMemory(LoadResult& outResult)
+{
+	outResult.anonymousKilobytes = readProcValue("/proc/self/status", "RssAnon");
+	outResult.fileKilobytes = readProcValue("/proc/self/status", "RssFile");
+}
+
+typedef bool (*LoadFunction)(const char* pPath, const uint32_t maxSize, LoadResult& outResult);
+
+// 변경 전 DDSTextureLoader11처럼 파일 전체를 힙에 복사하고 남는 mip만 사용
+static bool loadByReading(const char* pPath, const uint32_t maxSize, LoadResult& outResult)
+{
+	std::ifstream file(pPath, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(file.tellg());
+	file.seekg(0);
+
+	std::unique_ptr<uint8_t[]> data(new (std::nothrow) uint8_t[size]);
+	if (!data || !file.read(reinterpret_cast<char*>(data.get()), size))
+	{
+		return false;
+	}
+
+	std::vector<DdsFile::ByteRange> ranges;
+	if (!DdsFile::GetRetainedRanges(data.get(), size, size, maxSize, ranges))
+	{
+		return false;
+	}
+
+	outResult.checksum = touchRanges(data.get(), ranges);
+	outResult.retainedBytes = sumRangeSizes(ranges);
+	recordResidentMemory(outResult);
+
+	return true;
+}
+
+// DDSTextureLoader11처럼 매핑하고 남는 mip만 미리 읽음, 건너뛴 mip의 페이지는 건드리지 않음
+static bool loadByMapping(const char* pPath, const uint32_t maxSize, LoadResult& outResult)
+{
+	DdsFile::MappedFile file;
+	if (!file.Open(pPath))
+	{
+		return false;
+	}
+
+	std::vector<DdsFile::ByteRange> ranges;
+	if (!DdsFile::GetRetainedRanges(file.GetData(), file.GetSize(), file.GetSize(), maxSize, ranges))
+	{
+		return false;
+	}
+
+	for (const DdsFile::ByteRange& range : ranges)
+	{
+		file.Prefetch(file.GetData() + range.offset, range.size);
+	}
+
+	outResult.checksum = touchRanges(file.GetData(), ranges);
+	outResult.retainedBytes = sumRangeSizes(ranges);
+	recordResidentMemory(outResult);
+
+	return true;
+}
+
+// 헤더만 읽고 남는 mip의 범위만 힙 버퍼에 읽음
+static bool loadByPartialReading(const char* pPath, const uint32_t maxSize, LoadResult& outResult)
+{
+	const int file = open(pPath, O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	const off_t fileSize = lseek(file, 0, SEEK_END);
+
+	uint8_t prefix[DdsFile::DX10_PREFIX_SIZE];
+	std::vector<DdsFile::ByteRange> ranges;
+
+	bool bSucceeded = fileSize > 0
+		&& pread(file, prefix, sizeof(prefix), 0) == static_cast<ssize_t>(sizeof(prefix))
+		&& DdsFile::GetRetainedRanges(prefix, sizeof(prefix), static_cast<size_t>(fileSize), maxSize, ranges);
+
+	// 버퍼 안에서 범위를 이어 붙이고, 읽은 위치를 기준으로 다시 계산
+	const size_t retainedBytes = bSucceeded ? sumRangeSizes(ranges) : 0;
+	std::unique_ptr<uint8_t[]> data(new (std::nothrow) uint8_t[retainedBytes > 0 ? retainedBytes : 1]);
+	std::vector<DdsFile::ByteRange> bufferRanges;
+	size_t bufferOffset = 0;
+
+	for (size_t i = 0; bSucceeded && i < ranges.size(); ++i)
+	{
+		for (size_t done = 0; bSucceeded && done < ranges[i].size; )
+		{
+			const ssize_t readSize = pread(file, data.get() + bufferOffset + done, ranges[i].size - done, static_cast<off_t>(ranges[i].offset + done));
+			bSucceeded = readSize > 0;
+			done += bSucceeded ? static_cast<size_t>(readSize) : 0;
+		}
+
+		const DdsFile::ByteRange bufferRange = { bufferOffset, ranges[i].size };
+		bufferRanges.push_back(bufferRange);
+		bufferOffset += ranges[i].size;
+	}
+
+	close(file);
+
+	if (!bSucceeded || !data)
+	{
+		return false;
+	}
+
+	outResult.checksum = touchRanges(data.get(), bufferRanges);
+	outResult.retainedBytes = retainedBytes;
+	recordResidentMemory(outResult);
+
+	return true;
+}
+
+static bool printLoad(const char* pName, const LoadFunction load, const char* pPath, const uint32_t maxSize, const bool bCold)
+{
+	if (bCold)
+	{
+		evictFromPageCache(pPath);
+	}
+
+	LoadResult result = {};
+
+	const int64_t anonymousBase = readProcValue("/proc/self/status", "RssAnon");
+	const int64_t fileBase = readProcValue("/proc/self/status", "RssFile");
+	const int64_t storageBase = readProcValue("/proc/self/io", "read_bytes");
+	const Clock::time_point startTime = Clock::now();
+
+	result.bSucceeded = load(pPath, maxSize, result);
+	result.seconds = getSeconds(startTime);
+
+	if (!result.bSucceeded)
+	{
+		std::cerr << pName << ": failed to load " << pPath << " (needs a DX10 block-compressed 2D DDS)" << std::endl;
+		return false;
+	}
+
+	result.storageReadBytes = readProcValue("/proc/self/io", "read_bytes") - storageBase;
+
+	std::cout << pName << (bCold ? " (cold)" : " (warm)") << ": " << result.seconds * 1e3 << " ms"
+		<< " | retained " << result.retainedBytes / (1024.0 * 1024.0) << " MB"
+		<< " | storage read " << result.storageReadBytes / (1024.0 * 1024.0) << " MB"
+		<< " | private +" << (result.anonymousKilobytes - anonymousBase) / 1024.0 << " MB"
+		<< " | file-backed +" << (result.fileKilobytes - fileBase) / 1024.0 << " MB"
+		<< " | checksum " << std::hex << result.checksum << std::dec << std::endl;
+
+	return true;
+}
+
+// DDS를 힙에 전부 읽는 경우, 매핑하는 경우, 남는 mip만 읽는 경우의 시간과 읽은 양 비교
+// 사용법: SimpleNetworkDdsLoadBench [--warm] [--max-size N] FILE.dds
+// --max-size는 CreateDDSTextureFromFile의 maxsize (0이면 모든 mip), --warm이 없으면 매번 페이지 캐시에서 파일을 내리고 측정
+int main(int argc, char* argv[])
+{
+	bool bCold = true;
+	uint32_t maxSize = 0;
+	std::vector<const char*> positionalArgs;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--warm") == 0)
+		{
+			bCold = false;
+		}
+		else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc)
+		{
+			maxSize = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			positionalArgs.push_back(argv[i]);
+		}
+	}
+
+	if (positionalArgs.size() != 1)
+	{
+		std::cerr << "usage: SimpleNetworkDdsLoadBench [--warm] [--max-size N] FILE.dds" << std::endl;
+		return 1;
+	}
+
+	const char* pPath = positionalArgs[0];
+
+	// warm이면 처음 한 번 읽어서 페이지 캐시에 올려 둠
+	if (!bCold)
+	{
+		LoadResult result = {};
+		loadByReading(pPath, 0, result);
+	}
+
+	if (!printLoad("map", loadByMapping, pPath, maxSize, bCold)
+		|| !printLoad("partial read", loadByPartialReading, pPath, maxSize, bCold)
+		|| !printLoad("full read", loadByReading, pPath, maxSize, bCold))
+	{
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,279 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Protocol.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(const Clock::time_point startTime)
+{
+	return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+// 보내는 쪽이 반복해서 쓰는 메시지 묶음, payload 크기가 제각각이라 recv 경계에 걸친 메시지가 생김
+// payloadSize가 0이면 게임이 실제로 보내는 크기들을 섞음
+static std::vector<uint8_t> buildMessages(const size_t payloadSize, size_t& outMessageCount)
+{
+	static const size_t MIXED_PAYLOAD_SIZES[] =
+	{
+		sizeof(Protocol::EntityPositionPayload),
+		sizeof(Protocol::PlayerStatePayload),
+		offsetof(Protocol::InputPayload, runs) + 3,
+		sizeof(Protocol::PingPayload),
+		sizeof(Protocol::PongPayload),
+		200
+	};
+
+	std::vector<uint8_t> messages;
+	uint8_t payload[Protocol::MAX_MESSAGE_SIZE] = {};
+	uint8_t message[Protocol::MAX_MESSAGE_SIZE];
+
+	outMessageCount = 0;
+	for (uint32_t sequence = 0; messages.size() < 64 * 1024; ++sequence)
+	{
+		const size_t size = payloadSize > 0 ? payloadSize : MIXED_PAYLOAD_SIZES[sequence % (sizeof(MIXED_PAYLOAD_SIZES) / sizeof(MIXED_PAYLOAD_SIZES[0]))];
+		const size_t messageSize = Protocol::WriteMessage(message, sizeof(message), Protocol::MSG_ENTITY_POSITION, sequence, sequence, payload, size);
+
+		messages.insert(messages.end(), message, message + messageSize);
+		++outMessageCount;
+	}
+
+	return messages;
+}
+
+struct ParseResult
+{
+	uint64_t messageCount;
+	uint64_t byteCount;
+	uint64_t checksum;
+	bool bError;
+};
+
+// 버퍼에 쌓인 완성된 메시지를 모두 파싱, payload는 복사하지 않고 첫 바이트만 읽음
+static void parseAll(Protocol::StreamBuffer& buffer, ParseResult& result)
+{
+	Protocol::MessageView message;
+	Protocol::EParseResult parseResult;
+	while ((parseResult = buffer.Parse(message)) == Protocol::PARSE_OK)
+	{
+		++result.messageCount;
+		result.checksum += message.header.sequence + (message.payloadSize > 0 ? message.pPayload[0] : 0);
+	}
+
+	result.bError |= parseResult == Protocol::PARSE_ERROR;
+}
+
+static void printResult(const char* pName, const ParseResult& result, const double elapsed)
+{
+	std::cout << pName << ": " << result.messageCount / elapsed / 1e6 << " M msgs/s"
+		<< " | " << result.byteCount / elapsed / (1024.0 * 1024.0) << " MiB/s"
+		<< " | " << result.messageCount << " msgs in " << elapsed << " s"
+		<< " (checksum " << result.checksum << ")" << std::endl;
+}
+
+// 소켓 없이 메모리에서 StreamBuffer로 넣고 파싱하는 비용만
+static bool benchParseOnly(const std::vector<uint8_t>& messages, const double duration)
+{
+	Protocol::StreamBuffer buffer;
+	ParseResult result = {};
+
+	// recv 한 번에 들어오는 크기를 흉내 냄
+	const size_t chunkSize = 16 * 1024 + 7;
+	size_t offset = 0;
+
+	const Clock::time_point startTime = Clock::now();
+	while (!result.bError && getSeconds(startTime) < duration)
+	{
+		for (int i = 0; i < 256; ++i)
+		{
+			buffer.Compact();
+
+			const size_t size = std::min(std::min(chunkSize, buffer.GetWritableSize()), messages.size() - offset);
+			memcpy(buffer.GetWritePtr(), messages.data() + offset, size);
+			buffer.CommitWrite(size);
+
+			offset = (offset + size) % messages.size();
+			result.byteCount += size;
+
+			parseAll(buffer, result);
+		}
+	}
+
+	printResult("parse only", result, getSeconds(startTime));
+
+	return !result.bError;
+}
+
+static bool sendAll(const int fd, const uint8_t* pData, size_t size)
+{
+	while (size > 0)
+	{
+		const ssize_t sentSize = send(fd, pData, size, MSG_NOSIGNAL);
+		if (sentSize == -1)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			return false;
+		}
+
+		pData += sentSize;
+		size -= sentSize;
+	}
+
+	return true;
+}
+
+// 127.0.0.1 TCP로 보내고 App의 수신 스레드처럼 recv를 StreamBuffer에 바로 받아 파싱
+static bool benchLoopback(const std::vector<uint8_t>& messages, const double duration)
+{
+	const int listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+
+	socklen_t addressSize = sizeof(address);
+	if (listenFd == -1
+		|| bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+		|| listen(listenFd, 1) == -1
+		|| getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &addressSize) == -1)
+	{
+		std::cerr << "loopback listen failed: " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	const int sendFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+	if (sendFd == -1 || connect(sendFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1)
+	{
+		std::cerr << "loopback connect failed: " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	const int recvFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+	close(listenFd);
+
+	// 게임과 같은 설정
+	const int noDelay = 1;
+	setsockopt(sendFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+	std::atomic<bool> bSending(true);
+	std::thread sender([&]()
+	{
+		while (bSending.load() && sendAll(sendFd, messages.data(), messages.size()))
+		{
+		}
+
+		shutdown(sendFd, SHUT_WR);
+	});
+
+	Protocol::StreamBuffer buffer;
+	ParseResult result = {};
+	uint64_t recvCount = 0;
+
+	const Clock::time_point startTime = Clock::now();
+	while (!result.bError)
+	{
+		buffer.Compact();
+
+		const ssize_t receivedSize = recv(recvFd, buffer.GetWritePtr(), buffer.GetWritableSize(), 0);
+		if (receivedSize <= 0)
+		{
+			if (receivedSize == -1 && errno == EINTR)
+			{
+				continue;
+			}
+
+			break;
+		}
+
+		buffer.CommitWrite(receivedSize);
+		result.byteCount += receivedSize;
+		++recvCount;
+
+		parseAll(buffer, result);
+
+		// 보내는 쪽을 멈춘 뒤 남은 데이터는 다 받고 끝냄
+		if (bSending.load() && (recvCount & 63) == 0 && getSeconds(startTime) >= duration)
+		{
+			bSending.store(false);
+		}
+	}
+
+	const double elapsed = getSeconds(startTime);
+
+	bSending.store(false);
+	shutdown(recvFd, SHUT_RDWR);
+	sender.join();
+
+	close(sendFd);
+	close(recvFd);
+
+	printResult("loopback tcp", result, elapsed);
+	std::cout << "  " << result.byteCount / static_cast<double>(recvCount) << " bytes per recv"
+		<< ", " << static_cast<double>(result.messageCount) / recvCount << " msgs per recv" << std::endl;
+
+	return !result.bError && buffer.GetPendingSize() == 0;
+}
+
+// 길이가 앞에 붙은 메시지를 TCP 루프백으로 흘려보내고 받는 쪽에서 복사 없이 파싱하는 처리량
+// 사용법: SimpleNetworkFramingBench [--seconds S] [--payload N]
+// --payload가 없으면 게임 메시지 크기들을 섞어서 보냄, 파싱 오류가 나면 1을 반환
+int main(int argc, char* argv[])
+{
+	double duration = 2.0;
+	size_t payloadSize = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--seconds") == 0 && bHasValue)
+		{
+			duration = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--payload") == 0 && bHasValue)
+		{
+			payloadSize = strtoul(argv[++i], nullptr, 10);
+		}
+		else
+		{
+			std::cerr << "usage: SimpleNetworkFramingBench [--seconds S] [--payload N]" << std::endl;
+			return 1;
+		}
+	}
+
+	if (payloadSize > Protocol::MAX_MESSAGE_SIZE - sizeof(Protocol::MessageHeader))
+	{
+		std::cerr << "payload must be at most " << Protocol::MAX_MESSAGE_SIZE - sizeof(Protocol::MessageHeader) << " bytes" << std::endl;
+		return 1;
+	}
+
+	size_t messageCount;
+	const std::vector<uint8_t> messages = buildMessages(payloadSize, messageCount);
+
+	std::cout << messageCount << " messages, " << static_cast<double>(messages.size()) / messageCount << " bytes on average" << std::endl;
+
+	const bool bSucceeded = benchParseOnly(messages, duration) && benchLoopback(messages, duration);
+
+	return bSucceeded ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include "Impairment.h"
+
+#include <algorithm>
+
+namespace Impairment
+{
+	// 힙 비교, 도착이 늦은 쪽이 뒤로
+	static bool isLater(const double time1, const uint64_t order1, const double time2, const uint64_t order2)
+	{
+		return time1 != time2 ? time1 > time2 : order1 > order2;
+	}
+
+	Link::Link(const Config& config)
+		: mConfig(config)
+		, mRandom(config.seed)
+		, mNextOrder(0)
+		, mLinkFreeTime(0.0)
+		, mLastInOrderArrivalTime(0.0)
+		, mPushedCount(0)
+		, mLostCount(0)
+		, mDuplicatedCount(0)
+		, mReorderedCount(0)
+		, mQueueDropCount(0)
+	{
+	}
+
+	void Link::Push(const uint8_t* pData, const size_t size, const double now)
+	{
+		++mPushedCount;
+
+		// 설정과 관계없이 패킷마다 같은 개수를 뽑아야 시드가 같을 때 결과가 같음
+		const double lossRoll = nextRandom();
+		const double duplicateRoll = nextRandom();
+		const double reorderRoll = nextRandom();
+		const double jitterRoll = nextRandom();
+		const double duplicateJitterRoll = nextRandom();
+
+		if (lossRoll < mConfig.lossRate)
+		{
+			++mLostCount;
+			return;
+		}
+
+		// 대역폭 제한: 앞 패킷을 다 내보낸 뒤에 이 패킷을 싣기 시작함
+		double departureTime = now;
+		if (mConfig.bandwidth > 0.0)
+		{
+			const double startTime = std::max(now, mLinkFreeTime);
+			if ((startTime - now) * mConfig.bandwidth > mConfig.queueLimit)
+			{
+				++mQueueDropCount;
+				return;
+			}
+
+			mLinkFreeTime = startTime + size / mConfig.bandwidth;
+			departureTime = mLinkFreeTime;
+		}
+
+		double arrivalTime = departureTime + mConfig.delay + jitterRoll * mConfig.jitter;
+		if (reorderRoll < mConfig.reorderRate)
+		{
+			arrivalTime += mConfig.reorderDelay;
+			++mReorderedCount;
+		}
+		else
+		{
+			arrivalTime = std::max(arrivalTime, mLastInOrderArrivalTime);
+			mLastInOrderArrivalTime = arrivalTime;
+		}
+
+		schedule(pData, size, arrivalTime);
+
+		if (duplicateRoll < mConfig.duplicateRate)
+		{
+			schedule(pData, size, arrivalTime + duplicateJitterRoll * mConfig.jitter);
+			++mDuplicatedCount;
+		}
+	}
+
+	double Link::nextRandom()
+	{
+		// mt19937의 출력 순서는 표준에 정해져 있지만 분포 클래스는 구현마다 달라서 직접 변환
+		return mRandom() / 4294967296.0;
+	}
+
+	void Link::schedule(const uint8_t* pData, const size_t size, const double arrivalTime)
+	{
+		Packet packet;
+		packet.arrivalTime = arrivalTime;
+		packet.order = mNextOrder++;
+		packet.data.assign(pData, pData + size);
+
+		mPackets.push_back(std::move(packet));
+		std::push_heap(mPackets.begin(), mPackets.end(), [](const Packet& lhs, const Packet& rhs)
+		{
+			return isLater(lhs.arrivalTime, lhs.order, rhs.arrivalTime, rhs.order);
+		});
+	}
+
+	void Link::popFront()
+	{
+		std::pop_heap(mPackets.begin(), mPackets.end(), [](const Packet& lhs, const Packet& rhs)
+		{
+			return isLater(lhs.arrivalTime, lhs.order, rhs.arrivalTime, rhs.order);
+		});
+	}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace Impairment
+{
+	struct Config
+	{
+		// 편도 고정 지연과 여기에 더하는 [0, jitter) 균등 분포 흔들림(초)
+		double delay;
+		double jitter;
+
+		// 패킷마다 적용할 확률 [0, 1]
+		double lossRate;
+		double duplicateRate;
+		double reorderRate;
+
+		// 순서가 바뀌는 패킷을 추가로 붙잡아 두는 시간(초), 뒤 패킷들이 앞지름
+		double reorderDelay;
+
+		// 초당 바이트, 0이면 제한 없음
+		double bandwidth;
+
+		// 대역폭 제한으로 밀린 양이 이보다 많으면 새 패킷을 버림 (tail drop)
+		size_t queueLimit;
+
+		// 같은 시드와 같은 패킷 순서면 손실/중복/순서/흔들림이 항상 같음
+		uint32_t seed;
+	};
+
+	// 한 방향 링크, 보낼 패킷을 넣으면 설정에 따라 버리거나 늦추거나 복제해서 내보냄
+	// 스레드 안전하지 않음, 한 스레드에서만 사용
+	class Link
+	{
+	public:
+		explicit Link(const Config& config);
+
+		void Push(const uint8_t* pData, const size_t size, const double now);
+
+		// now까지 도착한 패킷을 도착 순서대로 onPacket(pData, size)로 넘김, onPacket 안에서 Push 금지
+		template <class Callback>
+		void ForEachArrived(const double now, Callback onPacket)
+		{
+			while (!mPackets.empty() && mPackets.front().arrivalTime <= now)
+			{
+				popFront();
+				const Packet& packet = mPackets.back();
+				onPacket(packet.data.data(), packet.data.size());
+				mPackets.pop_back();
+			}
+		}
+
+		// 아직 나가지 않은 패킷 중 가장 이른 도착 시각, 없으면 음수
+		double GetNextArrivalTime() const
+		{
+			return mPackets.empty() ? -1.0 : mPackets.front().arrivalTime;
+		}
+
+		// 아직 나가지 않은 패킷 수
+		size_t GetQueuedCount() const
+		{
+			return mPackets.size();
+		}
+
+		uint64_t GetPushedCount() const
+		{
+			return mPushedCount;
+		}
+
+		uint64_t GetLostCount() const
+		{
+			return mLostCount;
+		}
+
+		uint64_t GetDuplicatedCount() const
+		{
+			return mDuplicatedCount;
+		}
+
+		uint64_t GetReorderedCount() const
+		{
+			return mReorderedCount;
+		}
+
+		// 대역폭 제한 큐가 넘쳐서 버린 수
+		uint64_t GetQueueDropCount() const
+		{
+			return mQueueDropCount;
+		}
+
+	private:
+		struct Packet
+		{
+			double arrivalTime;
+
+			// 도착 시각이 같으면 넣은 순서대로
+			uint64_t order;
+
+			std::vector<uint8_t> data;
+		};
+
+		// [0, 1)
+		double nextRandom();
+
+		void schedule(const uint8_t* pData, const size_t size, const double arrivalTime);
+
+		// 가장 이른 패킷을 mPackets 맨 뒤로 옮김
+		void popFront();
+
+	private:
+		Config mConfig;
+		std::mt19937 mRandom;
+
+		// arrivalTime 기준 최소 힙
+		std::vector<Packet> mPackets;
+		uint64_t mNextOrder;
+
+		// 대역폭 제한: 링크가 다음 패킷을 싣기 시작할 수 있는 시각
+		double mLinkFreeTime;
+
+		// 흔들림만으로는 순서가 바뀌지 않도록 직전 패킷보다 먼저 도착하지 않게 함
+		double mLastInOrderArrivalTime;
+
+		uint64_t mPushedCount;
+		uint64_t mLostCount;
+		uint64_t mDuplicatedCount;
+		uint64_t mReorderedCount;
+		uint64_t mQueueDropCount;
+	};
+}
@@ -0,0 +1,82 @@
+#!/bin/sh
+# 관심 영역 격자를 켜고 끈 서버에 부하 생성기 봇을 붙여서 봇 수마다 서버의 보내는 대역폭과 CPU를 비교
+# 서버와 부하 생성기가 1초마다 출력하는 통계 줄에서 접속 직후 2초를 빼고 평균을 냄
+# tick ms가 틱 간격(16.7ms)을 넘으면 CPU가 모자라서 서버가 틱을 제때 돌지 못한 것, 그 줄의 대역폭은 낮게 나옴
+# 사용법: InterestBench.sh [빌드 디렉터리] (기본 _gate_build)
+# 환경 변수: BOTS (기본 "100 300 1000"), SECONDS_PER_RUN (기본 8), PORT (기본 20500), SERVER_FLAGS (예: --no-delta)
+
+BUILD_DIR=${1:-_gate_build}
+BOTS=${BOTS:-"100 300 1000"}
+SECONDS_PER_RUN=${SECONDS_PER_RUN:-8}
+# 로컬 포트 범위(32768~60999) 밖, 안에 있으면 봇의 TIME_WAIT 소켓과 겹쳐서 bind가 실패할 수 있음
+PORT=${PORT:-20500}
+
+SERVER="$BUILD_DIR/SimpleNetworkServer"
+LOAD_GENERATOR="$BUILD_DIR/SimpleNetworkLoadGenerator"
+
+if [ ! -x "$SERVER" ] || [ ! -x "$LOAD_GENERATOR" ]; then
+	echo "build SimpleNetworkServer and SimpleNetworkLoadGenerator in $BUILD_DIR first" >&2
+	exit 1
+fi
+
+LOG=$(mktemp)
+LOAD_LOG=$(mktemp)
+trap 'rm -f "$LOG" "$LOAD_LOG"' EXIT
+
+printf '%8s %8s %14s %8s %10s\n' bots filter "out KiB/s" cpu "tick ms"
+
+for BOT_COUNT in $BOTS; do
+	for FILTER in on off; do
+		FILTER_FLAG=
+		if [ "$FILTER" = off ]; then
+			FILTER_FLAG=--no-interest
+		fi
+
+		# shellcheck disable=SC2086
+		"$SERVER" $FILTER_FLAG $SERVER_FLAGS "$PORT" > "$LOG" 2>&1 &
+		SERVER_PID=$!
+		sleep 0.5
+
+		# 봇 수가 많아도 backlog가 넘치지 않게 초당 1000개씩 접속 (기본값)
+		"$LOAD_GENERATOR" --bots "$BOT_COUNT" --duration "$SECONDS_PER_RUN" "$PORT" > "$LOAD_LOG"
+		LOAD_RESULT=$?
+
+		kill "$SERVER_PID"
+		wait "$SERVER_PID" 2> /dev/null
+
+		if [ "$LOAD_RESULT" -ne 0 ]; then
+			echo "load generator failed with $BOT_COUNT bots (filter $FILTER)" >&2
+			exit 1
+		fi
+
+		# 부하 생성기의 "bots N/N ... | server tick ms p50 X ..." 줄에서 틱 처리 시간 p50
+		TICK_MS=$(grep '^bots' "$LOAD_LOG" | tail -n +3 | awk '
+		{
+			for (i = 1; i < NF; ++i)
+			{
+				if ($i == "tick" && $(i + 2) == "p50") { tick += $(i + 3) }
+			}
+			++count
+		}
+		END {
+			if (count > 0) { printf "%.2f", tick / count }
+		}')
+
+		# 서버의 "connections N ... | out X KiB/s | ... | cpu Y% ..." 줄만
+		grep '^connections' "$LOG" | tail -n +3 | awk -v bots="$BOT_COUNT" -v filter="$FILTER" -v tick="$TICK_MS" '
+		{
+			for (i = 1; i < NF; ++i)
+			{
+				if ($i == "out") { out += $(i + 1) }
+				if ($i == "cpu") { cpu += $(i + 1) }
+			}
+			++count
+		}
+		END {
+			if (count > 0) { printf "%8d %8s %14.1f %7.2f%% %10s\n", bots, filter, out / count, cpu / count, tick }
+		}'
+
+		# 이전 서버의 포트가 TIME_WAIT에 걸리지 않게 다음 실행은 다른 포트로
+		PORT=$((PORT + 1))
+	done
+done
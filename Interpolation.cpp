@@ -0,0 +1,147 @@
+#include "Interpolation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Interpolation
+{
+	// 평균과 흔들림 추정에 새 샘플을 반영하는 비율
+	static constexpr double OFFSET_GAIN = 1.0 / 16.0;
+
+	// 지연 = 전송 간격 2개(하나를 잃어도 버티도록) + JITTER_SCALE * jitter
+	static constexpr double JITTER_SCALE = 4.0;
+
+	// 지연을 바꿀 때 재생 속도를 최대 10%까지만 바꿔서 튀지 않도록
+	static constexpr double MAX_DELAY_SLEW = 0.1;
+
+	constexpr double SnapshotBuffer::MAX_EXTRAPOLATION;
+	constexpr double SnapshotBuffer::MIN_DELAY;
+	constexpr double SnapshotBuffer::MAX_DELAY;
+
+	SnapshotBuffer::SnapshotBuffer(const double sendInterval)
+		: mHead(0)
+		, mCount(0)
+		, mSendInterval(sendInterval)
+		, mbHasOffset(false)
+		, mClockOffset(0.0)
+		, mJitter(0.0)
+		, mDelay(std::max(2.0 * sendInterval, MIN_DELAY))
+		, mLastSampleTime(0.0)
+		, mVelocity({ 0.f, 0.f })
+		, mbHasVelocity(false)
+		, mDepth(0)
+		, mbStarving(false)
+		, mStarvationCount(0)
+	{
+	}
+
+	void SnapshotBuffer::Push(const double remoteTime, const Simulation::Float2& pos, const double now)
+	{
+		if (mCount > 0 && remoteTime <= at(mCount - 1).time)
+		{
+			return;
+		}
+
+		const double offset = now - remoteTime;
+		if (!mbHasOffset)
+		{
+			mClockOffset = offset;
+			mbHasOffset = true;
+		}
+		else
+		{
+			const double deviation = offset - mClockOffset;
+			mClockOffset += deviation * OFFSET_GAIN;
+			mJitter += (std::abs(deviation) - mJitter) * OFFSET_GAIN;
+		}
+
+		if (mCount == CAPACITY)
+		{
+			popFront();
+		}
+
+		Snapshot& snapshot = mSnapshots[(mHead + mCount) % CAPACITY];
+		snapshot.time = remoteTime;
+		snapshot.pos = pos;
+		++mCount;
+	}
+
+	bool SnapshotBuffer::Sample(const double now, Simulation::Float2& outPos)
+	{
+		if (mCount == 0)
+		{
+			return false;
+		}
+
+		// 목표 지연으로 천천히 이동
+		const double targetDelay = std::min(std::max(2.0 * mSendInterval + JITTER_SCALE * mJitter, MIN_DELAY), MAX_DELAY);
+		const double maxStep = mLastSampleTime > 0.0 ? (now - mLastSampleTime) * MAX_DELAY_SLEW : 0.0;
+		mDelay += std::min(std::max(targetDelay - mDelay, -maxStep), maxStep);
+		mLastSampleTime = now;
+
+		const double renderTime = now - mClockOffset - mDelay;
+
+		// 보간에 쓸 앞쪽 스냅샷 하나만 남기고 지난 것 제거
+		while (mCount >= 2 && at(1).time <= renderTime)
+		{
+			popFront();
+		}
+
+		const Snapshot& oldest = at(0);
+		if (renderTime <= oldest.time)
+		{
+			mDepth = mCount;
+			mbStarving = false;
+			outPos = oldest.pos;
+
+			return true;
+		}
+
+		if (mCount >= 2)
+		{
+			const Snapshot& next = at(1);
+			const float t = static_cast<float>((renderTime - oldest.time) / (next.time - oldest.time));
+
+			mDepth = mCount - 1;
+			mbStarving = false;
+			outPos = Simulation::Lerp(oldest.pos, next.pos, t);
+
+			return true;
+		}
+
+		// 버퍼가 비었음, 직전 구간의 속도로 잠깐만 외삽
+		mDepth = 0;
+		outPos = oldest.pos;
+
+		if (mbHasVelocity)
+		{
+			const double dt = std::min(renderTime - oldest.time, MAX_EXTRAPOLATION);
+			outPos.x += mVelocity.x * static_cast<float>(dt);
+			outPos.y += mVelocity.y * static_cast<float>(dt);
+			outPos = Simulation::ClampToWorld(outPos);
+
+			if (!mbStarving)
+			{
+				mbStarving = true;
+				++mStarvationCount;
+			}
+		}
+
+		return true;
+	}
+
+	void SnapshotBuffer::popFront()
+	{
+		const Snapshot& front = at(0);
+		const Snapshot& next = at(1);
+
+		// 마지막 구간 속도, 버퍼가 비었을 때 외삽에 사용
+		const float dt = static_cast<float>(next.time - front.time);
+		mVelocity.x = (next.pos.x - front.pos.x) / dt;
+		mVelocity.y = (next.pos.y - front.pos.y) / dt;
+		mbHasVelocity = mVelocity.x != 0.f || mVelocity.y != 0.f;
+
+		mHead = (mHead + 1) % CAPACITY;
+		--mCount;
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Simulation.h"
+
+namespace Interpolation
+{
+	// 원격 엔티티 위치를 시간순으로 모아두고 일정 지연을 둔 과거 시점을 보간해서 그림
+	// 지연은 도착 시간 흔들림(jitter)에 맞춰 조절하고, 버퍼가 비면 짧게만 외삽
+	class SnapshotBuffer
+	{
+	public:
+		enum
+		{
+			CAPACITY = 64
+		};
+
+		// 외삽은 이 시간(초)까지만, 이후로는 마지막 위치에서 멈춤
+		static constexpr double MAX_EXTRAPOLATION = 0.05;
+
+		// 지연 범위(초)
+		static constexpr double MIN_DELAY = Simulation::TICK_INTERVAL;
+		static constexpr double MAX_DELAY = 0.25;
+
+		// sendInterval: 상대가 스냅샷을 보내는 가장 짧은 간격(초)
+		explicit SnapshotBuffer(const double sendInterval);
+
+		// remoteTime: 보낸 쪽 시계 기준 스냅샷 시각, now: 받은 시각
+		// 이미 받은 것보다 오래된 스냅샷은 버림
+		void Push(const double remoteTime, const Simulation::Float2& pos, const double now);
+
+		// now에 그릴 위치, 스냅샷을 하나도 못 받았으면 false
+		bool Sample(const double now, Simulation::Float2& outPos);
+
+		// 그리는 시점보다 뒤에 남아있는 스냅샷 수
+		size_t GetDepth() const
+		{
+			return mDepth;
+		}
+
+		double GetDelay() const
+		{
+			return mDelay;
+		}
+
+		double GetJitter() const
+		{
+			return mJitter;
+		}
+
+		// 움직이는 중에 버퍼가 비어서 외삽으로 넘어간 횟수
+		uint32_t GetStarvationCount() const
+		{
+			return mStarvationCount;
+		}
+
+	private:
+		struct Snapshot
+		{
+			double time;
+			Simulation::Float2 pos;
+		};
+
+		const Snapshot& at(const size_t index) const
+		{
+			return mSnapshots[(mHead + index) % CAPACITY];
+		}
+
+		void popFront();
+
+	private:
+		Snapshot mSnapshots[CAPACITY];
+		size_t mHead;
+		size_t mCount;
+
+		double mSendInterval;
+
+		// 로컬 시각 - 원격 시각의 평균과 그 흔들림 (RFC 3550 방식)
+		bool mbHasOffset;
+		double mClockOffset;
+		double mJitter;
+
+		double mDelay;
+		double mLastSampleTime;
+
+		// 마지막으로 지나간 구간의 속도
+		Simulation::Float2 mVelocity;
+		bool mbHasVelocity;
+
+		size_t mDepth;
+		bool mbStarving;
+		uint32_t mStarvationCount;
+	};
+}
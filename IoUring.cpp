@@ -0,0 +1,268 @@
+#include "IoUring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace IoUring
+{
+	static int setup(const unsigned entries, io_uring_params* pParams)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_setup, entries, pParams));
+	}
+
+	static int enter(const int ringFd, const unsigned submitCount, const unsigned waitCount, const unsigned flags, const void* pArg, const size_t argSize)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_enter, ringFd, submitCount, waitCount, flags, pArg, argSize));
+	}
+
+	static int registerRing(const int ringFd, const unsigned opcode, const void* pArg, const unsigned argCount)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, pArg, argCount));
+	}
+
+	Ring::Ring()
+		: mRingFd(-1)
+		, mpRing(MAP_FAILED)
+		, mRingSize(0)
+		, mpSqHead(nullptr)
+		, mpSqTail(nullptr)
+		, mpSqArray(nullptr)
+		, mSqMask(0)
+		, mSqEntries(0)
+		, mSqLocalTail(0)
+		, mpSqes(static_cast<io_uring_sqe*>(MAP_FAILED))
+		, mSqesSize(0)
+		, mpCqHead(nullptr)
+		, mpCqTail(nullptr)
+		, mCqMask(0)
+		, mpCqes(nullptr)
+		, mpBufferRing(static_cast<io_uring_buf_ring*>(MAP_FAILED))
+		, mBufferRingSize(0)
+		, mBufferRingMask(0)
+		, mpBufferMemory(static_cast<uint8_t*>(MAP_FAILED))
+		, mBufferMemorySize(0)
+		, mBufferSize(0)
+		, mBufferGroupId(0)
+		, mEnterCount(0)
+	{
+	}
+
+	Ring::~Ring()
+	{
+		Destroy();
+	}
+
+	bool Ring::Initialize(const unsigned entries)
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+
+		// 접속이 많으면 완료가 몰리므로 CQ를 넉넉하게
+		params.flags = IORING_SETUP_CQSIZE;
+		params.cq_entries = entries * 4;
+
+		mRingFd = setup(entries, &params);
+		if (mRingFd < 0)
+		{
+			return false;
+		}
+
+		// 단일 mmap과 대기 타임아웃 인자가 필요 (5.11+)
+		if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0 || (params.features & IORING_FEAT_EXT_ARG) == 0)
+		{
+			Destroy();
+			return false;
+		}
+
+		const size_t sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		const size_t cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		mRingSize = sqRingSize > cqRingSize ? sqRingSize : cqRingSize;
+
+		mpRing = mmap(nullptr, mRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQ_RING);
+		if (mpRing == MAP_FAILED)
+		{
+			Destroy();
+			return false;
+		}
+
+		mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		mpSqes = static_cast<io_uring_sqe*>(mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQES));
+		if (mpSqes == MAP_FAILED)
+		{
+			Destroy();
+			return false;
+		}
+
+		uint8_t* pRing = static_cast<uint8_t*>(mpRing);
+		mpSqHead = reinterpret_cast<unsigned*>(pRing + params.sq_off.head);
+		mpSqTail = reinterpret_cast<unsigned*>(pRing + params.sq_off.tail);
+		mpSqArray = reinterpret_cast<unsigned*>(pRing + params.sq_off.array);
+		mSqMask = *reinterpret_cast<unsigned*>(pRing + params.sq_off.ring_mask);
+		mSqEntries = params.sq_entries;
+		mSqLocalTail = *mpSqTail;
+
+		mpCqHead = reinterpret_cast<unsigned*>(pRing + params.cq_off.head);
+		mpCqTail = reinterpret_cast<unsigned*>(pRing + params.cq_off.tail);
+		mCqMask = *reinterpret_cast<unsigned*>(pRing + params.cq_off.ring_mask);
+		mpCqes = reinterpret_cast<io_uring_cqe*>(pRing + params.cq_off.cqes);
+
+		return true;
+	}
+
+	void Ring::Destroy()
+	{
+		if (mpBufferMemory != MAP_FAILED)
+		{
+			munmap(mpBufferMemory, mBufferMemorySize);
+			mpBufferMemory = static_cast<uint8_t*>(MAP_FAILED);
+		}
+
+		if (mpBufferRing != MAP_FAILED)
+		{
+			munmap(mpBufferRing, mBufferRingSize);
+			mpBufferRing = static_cast<io_uring_buf_ring*>(MAP_FAILED);
+		}
+
+		if (mpSqes != MAP_FAILED)
+		{
+			munmap(mpSqes, mSqesSize);
+			mpSqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+		}
+
+		if (mpRing != MAP_FAILED)
+		{
+			munmap(mpRing, mRingSize);
+			mpRing = MAP_FAILED;
+		}
+
+		if (mRingFd >= 0)
+		{
+			close(mRingFd);
+			mRingFd = -1;
+		}
+	}
+
+	io_uring_sqe* Ring::GetSqe()
+	{
+		const unsigned head = __atomic_load_n(mpSqHead, __ATOMIC_ACQUIRE);
+		if (mSqLocalTail - head >= mSqEntries)
+		{
+			return nullptr;
+		}
+
+		const unsigned index = mSqLocalTail & mSqMask;
+		io_uring_sqe* pSqe = &mpSqes[index];
+		memset(pSqe, 0, sizeof(*pSqe));
+
+		mpSqArray[index] = index;
+		++mSqLocalTail;
+
+		return pSqe;
+	}
+
+	int Ring::SubmitAndWait(const unsigned waitCount, const int64_t timeoutNs)
+	{
+		const unsigned submitCount = mSqLocalTail - *mpSqTail;
+		__atomic_store_n(mpSqTail, mSqLocalTail, __ATOMIC_RELEASE);
+
+		if (submitCount == 0 && waitCount == 0)
+		{
+			return 0;
+		}
+
+		__kernel_timespec timeout;
+		timeout.tv_sec = timeoutNs / 1000000000;
+		timeout.tv_nsec = timeoutNs % 1000000000;
+
+		io_uring_getevents_arg arg;
+		memset(&arg, 0, sizeof(arg));
+		if (timeoutNs >= 0)
+		{
+			arg.ts = reinterpret_cast<uint64_t>(&timeout);
+		}
+
+		unsigned flags = IORING_ENTER_EXT_ARG;
+		if (waitCount > 0)
+		{
+			flags |= IORING_ENTER_GETEVENTS;
+		}
+
+		++mEnterCount;
+
+		const int result = enter(mRingFd, submitCount, waitCount, flags, &arg, sizeof(arg));
+		if (result < 0 && (errno == ETIME || errno == EINTR))
+		{
+			return 0;
+		}
+
+		return result;
+	}
+
+	bool Ring::RegisterBufferRing(const uint16_t groupId, const unsigned bufferCount, const unsigned bufferSize)
+	{
+		// 버퍼 수는 2의 거듭제곱이어야 함
+		if (bufferCount == 0 || (bufferCount & (bufferCount - 1)) != 0 || bufferCount > 32768)
+		{
+			return false;
+		}
+
+		mBufferRingSize = bufferCount * sizeof(io_uring_buf);
+		void* pBufferRing = mmap(nullptr, mBufferRingSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+		if (pBufferRing == MAP_FAILED)
+		{
+			return false;
+		}
+		mpBufferRing = static_cast<io_uring_buf_ring*>(pBufferRing);
+
+		mBufferMemorySize = static_cast<size_t>(bufferCount) * bufferSize;
+		void* pBufferMemory = mmap(nullptr, mBufferMemorySize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_POPULATE, -1, 0);
+		if (pBufferMemory == MAP_FAILED)
+		{
+			return false;
+		}
+		mpBufferMemory = static_cast<uint8_t*>(pBufferMemory);
+
+		io_uring_buf_reg reg;
+		memset(&reg, 0, sizeof(reg));
+		reg.ring_addr = reinterpret_cast<uint64_t>(mpBufferRing);
+		reg.ring_entries = bufferCount;
+		reg.bgid = groupId;
+
+		if (registerRing(mRingFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+		{
+			return false;
+		}
+
+		mBufferRingMask = bufferCount - 1;
+		mBufferSize = bufferSize;
+		mBufferGroupId = groupId;
+
+		for (unsigned i = 0; i < bufferCount; ++i)
+		{
+			io_uring_buf& buffer = getBufferEntry(i);
+			buffer.addr = reinterpret_cast<uint64_t>(GetBuffer(static_cast<uint16_t>(i)));
+			buffer.len = bufferSize;
+			buffer.bid = static_cast<uint16_t>(i);
+		}
+		__atomic_store_n(&mpBufferRing->tail, static_cast<uint16_t>(bufferCount), __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+	void Ring::RecycleBuffer(const uint16_t bufferId)
+	{
+		const uint16_t tail = mpBufferRing->tail;
+
+		io_uring_buf& buffer = getBufferEntry(tail & mBufferRingMask);
+		buffer.addr = reinterpret_cast<uint64_t>(GetBuffer(bufferId));
+		buffer.len = mBufferSize;
+		buffer.bid = bufferId;
+
+		__atomic_store_n(&mpBufferRing->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+	}
+}
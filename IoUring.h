@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+// liburing 없이 시스템 콜로 직접 구성한 최소 io_uring 래퍼
+namespace IoUring
+{
+	class Ring
+	{
+	public:
+		Ring();
+		~Ring();
+
+		Ring(const Ring&) = delete;
+		Ring& operator=(const Ring&) = delete;
+
+		bool Initialize(const unsigned entries);
+		void Destroy();
+
+		// 큐가 가득 차면 제출 후 다시 시도
+		io_uring_sqe* GetSqe();
+
+		// 쌓인 SQE를 한 번에 제출하고 waitCount개 완료될 때까지(또는 timeoutNs) 대기
+		// timeoutNs가 음수면 시간 제한 없음
+		int SubmitAndWait(const unsigned waitCount, const int64_t timeoutNs);
+
+		// 완료된 CQE마다 callback(cqe) 호출 후 소비, 처리한 개수 반환
+		template <class Callback>
+		unsigned ForEachCompletion(Callback callback)
+		{
+			unsigned head = *mpCqHead;
+			const unsigned tail = __atomic_load_n(mpCqTail, __ATOMIC_ACQUIRE);
+
+			unsigned count = 0;
+			for (; head != tail; ++head, ++count)
+			{
+				callback(mpCqes[head & mCqMask]);
+			}
+
+			__atomic_store_n(mpCqHead, head, __ATOMIC_RELEASE);
+
+			return count;
+		}
+
+		// 멀티샷 recv용 커널 등록 버퍼 링 (IORING_REGISTER_PBUF_RING)
+		bool RegisterBufferRing(const uint16_t groupId, const unsigned bufferCount, const unsigned bufferSize);
+
+		uint8_t* GetBuffer(const uint16_t bufferId)
+		{
+			return mpBufferMemory + static_cast<size_t>(bufferId) * mBufferSize;
+		}
+
+		// 다 쓴 버퍼를 커널에 돌려줌
+		void RecycleBuffer(const uint16_t bufferId);
+
+		unsigned GetBufferSize() const
+		{
+			return mBufferSize;
+		}
+
+		// io_uring_enter 호출 횟수, 백엔드 비교용
+		uint64_t GetEnterCount() const
+		{
+			return mEnterCount;
+		}
+
+	private:
+		// C++에서는 bufs의 빈 구조체 자리(__DECLARE_FLEX_ARRAY)가 1바이트를 차지해 오프셋이 어긋나므로 직접 계산
+		io_uring_buf& getBufferEntry(const unsigned index)
+		{
+			return reinterpret_cast<io_uring_buf*>(mpBufferRing)[index];
+		}
+
+	private:
+		int mRingFd;
+
+		// SQ/CQ 링은 하나의 mmap을 공유 (IORING_FEAT_SINGLE_MMAP)
+		void* mpRing;
+		size_t mRingSize;
+
+		unsigned* mpSqHead;
+		unsigned* mpSqTail;
+		unsigned* mpSqArray;
+		unsigned mSqMask;
+		unsigned mSqEntries;
+		unsigned mSqLocalTail;
+
+		io_uring_sqe* mpSqes;
+		size_t mSqesSize;
+
+		unsigned* mpCqHead;
+		unsigned* mpCqTail;
+		unsigned mCqMask;
+		io_uring_cqe* mpCqes;
+
+		io_uring_buf_ring* mpBufferRing;
+		size_t mBufferRingSize;
+		unsigned mBufferRingMask;
+		uint8_t* mpBufferMemory;
+		size_t mBufferMemorySize;
+		unsigned mBufferSize;
+		uint16_t mBufferGroupId;
+
+		uint64_t mEnterCount;
+	};
+}
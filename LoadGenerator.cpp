@@ -0,0 +1,1052 @@
+#include "LoadGenerator.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Channel.h"
+#include "NetStats.h"
+#include "Protocol.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+
+namespace LoadGenerator
+{
+	enum
+	{
+		MAX_EVENTS = 1024,
+
+		// 봇 1만 개를 띄워도 메모리가 크게 늘지 않도록 서버와 같은 크기
+		RECV_BUFFER_SIZE = 4 * 1024,
+
+		// 서버가 읽지 않아 이보다 많이 밀리면 새 메시지를 쌓지 않고 버림
+		MAX_SEND_BUFFER_SIZE = 16 * 1024
+	};
+
+	// App.h의 POSITION_HEARTBEAT_MS와 같은 값
+	static constexpr double POSITION_HEARTBEAT = 0.25;
+
+	// 입력은 몇 틱씩 모아서 run으로 묶어 보냄, 메시지 헤더가 입력보다 훨씬 커서 매 틱 보내면 상향 트래픽 대부분이 헤더
+	// 다른 플레이어에게 보이는 위치가 최대 한 주기 늦어짐
+	static constexpr double MAX_INPUT_SEND_RATE = 20.0;
+
+	// 무작위 입력을 유지하는 틱 수 범위 (60Hz 기준 0.25 ~ 2초)
+	enum
+	{
+		MIN_RANDOM_HOLD_TICKS = Simulation::TICK_RATE_HZ / 4,
+		MAX_RANDOM_HOLD_TICKS = Simulation::TICK_RATE_HZ * 2
+	};
+
+	enum EBotState
+	{
+		BOT_IDLE,
+		BOT_CONNECTING,
+		BOT_CONNECTED,
+		BOT_CLOSED
+	};
+
+	struct ScriptStep
+	{
+		uint32_t tickCount;
+		uint8_t input;
+	};
+
+	struct Bot
+	{
+		Bot()
+			: fd(-1)
+			, state(BOT_IDLE)
+			, recvBuffer(RECV_BUFFER_SIZE)
+			, sendOffset(0)
+			, throttle(POSITION_HEARTBEAT, MAX_INPUT_SEND_RATE)
+			, unsentInputCount(0)
+			, input(Simulation::INPUT_NONE)
+			, inputTicksLeft(0)
+			, scriptStep(0)
+			, random(1)
+			, nextPingTime(0.0)
+			, bIdle(false)
+			, bServed(false)
+		{
+		}
+
+		int fd;
+		EBotState state;
+
+		Protocol::StreamBuffer recvBuffer;
+		std::vector<uint8_t> sendBuffer;
+		size_t sendOffset;
+
+		// 위치는 서버가 계산하므로 아직 보내지 않은 틱의 입력만 모아 둠
+		Channel::SendThrottle throttle;
+		uint8_t unsentInputs[Protocol::MAX_INPUT_RUNS * Protocol::MAX_INPUT_RUN_LENGTH];
+		size_t unsentInputCount;
+
+		// 현재 누르고 있는 키와 남은 틱 수
+		uint8_t input;
+		uint32_t inputTicksLeft;
+		size_t scriptStep;
+
+		uint32_t random;
+		double nextPingTime;
+
+		// 자리를 비운 플레이어처럼 입력과 ping 없이 스냅샷 ack만 보냄
+		bool bIdle;
+
+		// 서버에서 메시지를 하나라도 받았는지, 서버가 accept하고 처리하기 시작했다는 뜻
+		bool bServed;
+
+		// 서버의 delta 스냅샷을 실제 클라이언트처럼 풀고 ack
+		Snapshot::Receiver snapshotReceiver;
+	};
+
+	// 워커가 틱마다 넘기고 메인 스레드가 1초마다 가져가는 측정값
+	struct Report
+	{
+		Report()
+			: bytesIn(0)
+			, bytesOut(0)
+			, messagesIn(0)
+			, messagesOut(0)
+			, droppedMessageCount(0)
+			, lateTickCount(0)
+			, snapshotCount(0)
+			, snapshotErrorCount(0)
+		{
+		}
+
+		void Merge(Report& other)
+		{
+			bytesIn += other.bytesIn;
+			bytesOut += other.bytesOut;
+			messagesIn += other.messagesIn;
+			messagesOut += other.messagesOut;
+			droppedMessageCount += other.droppedMessageCount;
+			lateTickCount += other.lateTickCount;
+			snapshotCount += other.snapshotCount;
+			snapshotErrorCount += other.snapshotErrorCount;
+
+			rttSamples.insert(rttSamples.end(), other.rttSamples.begin(), other.rttSamples.end());
+			tickTimeSamples.insert(tickTimeSamples.end(), other.tickTimeSamples.begin(), other.tickTimeSamples.end());
+
+			other = Report();
+		}
+
+		uint64_t bytesIn;
+		uint64_t bytesOut;
+		uint64_t messagesIn;
+		uint64_t messagesOut;
+
+		// 송신 버퍼가 가득 차서 버린 메시지 수
+		uint64_t droppedMessageCount;
+
+		// 워커가 틱 시간을 못 맞춘 횟수, 늘어나면 부하 생성기 쪽이 병목
+		uint64_t lateTickCount;
+
+		// 다 받은 스냅샷 수와 기준 프레임이 없거나 형식이 잘못되어 버린 수
+		uint64_t snapshotCount;
+		uint64_t snapshotErrorCount;
+
+		// MSG_PONG마다 하나씩, 단위 us
+		std::vector<uint32_t> rttSamples;
+		std::vector<uint32_t> tickTimeSamples;
+	};
+
+	// 스레드 하나가 봇 여러 개를 epoll 하나로 맡음
+	struct Worker
+	{
+		Worker()
+			: epollFd(-1)
+			, nextConnectIndex(0)
+			, connectingCount(0)
+			, connectedCount(0)
+			, closedCount(0)
+			, establishedCount(0)
+			, servedCount(0)
+		{
+		}
+
+		int epollFd;
+		std::vector<std::unique_ptr<Bot>> bots;
+		size_t nextConnectIndex;
+
+		std::thread thread;
+
+		// 워커 스레드 전용
+		Report localReport;
+
+		// 메인 스레드와 공유
+		std::mutex reportMutex;
+		Report sharedReport;
+
+		std::atomic<uint32_t> connectingCount;
+		std::atomic<uint32_t> connectedCount;
+		std::atomic<uint32_t> closedCount;
+
+		// 지금까지 접속에 성공한 수, 끊겨도 줄지 않음
+		std::atomic<uint32_t> establishedCount;
+		std::atomic<uint32_t> servedCount;
+	};
+
+	static Config sConfig;
+	static sockaddr_in sServerAddr;
+
+	static std::vector<ScriptStep> sScript;
+	static uint32_t sScriptTickCount;
+
+	static std::vector<std::unique_ptr<Worker>> sWorkers;
+
+	static std::atomic<bool> sbRunning(false);
+
+	static uint64_t getTimeUs()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	static double getTime()
+	{
+		return getTimeUs() * 1e-6;
+	}
+
+	// xorshift32, 봇마다 상태를 따로 둬서 시드가 같으면 같은 입력이 나옴
+	static uint32_t nextRandom(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return state;
+	}
+
+	static float randomRange(uint32_t& state, const float min, const float max)
+	{
+		return min + (max - min) * (nextRandom(state) >> 8) / static_cast<float>(1u << 24);
+	}
+
+	// 봇 1만 개를 띄울 수 있도록 fd 제한을 최대로 올림
+	static void raiseFileLimit()
+	{
+		rlimit limit;
+		if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+		{
+			limit.rlim_cur = limit.rlim_max;
+			setrlimit(RLIMIT_NOFILE, &limit);
+		}
+	}
+
+	static bool loadScript(const char* pPath)
+	{
+		std::ifstream file(pPath);
+		if (!file)
+		{
+			std::cerr << "cannot open script " << pPath << std::endl;
+			return false;
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			line = line.substr(0, line.find('#'));
+
+			std::istringstream stream(line);
+
+			uint32_t tickCount;
+			std::string keys;
+			if (!(stream >> tickCount >> keys))
+			{
+				continue;
+			}
+
+			uint8_t input = Simulation::INPUT_NONE;
+			for (const char key : keys)
+			{
+				switch (key)
+				{
+				case 'U':
+					input |= Simulation::INPUT_UP;
+					break;
+
+				case 'D':
+					input |= Simulation::INPUT_DOWN;
+					break;
+
+				case 'L':
+					input |= Simulation::INPUT_LEFT;
+					break;
+
+				case 'R':
+					input |= Simulation::INPUT_RIGHT;
+					break;
+
+				default:
+					break;
+				}
+			}
+
+			if (tickCount > 0)
+			{
+				sScript.push_back({ tickCount, input });
+				sScriptTickCount += tickCount;
+			}
+		}
+
+		if (sScript.empty())
+		{
+			std::cerr << "script " << pPath << " has no steps" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	// 스크립트를 쓰면 한 단계가 끝날 때마다 다음 단계로, 아니면 무작위 방향을 무작위 시간 동안 유지
+	static uint8_t nextInput(Bot& bot)
+	{
+		using namespace Simulation;
+
+		if (bot.inputTicksLeft > 0)
+		{
+			--bot.inputTicksLeft;
+			return bot.input;
+		}
+
+		if (!sScript.empty())
+		{
+			bot.scriptStep = (bot.scriptStep + 1) % sScript.size();
+			bot.input = sScript[bot.scriptStep].input;
+			bot.inputTicksLeft = sScript[bot.scriptStep].tickCount - 1;
+
+			return bot.input;
+		}
+
+		// 정지와 8방향 중 하나
+		static const uint8_t RANDOM_INPUTS[] =
+		{
+			INPUT_NONE,
+			INPUT_UP, INPUT_DOWN, INPUT_LEFT, INPUT_RIGHT,
+			INPUT_UP | INPUT_LEFT, INPUT_UP | INPUT_RIGHT, INPUT_DOWN | INPUT_LEFT, INPUT_DOWN | INPUT_RIGHT
+		};
+
+		bot.input = RANDOM_INPUTS[nextRandom(bot.random) % (sizeof(RANDOM_INPUTS) / sizeof(RANDOM_INPUTS[0]))];
+		bot.inputTicksLeft = MIN_RANDOM_HOLD_TICKS + nextRandom(bot.random) % (MAX_RANDOM_HOLD_TICKS - MIN_RANDOM_HOLD_TICKS + 1) - 1;
+
+		return bot.input;
+	}
+
+	static void closeBot(Worker& worker, Bot& bot)
+	{
+		if (bot.state == BOT_CONNECTING)
+		{
+			--worker.connectingCount;
+		}
+		else if (bot.state == BOT_CONNECTED)
+		{
+			--worker.connectedCount;
+		}
+
+		if (bot.fd != -1)
+		{
+			// 닫으면 epoll에서도 빠짐
+			close(bot.fd);
+			bot.fd = -1;
+		}
+
+		bot.state = BOT_CLOSED;
+		++worker.closedCount;
+	}
+
+	static void connectBot(Worker& worker, Bot& bot)
+	{
+		bot.fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+		if (bot.fd == -1)
+		{
+			closeBot(worker, bot);
+			return;
+		}
+
+		const int noDelay = 1;
+		setsockopt(bot.fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+		bot.state = BOT_CONNECTING;
+		++worker.connectingCount;
+
+		if (connect(bot.fd, reinterpret_cast<const sockaddr*>(&sServerAddr), sizeof(sServerAddr)) == -1 && errno != EINPROGRESS)
+		{
+			closeBot(worker, bot);
+			return;
+		}
+
+		// 연결이 끝나면 EPOLLOUT이 옴
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		event.data.ptr = &bot;
+
+		if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, bot.fd, &event) == -1)
+		{
+			closeBot(worker, bot);
+		}
+	}
+
+	static void flushSendBuffer(Worker& worker, Bot& bot)
+	{
+		std::vector<uint8_t>& sendBuffer = bot.sendBuffer;
+
+		while (bot.sendOffset < sendBuffer.size())
+		{
+			const size_t requestedSize = sendBuffer.size() - bot.sendOffset;
+			const ssize_t sentSize = send(bot.fd, sendBuffer.data() + bot.sendOffset, requestedSize, MSG_NOSIGNAL);
+			if (sentSize == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					closeBot(worker, bot);
+				}
+				else
+				{
+					NetStats::Add(NetStats::WOULD_BLOCK_SENDS);
+				}
+
+				break;
+			}
+
+			bot.sendOffset += sentSize;
+			worker.localReport.bytesOut += sentSize;
+
+			NetStats::Add(NetStats::BYTES_OUT, sentSize);
+			NetStats::Add(NetStats::PACKETS_OUT);
+			if (static_cast<size_t>(sentSize) < requestedSize)
+			{
+				NetStats::Add(NetStats::PARTIAL_SENDS);
+			}
+		}
+
+		if (bot.sendOffset == sendBuffer.size())
+		{
+			sendBuffer.clear();
+			bot.sendOffset = 0;
+		}
+	}
+
+	static void queueMessage(Worker& worker, Bot& bot, const Protocol::EMessageType type, const uint32_t tick, const void* pPayload, const size_t payloadSize)
+	{
+		if (bot.sendBuffer.size() - bot.sendOffset > MAX_SEND_BUFFER_SIZE)
+		{
+			++worker.localReport.droppedMessageCount;
+			return;
+		}
+
+		uint8_t message[Protocol::MAX_MESSAGE_SIZE];
+		const size_t messageSize = Protocol::WriteMessage(message, sizeof(message), type, 0, tick, pPayload, payloadSize);
+
+		bot.sendBuffer.insert(bot.sendBuffer.end(), message, message + messageSize);
+		++worker.localReport.messagesOut;
+	}
+
+	static void handleSnapshot(Worker& worker, Bot& bot, const Protocol::MessageView& message)
+	{
+		const Snapshot::Receiver::EResult result = bot.snapshotReceiver.Receive(message);
+		if (result == Snapshot::Receiver::RESULT_ERROR)
+		{
+			++worker.localReport.snapshotErrorCount;
+			return;
+		}
+
+		if (result == Snapshot::Receiver::RESULT_FRAME)
+		{
+			++worker.localReport.snapshotCount;
+
+			const Protocol::SnapshotAckPayload ack = { message.header.tick };
+			queueMessage(worker, bot, Protocol::MSG_SNAPSHOT_ACK, message.header.tick, &ack, sizeof(ack));
+		}
+	}
+
+	static void handleMessage(Worker& worker, Bot& bot, const Protocol::MessageView& message)
+	{
+		++worker.localReport.messagesIn;
+
+		if (!bot.bServed)
+		{
+			bot.bServed = true;
+			++worker.servedCount;
+		}
+
+		if (message.header.type == Protocol::MSG_SNAPSHOT)
+		{
+			handleSnapshot(worker, bot, message);
+			return;
+		}
+
+		if (message.header.type != Protocol::MSG_PONG)
+		{
+			return;
+		}
+
+		Protocol::PongPayload pong;
+		if (message.payloadSize != sizeof(pong))
+		{
+			return;
+		}
+
+		memcpy(&pong, message.pPayload, sizeof(pong));
+
+		const uint64_t now = getTimeUs();
+		if (now >= pong.pingSendTime)
+		{
+			worker.localReport.rttSamples.push_back(static_cast<uint32_t>(now - pong.pingSendTime));
+		}
+
+		worker.localReport.tickTimeSamples.push_back(pong.tickTime);
+	}
+
+	static void receiveMessages(Worker& worker, Bot& bot)
+	{
+		Protocol::StreamBuffer& recvBuffer = bot.recvBuffer;
+
+		while (bot.state == BOT_CONNECTED)
+		{
+			recvBuffer.Compact();
+			const ssize_t receivedSize = recv(bot.fd, recvBuffer.GetWritePtr(), recvBuffer.GetWritableSize(), 0);
+			if (receivedSize == 0)
+			{
+				closeBot(worker, bot);
+				break;
+			}
+
+			if (receivedSize == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					closeBot(worker, bot);
+				}
+				else
+				{
+					NetStats::Add(NetStats::WOULD_BLOCK_RECVS);
+				}
+
+				break;
+			}
+
+			recvBuffer.CommitWrite(receivedSize);
+			worker.localReport.bytesIn += receivedSize;
+
+			NetStats::Add(NetStats::BYTES_IN, receivedSize);
+			NetStats::Add(NetStats::PACKETS_IN);
+
+			Protocol::MessageView message;
+			Protocol::EParseResult result;
+			while ((result = recvBuffer.Parse(message)) == Protocol::PARSE_OK)
+			{
+				handleMessage(worker, bot, message);
+			}
+
+			if (result == Protocol::PARSE_ERROR)
+			{
+				closeBot(worker, bot);
+			}
+			else if (recvBuffer.GetPendingSize() > 0)
+			{
+				NetStats::Add(NetStats::PARTIAL_FRAMES);
+			}
+		}
+	}
+
+	static void onBotEvent(Worker& worker, Bot& bot, const uint32_t flags)
+	{
+		if (bot.state == BOT_CONNECTING)
+		{
+			if ((flags & (EPOLLOUT | EPOLLERR | EPOLLHUP)) == 0)
+			{
+				return;
+			}
+
+			int error = 0;
+			socklen_t errorSize = sizeof(error);
+			if (getsockopt(bot.fd, SOL_SOCKET, SO_ERROR, &error, &errorSize) == -1 || error != 0)
+			{
+				closeBot(worker, bot);
+				return;
+			}
+
+			--worker.connectingCount;
+			++worker.connectedCount;
+			++worker.establishedCount;
+			bot.state = BOT_CONNECTED;
+
+			// 봇들의 ping이 한꺼번에 몰리지 않도록 첫 ping 시점을 흩어 놓음
+			bot.nextPingTime = getTime() + randomRange(bot.random, 0.f, static_cast<float>(sConfig.pingInterval));
+		}
+
+		if (bot.state != BOT_CONNECTED)
+		{
+			return;
+		}
+
+		if ((flags & EPOLLIN) != 0)
+		{
+			receiveMessages(worker, bot);
+		}
+
+		if ((flags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0)
+		{
+			closeBot(worker, bot);
+			return;
+		}
+
+		if ((flags & EPOLLOUT) != 0 && bot.state == BOT_CONNECTED)
+		{
+			flushSendBuffer(worker, bot);
+		}
+	}
+
+	// App의 updateMyData와 같은 흐름: 입력 기록 -> 키를 눌렀거나 heartbeat 시간이면 모인 입력을 run으로 묶어 전송
+	// TCP라 손실이 없으므로 App처럼 확인 안 된 입력을 겹쳐 보내지 않음
+	static void updateBot(Worker& worker, Bot& bot, const uint32_t tick, const double now)
+	{
+		if (bot.bIdle)
+		{
+			flushSendBuffer(worker, bot);
+			return;
+		}
+
+		const uint8_t input = nextInput(bot);
+
+		// 보내지 못하고 가득 차면 오래된 입력부터 버림, 서버는 빠진 틱을 입력 없음으로 처리
+		if (bot.unsentInputCount == sizeof(bot.unsentInputs))
+		{
+			memmove(bot.unsentInputs, bot.unsentInputs + 1, bot.unsentInputCount - 1);
+			--bot.unsentInputCount;
+		}
+
+		bot.unsentInputs[bot.unsentInputCount++] = input;
+
+		bool bChanged = false;
+		for (size_t i = 0; i < bot.unsentInputCount; ++i)
+		{
+			bChanged |= bot.unsentInputs[i] != Simulation::INPUT_NONE;
+		}
+
+		if (bot.throttle.ShouldSend(bChanged, now))
+		{
+			Protocol::InputPayload payload;
+			Protocol::EncodeInputs(bot.unsentInputs, bot.unsentInputCount, tick, payload);
+			queueMessage(worker, bot, Protocol::MSG_INPUT, tick, &payload, Protocol::GetInputPayloadSize(payload));
+
+			bot.unsentInputCount = 0;
+		}
+
+		if (now >= bot.nextPingTime)
+		{
+			const Protocol::PingPayload ping = { getTimeUs() };
+			queueMessage(worker, bot, Protocol::MSG_PING, tick, &ping, sizeof(ping));
+
+			bot.nextPingTime = now + sConfig.pingInterval;
+		}
+
+		flushSendBuffer(worker, bot);
+	}
+
+	static void runWorker(Worker* pWorker, const double startTime)
+	{
+		Worker& worker = *pWorker;
+
+		// 워커마다 접속 속도를 나눠 가짐, 틱이 밀려도 속도가 떨어지지 않도록 지난 시간으로 계산
+		const double connectsPerSecond = static_cast<double>(sConfig.connectRate) / sConfig.threadCount;
+		double connectBudget = 0.0;
+		double lastConnectTime = startTime;
+
+		double nextTickTime = startTime;
+		uint32_t tick = 0;
+
+		epoll_event events[MAX_EVENTS];
+
+		while (sbRunning.load())
+		{
+			const double untilTick = nextTickTime - getTime();
+			const int timeoutMs = untilTick > 0.0 ? static_cast<int>(std::ceil(untilTick * 1000.0)) : 0;
+
+			const int eventCount = epoll_wait(worker.epollFd, events, MAX_EVENTS, timeoutMs);
+			for (int i = 0; i < eventCount; ++i)
+			{
+				onBotEvent(worker, *static_cast<Bot*>(events[i].data.ptr), events[i].events);
+			}
+
+			const double now = getTime();
+			if (now < nextTickTime)
+			{
+				continue;
+			}
+
+			connectBudget = std::min(connectBudget + connectsPerSecond * (now - lastConnectTime), connectsPerSecond);
+			lastConnectTime = now;
+			while (connectBudget >= 1.0 && worker.nextConnectIndex < worker.bots.size())
+			{
+				connectBot(worker, *worker.bots[worker.nextConnectIndex++]);
+				connectBudget -= 1.0;
+			}
+
+			int64_t sendQueueBytes = 0;
+			int64_t recvQueueBytes = 0;
+
+			for (const std::unique_ptr<Bot>& pBot : worker.bots)
+			{
+				if (pBot->state == BOT_CONNECTED)
+				{
+					updateBot(worker, *pBot, tick, now);
+
+					sendQueueBytes += pBot->sendBuffer.size() - pBot->sendOffset;
+					recvQueueBytes += pBot->recvBuffer.GetPendingSize();
+				}
+			}
+
+			// 워커마다 자기 샤드에 기록하고 출력할 때 합쳐짐
+			NetStats::SetGauge(NetStats::SEND_QUEUE_BYTES, sendQueueBytes);
+			NetStats::SetGauge(NetStats::RECV_QUEUE_BYTES, recvQueueBytes);
+
+			++tick;
+			nextTickTime += Simulation::TICK_INTERVAL;
+
+			// 밀린 틱을 몰아서 돌리지 않음
+			if (getTime() > nextTickTime + Simulation::TICK_INTERVAL)
+			{
+				++worker.localReport.lateTickCount;
+				nextTickTime = getTime() + Simulation::TICK_INTERVAL;
+			}
+
+			std::lock_guard<std::mutex> lock(worker.reportMutex);
+			worker.sharedReport.Merge(worker.localReport);
+		}
+	}
+
+	// samples는 정렬되어 있어야 함, 단위 us -> ms
+	static double getPercentile(const std::vector<uint32_t>& samples, const double percentile)
+	{
+		if (samples.empty())
+		{
+			return 0.0;
+		}
+
+		const size_t index = static_cast<size_t>(percentile * (samples.size() - 1) + 0.5);
+
+		return samples[index] / 1000.0;
+	}
+
+	static void printPercentiles(const char* pName, std::vector<uint32_t>& samples)
+	{
+		std::cout << " | " << pName << " ms";
+
+		// 서버가 응답하지 못하고 있음
+		if (samples.empty())
+		{
+			std::cout << " -";
+			return;
+		}
+
+		std::sort(samples.begin(), samples.end());
+
+		std::cout
+			<< " p50 " << getPercentile(samples, 0.5)
+			<< " p90 " << getPercentile(samples, 0.9)
+			<< " p99 " << getPercentile(samples, 0.99)
+			<< " max " << getPercentile(samples, 1.0);
+	}
+
+	static double getCpuTime()
+	{
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+
+		return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6
+			+ usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+	}
+
+	static void printStats(const double elapsed, const double cpuTime, const uint32_t newConnectionCount)
+	{
+		Report report;
+		uint32_t connectingCount = 0;
+		uint32_t connectedCount = 0;
+		uint32_t closedCount = 0;
+
+		for (const std::unique_ptr<Worker>& pWorker : sWorkers)
+		{
+			{
+				std::lock_guard<std::mutex> lock(pWorker->reportMutex);
+				report.Merge(pWorker->sharedReport);
+			}
+
+			connectingCount += pWorker->connectingCount.load();
+			connectedCount += pWorker->connectedCount.load();
+			closedCount += pWorker->closedCount.load();
+		}
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< "bots " << connectedCount << "/" << sConfig.botCount
+			<< " (connecting " << connectingCount << ", closed " << closedCount << ")";
+
+		if (newConnectionCount > 0)
+		{
+			std::cout << " | connects/s " << static_cast<uint64_t>(newConnectionCount / elapsed);
+		}
+
+		printPercentiles("rtt", report.rttSamples);
+		printPercentiles("server tick", report.tickTimeSamples);
+
+		std::cout << " | out " << static_cast<uint64_t>(report.messagesOut / elapsed) << " msgs/s "
+			<< report.bytesOut / elapsed / 1024.0 << " KiB/s"
+			<< " | in " << static_cast<uint64_t>(report.messagesIn / elapsed) << " msgs/s "
+			<< report.bytesIn / elapsed / 1024.0 << " KiB/s";
+
+		if (report.droppedMessageCount > 0)
+		{
+			std::cout << " | dropped " << report.droppedMessageCount;
+		}
+
+		if (report.lateTickCount > 0)
+		{
+			std::cout << " | late ticks " << report.lateTickCount;
+		}
+
+		if (report.snapshotCount > 0 || report.snapshotErrorCount > 0)
+		{
+			std::cout << " | snapshots/s " << static_cast<uint64_t>(report.snapshotCount / elapsed);
+			if (report.snapshotErrorCount > 0)
+			{
+				std::cout << " (errors " << report.snapshotErrorCount << ")";
+			}
+		}
+
+		// 부하 생성기 자신의 CPU 사용률, 코어 수 * 100%에 가까우면 측정값을 믿을 수 없음
+		std::cout << " | cpu " << 100.0 * cpuTime / elapsed << "%";
+
+		std::cout << std::defaultfloat << std::endl;
+	}
+
+	bool Initialize(const Config& config)
+	{
+		sConfig = config;
+		sConfig.threadCount = std::max(1u, std::min(config.threadCount, config.botCount));
+
+		memset(&sServerAddr, 0, sizeof(sServerAddr));
+		sServerAddr.sin_family = AF_INET;
+		sServerAddr.sin_port = htons(config.port);
+
+		if (inet_pton(AF_INET, config.pHost, &sServerAddr.sin_addr) != 1)
+		{
+			std::cerr << "invalid host " << config.pHost << std::endl;
+			return false;
+		}
+
+		sScript.clear();
+		sScriptTickCount = 0;
+		if (config.pScriptPath != nullptr && !loadScript(config.pScriptPath))
+		{
+			return false;
+		}
+
+		raiseFileLimit();
+
+		for (uint32_t i = 0; i < sConfig.threadCount; ++i)
+		{
+			std::unique_ptr<Worker> pWorker(new Worker());
+
+			pWorker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+			if (pWorker->epollFd == -1)
+			{
+				std::cerr << "epoll_create1 failed: " << strerror(errno) << std::endl;
+
+				Destroy();
+				return false;
+			}
+
+			sWorkers.push_back(std::move(pWorker));
+		}
+
+		for (uint32_t i = 0; i < config.botCount; ++i)
+		{
+			std::unique_ptr<Bot> pBot(new Bot());
+
+			// 0이면 xorshift가 멈추므로 1을 섞음
+			pBot->random = (config.seed ^ (i * 2654435761u)) | 1;
+
+			// 앞 번호부터, 봇은 번호 순으로 워커에 돌아가며 나눠지므로 워커마다 고르게 섞임
+			pBot->bIdle = i < config.idleBotCount;
+
+			// 같은 스크립트라도 봇마다 다른 지점에서 시작해서 한꺼번에 움직이지 않도록
+			if (!sScript.empty())
+			{
+				uint32_t offset = nextRandom(pBot->random) % sScriptTickCount;
+				while (offset >= sScript[pBot->scriptStep].tickCount)
+				{
+					offset -= sScript[pBot->scriptStep].tickCount;
+					++pBot->scriptStep;
+				}
+
+				pBot->input = sScript[pBot->scriptStep].input;
+				pBot->inputTicksLeft = sScript[pBot->scriptStep].tickCount - offset;
+			}
+
+			sWorkers[i % sConfig.threadCount]->bots.push_back(std::move(pBot));
+		}
+
+		std::cout << "Load generator: " << config.botCount << " bots on " << sConfig.threadCount << " threads -> "
+			<< config.pHost << ":" << config.port
+			<< (sScript.empty() ? " (random input" : " (scripted input")
+			<< ", " << std::min(config.idleBotCount, config.botCount) << " idle)" << std::endl;
+
+		return true;
+	}
+
+	void Destroy()
+	{
+		for (const std::unique_ptr<Worker>& pWorker : sWorkers)
+		{
+			for (const std::unique_ptr<Bot>& pBot : pWorker->bots)
+			{
+				if (pBot->fd != -1)
+				{
+					close(pBot->fd);
+				}
+			}
+
+			if (pWorker->epollFd != -1)
+			{
+				close(pWorker->epollFd);
+			}
+		}
+
+		sWorkers.clear();
+	}
+
+	int Run()
+	{
+		sbRunning.store(true);
+
+		// 워커들의 틱 시점을 고르게 흩어 놓음
+		const double startTime = getTime();
+		for (size_t i = 0; i < sWorkers.size(); ++i)
+		{
+			const double phase = Simulation::TICK_INTERVAL * i / sWorkers.size();
+			sWorkers[i]->thread = std::thread(runWorker, sWorkers[i].get(), startTime + phase);
+		}
+
+		NetStats::Dumper netStatsDumper;
+		if (!netStatsDumper.Initialize(sConfig.pNetStatsPath, sConfig.netStatsInterval, startTime))
+		{
+			Stop();
+		}
+
+		double statsTime = startTime;
+		double statsCpuTime = getCpuTime();
+		uint32_t statsEstablishedCount = 0;
+		bool bAllConnected = false;
+		bool bAllServed = false;
+		int exitCode = 0;
+		while (sbRunning.load())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+			const double now = getTime();
+
+			uint32_t establishedCount = 0;
+			uint32_t servedCount = 0;
+			for (const std::unique_ptr<Worker>& pWorker : sWorkers)
+			{
+				establishedCount += pWorker->establishedCount.load();
+				servedCount += pWorker->servedCount.load();
+			}
+
+			// 접속 속도: 첫 접속 시도부터 마지막 봇이 접속할 때까지, 50ms 단위로 잼
+			// 핸드셰이크는 커널이 끝내므로 서버가 accept해서 처리한 속도는 첫 메시지를 받은 시점으로 봄
+			if (!bAllConnected && establishedCount == sConfig.botCount)
+			{
+				std::cout << "all " << sConfig.botCount << " bots connected in " << now - startTime << " s ("
+					<< static_cast<uint64_t>(sConfig.botCount / (now - startTime)) << " connects/s)" << std::endl;
+
+				bAllConnected = true;
+			}
+
+			if (!bAllServed && servedCount == sConfig.botCount)
+			{
+				std::cout << "all " << sConfig.botCount << " bots got a server message in " << now - startTime << " s ("
+					<< static_cast<uint64_t>(sConfig.botCount / (now - startTime)) << " accepts/s)" << std::endl;
+
+				bAllServed = true;
+			}
+
+			if (now - statsTime >= 1.0)
+			{
+				const double cpuTime = getCpuTime();
+				printStats(now - statsTime, cpuTime - statsCpuTime, establishedCount - statsEstablishedCount);
+
+				statsTime = now;
+				statsCpuTime = cpuTime;
+				statsEstablishedCount = establishedCount;
+			}
+
+			netStatsDumper.Update(now);
+
+			if (sConfig.duration > 0 && now - startTime >= sConfig.duration)
+			{
+				Stop();
+			}
+
+			// 봇은 다시 접속하지 않으므로 모두 닫혔으면 더 측정할 것이 없음
+			uint32_t closedCount = 0;
+			for (const std::unique_ptr<Worker>& pWorker : sWorkers)
+			{
+				closedCount += pWorker->closedCount.load();
+			}
+
+			if (closedCount == sConfig.botCount)
+			{
+				std::cerr << "all " << closedCount << " bots closed, is the server running on "
+					<< sConfig.pHost << ":" << sConfig.port << "?" << std::endl;
+
+				exitCode = 1;
+				Stop();
+			}
+		}
+
+		for (const std::unique_ptr<Worker>& pWorker : sWorkers)
+		{
+			pWorker->thread.join();
+		}
+
+		return exitCode;
+	}
+
+	void Stop()
+	{
+		sbRunning.store(false);
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+// 리눅스 전용 부하 생성기, 봇 N개로 전용 서버에 접속해서 움직이며 지연/처리량을 측정
+namespace LoadGenerator
+{
+	struct Config
+	{
+		// 접속할 서버 (IPv4 문자열)
+		const char* pHost;
+		uint16_t port;
+
+		uint32_t botCount;
+		uint32_t threadCount;
+
+		// botCount 중 입력과 ping 없이 스냅샷 ack만 보내는 봇 수, 자리를 비운 플레이어
+		// ack까지 끊으면 서버가 매 틱 전체 스냅샷을 보내므로 idle이 아니라 멈춘 클라이언트가 됨
+		uint32_t idleBotCount;
+
+		// 초당 새로 여는 연결 수, 서버 listen backlog가 넘치지 않도록 나눠서 접속
+		// 모두 접속하는 데 걸린 시간을 출력하므로 크게 주면 서버의 accept 속도를 잴 수 있음
+		uint32_t connectRate;
+
+		// 측정 시간(초), 0이면 Stop까지 계속
+		uint32_t duration;
+
+		// 봇마다 MSG_PING을 보내는 간격(초)
+		double pingInterval;
+
+		// 입력 스크립트 파일, nullptr이면 무작위 입력
+		// 한 줄에 "틱 수 키" (키는 U/D/L/R 조합, 없으면 -), #부터 줄 끝은 주석
+		const char* pScriptPath;
+
+		uint32_t seed;
+
+		// 이 간격(초)마다 워커 스레드들의 소켓 계측 카운터를 합쳐서 출력, 0이면 끔
+		double netStatsInterval;
+
+		// 계측 출력 파일, nullptr이면 stdout
+		const char* pNetStatsPath;
+	};
+
+	bool Initialize(const Config& config);
+	void Destroy();
+
+	// 1초마다 통계를 출력하면서 duration 동안(또는 Stop까지) 실행, 봇이 모두 끊기면 1 반환
+	int Run();
+
+	// 다른 스레드나 시그널 핸들러에서 Run 종료 요청
+	void Stop();
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "LoadGenerator.h"
+#include "Server.h"
+
+static void onSignal(const int)
+{
+	LoadGenerator::Stop();
+}
+
+static const char* const USAGE = "usage: SimpleNetworkLoadGenerator [--bots N] [--idle N] [--threads N] [--rate N] [--duration S]"
+	" [--ping S] [--script FILE] [--seed N] [--host IP] [--net-stats S] [--net-stats-file FILE] [port]";
+
+// 값을 받는 옵션
+static const char* const VALUE_OPTIONS[] =
+{
+	"--bots", "--idle", "--threads", "--rate", "--duration", "--ping", "--script", "--seed", "--host", "--net-stats", "--net-stats-file"
+};
+
+// 1 ~ 65535의 10진수만 받음
+static bool parsePort(const char* pText, uint16_t& outPort)
+{
+	char* pEnd = nullptr;
+	errno = 0;
+	const long value = strtol(pText, &pEnd, 10);
+	if (errno != 0 || pEnd == pText || *pEnd != '\0' || value < 1 || value > 65535)
+	{
+		return false;
+	}
+
+	outPort = static_cast<uint16_t>(value);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	LoadGenerator::Config config;
+	config.pHost = "127.0.0.1";
+	config.port = Server::DEFAULT_PORT;
+	config.botCount = 100;
+	config.idleBotCount = 0;
+	config.threadCount = std::max(1u, std::thread::hardware_concurrency());
+	config.connectRate = 1000;
+	config.duration = 0;
+	config.pingInterval = 0.5;
+	config.pScriptPath = nullptr;
+	config.seed = 1;
+	config.netStatsInterval = 0.0;
+	config.pNetStatsPath = nullptr;
+
+	bool bHasPort = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		bool bTakesValue = false;
+		for (const char* pOption : VALUE_OPTIONS)
+		{
+			bTakesValue |= strcmp(argv[i], pOption) == 0;
+		}
+
+		if (bTakesValue && i + 1 >= argc)
+		{
+			std::cerr << argv[i] << " needs a value" << std::endl << USAGE << std::endl;
+			return 1;
+		}
+
+		if (strcmp(argv[i], "--bots") == 0)
+		{
+			config.botCount = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--idle") == 0)
+		{
+			config.idleBotCount = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--threads") == 0)
+		{
+			config.threadCount = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--rate") == 0)
+		{
+			config.connectRate = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--duration") == 0)
+		{
+			config.duration = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--ping") == 0)
+		{
+			config.pingInterval = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--script") == 0)
+		{
+			config.pScriptPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--seed") == 0)
+		{
+			config.seed = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--host") == 0)
+		{
+			config.pHost = argv[++i];
+		}
+		else if (strcmp(argv[i], "--net-stats") == 0)
+		{
+			config.netStatsInterval = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--net-stats-file") == 0)
+		{
+			config.pNetStatsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if (argv[i][0] == '-' || bHasPort || !parsePort(argv[i], config.port))
+		{
+			std::cerr << "invalid argument: " << argv[i] << std::endl << USAGE << std::endl;
+			return 1;
+		}
+		else
+		{
+			bHasPort = true;
+		}
+	}
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onSignal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	if (!LoadGenerator::Initialize(config))
+	{
+		return 1;
+	}
+
+	const int exitCode = LoadGenerator::Run();
+	LoadGenerator::Destroy();
+
+	return exitCode;
+}
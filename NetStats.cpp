@@ -0,0 +1,255 @@
+#include "NetStats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace NetStats
+{
+	thread_local Shard* tpShard = nullptr;
+
+	// 마지막 샤드는 자리가 없을 때 여러 스레드가 함께 쓰는 공유 샤드
+	static Shard sShards[MAX_SHARDS + 1];
+
+	// 반납된 샤드를 먼저 재사용해서 스레드가 계속 생겨도 샤드 수가 늘지 않도록 함
+	static std::mutex sShardMutex;
+	static std::vector<Shard*> sFreeShards;
+	static std::atomic<size_t> sUsedShardCount(0);
+
+	static Shard& getSharedShard()
+	{
+		return sShards[MAX_SHARDS];
+	}
+
+	// 스레드가 끝날 때 샤드를 반납
+	class ShardOwner
+	{
+	public:
+		ShardOwner()
+			: mpShard(nullptr)
+		{
+		}
+
+		~ShardOwner()
+		{
+			if (mpShard == nullptr)
+			{
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(sShardMutex);
+
+			sFreeShards.push_back(mpShard);
+			tpShard = nullptr;
+		}
+
+		void Set(Shard* pShard)
+		{
+			mpShard = pShard;
+		}
+
+	private:
+		Shard* mpShard;
+	};
+
+	Shard* AcquireThreadShard()
+	{
+		static thread_local ShardOwner sOwner;
+
+		Shard* pShard = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(sShardMutex);
+
+			if (!sFreeShards.empty())
+			{
+				pShard = sFreeShards.back();
+				sFreeShards.pop_back();
+			}
+			else if (sUsedShardCount.load(std::memory_order_relaxed) < MAX_SHARDS)
+			{
+				pShard = &sShards[sUsedShardCount.load(std::memory_order_relaxed)];
+
+				// Collect는 락 없이 여기까지만 읽음
+				sUsedShardCount.store(sUsedShardCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			}
+			else
+			{
+				// 공유 샤드를 쓰는 스레드는 모두 이 락을 거친 뒤에 bShared를 읽음
+				getSharedShard().bShared = true;
+			}
+		}
+
+		if (pShard == nullptr)
+		{
+			tpShard = &getSharedShard();
+			return tpShard;
+		}
+
+		sOwner.Set(pShard);
+		tpShard = pShard;
+
+		return pShard;
+	}
+
+	void SetGauge(const EGauge gauge, const int64_t value)
+	{
+		// 공유 샤드에서는 마지막으로 쓴 스레드의 값만 남음
+		Shard& shard = GetThreadShard();
+
+		shard.gauges[gauge].store(value, std::memory_order_relaxed);
+		if (value > shard.peaks[gauge].load(std::memory_order_relaxed))
+		{
+			shard.peaks[gauge].store(value, std::memory_order_relaxed);
+		}
+	}
+
+	static void addShard(Shard& shard, Totals& outTotals, const bool bResetPeaks)
+	{
+		for (int i = 0; i < COUNTER_COUNT; ++i)
+		{
+			outTotals.counters[i] += shard.counters[i].load(std::memory_order_relaxed);
+		}
+
+		for (int i = 0; i < GAUGE_COUNT; ++i)
+		{
+			const int64_t value = shard.gauges[i].load(std::memory_order_relaxed);
+
+			outTotals.gauges[i] += value;
+			outTotals.peaks[i] += shard.peaks[i].load(std::memory_order_relaxed);
+
+			if (bResetPeaks)
+			{
+				shard.peaks[i].store(value, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void Collect(Totals& outTotals, const bool bResetPeaks)
+	{
+		memset(&outTotals, 0, sizeof(outTotals));
+
+		const size_t shardCount = sUsedShardCount.load(std::memory_order_acquire);
+		for (size_t i = 0; i < shardCount; ++i)
+		{
+			addShard(sShards[i], outTotals, bResetPeaks);
+		}
+
+		addShard(getSharedShard(), outTotals, bResetPeaks);
+	}
+
+	const char* GetCounterName(const ECounter counter)
+	{
+		static const char* const NAMES[COUNTER_COUNT] =
+		{
+			"bytes_in",
+			"bytes_out",
+			"packets_in",
+			"packets_out",
+			"partial_sends",
+			"partial_frames",
+			"would_block_sends",
+			"would_block_recvs"
+		};
+
+		return NAMES[counter];
+	}
+
+	const char* GetGaugeName(const EGauge gauge)
+	{
+		static const char* const NAMES[GAUGE_COUNT] =
+		{
+			"send_queue_bytes",
+			"recv_queue_bytes",
+			"pending_packets"
+		};
+
+		return NAMES[gauge];
+	}
+
+	Dumper::Dumper()
+		: mpConsole(&std::cout)
+		, mInterval(0.0)
+		, mStartTime(0.0)
+		, mLastDumpTime(0.0)
+	{
+		memset(&mLastTotals, 0, sizeof(mLastTotals));
+	}
+
+	bool Dumper::Initialize(const char* pPath, const double interval, const double now)
+	{
+		mInterval = interval;
+		mStartTime = now;
+		mLastDumpTime = now;
+
+		Collect(mLastTotals, true);
+
+		if (pPath == nullptr)
+		{
+			return true;
+		}
+
+		mFile.open(pPath, std::ios::out | std::ios::app);
+		if (!mFile.is_open())
+		{
+			std::cerr << "cannot open net stats file " << pPath << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Dumper::Update(const double now)
+	{
+		const double elapsed = now - mLastDumpTime;
+		if (mInterval <= 0.0 || elapsed < mInterval)
+		{
+			return false;
+		}
+
+		Totals totals;
+		Collect(totals, true);
+
+		// 한 줄에 "이름 합계 (+초당 증가량)", 게이지는 "이름 현재값 (peak 최대값)"
+		// 출력 스트림의 서식을 바꾸지 않도록 따로 만들어서 한 번에 씀
+		std::ostringstream stream;
+		stream << "net " << std::fixed << std::setprecision(1) << now - mStartTime << "s";
+
+		for (int i = 0; i < COUNTER_COUNT; ++i)
+		{
+			const ECounter counter = static_cast<ECounter>(i);
+			stream << " | " << GetCounterName(counter) << ' ' << totals.counters[i]
+				<< " (+" << (totals.counters[i] - mLastTotals.counters[i]) / elapsed << "/s)";
+		}
+
+		for (int i = 0; i < GAUGE_COUNT; ++i)
+		{
+			const EGauge gauge = static_cast<EGauge>(i);
+			stream << " | " << GetGaugeName(gauge) << ' ' << totals.gauges[i]
+				<< " (peak " << std::max(totals.peaks[i], totals.gauges[i]) << ")";
+		}
+
+		stream << '\n';
+		GetStream() << stream.str() << std::flush;
+
+		mLastTotals = totals;
+		mLastDumpTime = now;
+
+		return true;
+	}
+
+	void WriteConnection(std::ostream& stream, const uint32_t id, const ConnectionCounters& connection)
+	{
+		stream << "  connection " << id;
+
+		for (int i = 0; i < COUNTER_COUNT; ++i)
+		{
+			stream << " | " << GetCounterName(static_cast<ECounter>(i)) << ' ' << connection.values[i];
+		}
+
+		stream << std::endl;
+	}
+}
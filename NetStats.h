@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+
+#include "Concurrency.h"
+
+// 소켓 계측 카운터, 스레드마다 자기 샤드에만 쓰고 읽을 때 모두 합침
+namespace NetStats
+{
+	// 누적 카운터
+	// TCP의 패킷 수는 성공한 send/recv 호출 수, UDP는 데이터그램 수
+	enum ECounter
+	{
+		BYTES_IN,
+		BYTES_OUT,
+		PACKETS_IN,
+		PACKETS_OUT,
+
+		// 요청보다 적게 보낸 send
+		PARTIAL_SENDS,
+
+		// 메시지 중간에서 끝나서 다음 recv를 기다려야 하는 수신
+		PARTIAL_FRAMES,
+
+		WOULD_BLOCK_SENDS,
+		WOULD_BLOCK_RECVS,
+
+		COUNTER_COUNT
+	};
+
+	// 현재 값 게이지, 스레드마다 자기가 맡은 큐의 합을 기록하고 읽을 때 모든 스레드의 값을 더함
+	enum EGauge
+	{
+		// 보내지 못하고 쌓인 바이트
+		SEND_QUEUE_BYTES,
+
+		// 메시지가 완성되지 않아 수신 버퍼에 남은 바이트
+		RECV_QUEUE_BYTES,
+
+		// 받아서 게임 루프로 넘기기를 기다리는 스냅샷/패킷 수
+		PENDING_PACKETS,
+
+		GAUGE_COUNT
+	};
+
+	enum
+	{
+		// 동시에 샤드를 가질 수 있는 스레드 수, 넘으면 공유 샤드에 원자적으로 더함
+		MAX_SHARDS = 64
+	};
+
+	// 다른 스레드의 샤드와 캐시 라인을 나눠 쓰지 않도록 정렬, 정적 배열로만 둠
+	struct alignas(Concurrency::CACHE_LINE_SIZE) Shard
+	{
+		std::atomic<uint64_t> counters[COUNTER_COUNT];
+		std::atomic<int64_t> gauges[GAUGE_COUNT];
+
+		// 마지막 덤프 이후 게이지의 최대값
+		std::atomic<int64_t> peaks[GAUGE_COUNT];
+
+		// 여러 스레드가 함께 쓰는 공유 샤드면 true
+		bool bShared;
+	};
+
+	// 현재 스레드의 샤드, 아직 없으면 nullptr (t: thread_local)
+	extern thread_local Shard* tpShard;
+
+	// 빈 샤드를 배정하고 스레드가 끝나면 반납, 반납한 샤드의 값은 합계에 그대로 남음
+	Shard* AcquireThreadShard();
+
+	inline Shard& GetThreadShard()
+	{
+		Shard* pShard = tpShard;
+		if (pShard == nullptr)
+		{
+			pShard = AcquireThreadShard();
+		}
+
+		return *pShard;
+	}
+
+	// 주인 스레드만 쓰므로 lock 접두사 없는 load/store로 충분, 읽는 쪽은 찢어지지 않은 값을 봄
+	inline void Add(const ECounter counter, const uint64_t value = 1)
+	{
+		Shard& shard = GetThreadShard();
+		std::atomic<uint64_t>& target = shard.counters[counter];
+
+		if (shard.bShared)
+		{
+			target.fetch_add(value, std::memory_order_relaxed);
+			return;
+		}
+
+		target.store(target.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	void SetGauge(const EGauge gauge, const int64_t value);
+
+	// 연결별 카운터, 연결을 다루는 스레드 하나만 사용
+	struct ConnectionCounters
+	{
+		uint64_t values[COUNTER_COUNT];
+	};
+
+	inline void Add(ConnectionCounters& connection, const ECounter counter, const uint64_t value = 1)
+	{
+		connection.values[counter] += value;
+		Add(counter, value);
+	}
+
+	// 모든 샤드를 합친 값
+	struct Totals
+	{
+		uint64_t counters[COUNTER_COUNT];
+		int64_t gauges[GAUGE_COUNT];
+		int64_t peaks[GAUGE_COUNT];
+	};
+
+	// bResetPeaks면 최대값을 현재 값으로 되돌림, 동시에 쓰는 스레드가 있으면 그 틱의 최대값은 남을 수 있음
+	void Collect(Totals& outTotals, const bool bResetPeaks);
+
+	const char* GetCounterName(const ECounter counter);
+	const char* GetGaugeName(const EGauge gauge);
+
+	// interval마다 합계와 초당 증가량을 한 줄로 출력, pPath가 nullptr이면 stdout
+	class Dumper
+	{
+	public:
+		Dumper();
+
+		Dumper(const Dumper&) = delete;
+		Dumper& operator=(const Dumper&) = delete;
+
+		// 파일을 열지 못하면 false, interval이 0 이하면 출력하지 않음
+		bool Initialize(const char* pPath, const double interval, const double now);
+
+		// 출력했으면 true, 호출한 쪽이 같은 스트림에 연결별 줄을 이어서 쓸 수 있음
+		bool Update(const double now);
+
+		// 다음 출력 시각, 출력하지 않으면 음수
+		double GetNextDumpTime() const
+		{
+			return mInterval > 0.0 ? mLastDumpTime + mInterval : -1.0;
+		}
+
+		std::ostream& GetStream()
+		{
+			return mFile.is_open() ? static_cast<std::ostream&>(mFile) : *mpConsole;
+		}
+
+	private:
+		std::ofstream mFile;
+		std::ostream* mpConsole;
+
+		double mInterval;
+		double mStartTime;
+		double mLastDumpTime;
+
+		Totals mLastTotals;
+	};
+
+	// 연결 하나의 카운터를 Dumper와 같은 형식으로 출력
+	void WriteConnection(std::ostream& stream, const uint32_t id, const ConnectionCounters& connection);
+}
@@ -0,0 +1,224 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "Impairment.h"
+#include "Protocol.h"
+#include "Simulation.h"
+
+using Simulation::Float2;
+
+// 손실, 중복, 순서 바뀜이 있는 편도 150ms 링크
+static Impairment::Config makeLinkConfig(const uint32_t seed)
+{
+	Impairment::Config config = {};
+	config.delay = 0.15;
+	config.jitter = 0.03;
+	config.lossRate = 0.1;
+	config.duplicateRate = 0.02;
+	config.reorderRate = 0.05;
+	config.reorderDelay = 0.05;
+	config.seed = seed;
+
+	return config;
+}
+
+static float getDistance(const Float2& a, const Float2& b)
+{
+	const float dx = a.x - b.x;
+	const float dy = a.y - b.y;
+
+	return std::sqrt(dx * dx + dy * dy);
+}
+
+// 봇처럼 무작위 방향키를 몇 틱씩 유지, 가끔 손을 뗌
+static uint8_t nextInput(uint32_t& random, uint8_t& input, uint32_t& ticksLeft)
+{
+	if (ticksLeft == 0)
+	{
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+
+		input = (random & 0x30) == 0 ? static_cast<uint8_t>(Simulation::INPUT_NONE) : static_cast<uint8_t>(random & 0x0f);
+		ticksLeft = 1 + (random >> 8) % 60;
+	}
+
+	--ticksLeft;
+
+	return input;
+}
+
+struct Result
+{
+	// 보정할 때마다 잰 예측 오차 중 최대
+	float maxError;
+
+	// 입력을 멈추고 링크를 비운 뒤 예측 위치와 서버 위치의 거리
+	float finalError;
+
+	// 확인 안 된 입력 중 움직이는 입력 수, 빈 입력은 왕복 시간만큼 계속 남아 있음
+	size_t pendingMoveCount;
+	uint64_t lostCount;
+};
+
+// App의 클라이언트(InputPrediction)와 Server.cpp의 applyInputs를 링크 두 개로 이어서 tickCount틱 진행
+static Result run(const uint32_t tickCount, const uint32_t seed)
+{
+	Impairment::Link clientToServer(makeLinkConfig(seed));
+	Impairment::Link serverToClient(makeLinkConfig(seed + 1));
+
+	const Float2 spawn = { 0.f, 0.f };
+
+	Simulation::InputPrediction prediction;
+	Float2 predictedPos = spawn;
+
+	Float2 serverPos = spawn;
+	bool bServerInputReceived = false;
+	uint32_t serverLastInputTick = 0;
+
+	uint32_t random = seed | 1;
+	uint8_t input = Simulation::INPUT_NONE;
+	uint32_t ticksLeft = 0;
+
+	// 마지막 1초는 입력 없이 돌려서 보낸 입력이 모두 확인되게 함
+	const uint32_t settleTicks = Simulation::TICK_RATE_HZ;
+
+	for (uint32_t tick = 1; tick <= tickCount + settleTicks; ++tick)
+	{
+		const double now = tick * Simulation::TICK_INTERVAL;
+		uint8_t message[Protocol::MAX_MESSAGE_SIZE];
+
+		// 클라이언트: 바로 적용하고 확인 안 된 입력을 모두 겹쳐 보냄 (App의 writeStateMessages)
+		const uint8_t tickInput = tick <= tickCount ? nextInput(random, input, ticksLeft) : static_cast<uint8_t>(Simulation::INPUT_NONE);
+		predictedPos = prediction.PushInput(tick, tickInput, predictedPos);
+
+		uint8_t pendingInputs[Simulation::InputPrediction::MAX_PENDING_INPUTS];
+		const size_t pendingCount = prediction.GetPendingCount();
+		for (size_t i = 0; i < pendingCount; ++i)
+		{
+			pendingInputs[i] = prediction.GetPendingInput(i);
+		}
+
+		Protocol::InputPayload inputPayload;
+		Protocol::EncodeInputs(pendingInputs, pendingCount, pendingCount > 0 ? prediction.GetNewestTick() : tick, inputPayload);
+
+		const size_t inputSize = Protocol::WriteMessage(message, sizeof(message), Protocol::MSG_INPUT, 0, tick, &inputPayload, Protocol::GetInputPayloadSize(inputPayload));
+		clientToServer.Push(message, inputSize, now);
+
+		// 서버: 아직 적용하지 않은 틱의 입력만 순서대로 적용 (Server.cpp의 applyInputs)
+		clientToServer.ForEachArrived(now, [&](const uint8_t* pData, const size_t size)
+		{
+			Protocol::MessageView view;
+			size_t length;
+			Protocol::InputPayload payload;
+			if (Protocol::ParseMessage(pData, size, view, length) != Protocol::PARSE_OK || !Protocol::ReadInputPayload(view, payload))
+			{
+				return;
+			}
+
+			Protocol::ForEachInput(payload, [&](const uint32_t inputTick, const uint8_t received)
+			{
+				if (bServerInputReceived && inputTick <= serverLastInputTick)
+				{
+					return;
+				}
+
+				serverPos = Simulation::ApplyInput(serverPos, received);
+				serverLastInputTick = inputTick;
+				bServerInputReceived = true;
+			});
+		});
+
+		// 서버는 매 틱 마지막으로 적용한 입력의 틱과 위치를 보냄
+		if (bServerInputReceived)
+		{
+			Protocol::PlayerStatePayload state;
+			state.lastInputTick = serverLastInputTick;
+			Protocol::EncodePosition(serverPos.x, serverPos.y, state.pos);
+
+			const size_t stateSize = Protocol::WriteMessage(message, sizeof(message), Protocol::MSG_PLAYER_STATE, 0, tick, &state, sizeof(state));
+			serverToClient.Push(message, stateSize, now);
+		}
+
+		// 클라이언트: 서버 위치 위에 확인 안 된 입력을 다시 적용
+		serverToClient.ForEachArrived(now, [&](const uint8_t* pData, const size_t size)
+		{
+			Protocol::MessageView view;
+			size_t length;
+			Protocol::PlayerStatePayload state;
+			if (Protocol::ParseMessage(pData, size, view, length) != Protocol::PARSE_OK || view.payloadSize != sizeof(state))
+			{
+				return;
+			}
+
+			memcpy(&state, view.pPayload, sizeof(state));
+
+			Float2 authoritativePos;
+			Protocol::DecodePosition(state.pos, authoritativePos.x, authoritativePos.y);
+
+			predictedPos = prediction.Reconcile(state.lastInputTick, authoritativePos, predictedPos);
+		});
+	}
+
+	Result result;
+	result.maxError = prediction.GetMaxError();
+	result.finalError = getDistance(predictedPos, serverPos);
+	result.pendingMoveCount = 0;
+	for (size_t i = 0; i < prediction.GetPendingCount(); ++i)
+	{
+		result.pendingMoveCount += prediction.GetPendingInput(i) != Simulation::INPUT_NONE ? 1 : 0;
+	}
+
+	result.lostCount = clientToServer.GetLostCount() + serverToClient.GetLostCount();
+
+	return result;
+}
+
+// 클라이언트 예측과 서버 보정을 손실/지연 링크로 돌려서 보정 오차가 양자화 오차 수준인지 확인
+// 입력을 겹쳐 보내므로 손실이 있어도 서버와 클라이언트가 같은 입력을 적용해야 하고
+// 서버 위치를 양자화해서 받는 만큼만 어긋나야 함 (다시 적용하지 않으면 지연 동안 움직인 거리만큼 어긋남)
+// 사용법: SimpleNetworkPredictionTest [--ticks N] [--seed N]
+// 오차가 한도를 넘으면 1을 반환
+int main(int argc, char* argv[])
+{
+	uint32_t tickCount = 60 * Simulation::TICK_RATE_HZ;
+	uint32_t seed = 1;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--ticks") == 0 && bHasValue)
+		{
+			tickCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && bHasValue)
+		{
+			seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::cerr << "usage: SimpleNetworkPredictionTest [--ticks N] [--seed N]" << std::endl;
+			return 1;
+		}
+	}
+
+	// 받은 위치와 직전 보정의 기준 위치가 각각 축마다 한 단계의 절반까지 어긋나므로 축마다 한 단계
+	const float errorBound = 2.f * std::sqrt(2.f) * Protocol::POSITION_MAX_ERROR;
+
+	const Result result = run(tickCount, seed);
+
+	const bool bPassed = result.maxError <= errorBound && result.finalError <= errorBound && result.pendingMoveCount == 0;
+
+	std::cout << "prediction over 150 ms lossy link: " << tickCount << " ticks, " << result.lostCount << " packets lost"
+		<< " | max correction " << result.maxError
+		<< " | final error " << result.finalError
+		<< " | bound " << errorBound
+		<< " | unacked moves " << result.pendingMoveCount
+		<< " | " << (bPassed ? "ok" : "FAILED") << std::endl;
+
+	return bPassed ? 0 : 1;
+}
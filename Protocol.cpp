@@ -0,0 +1,239 @@
+#include "Protocol.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace Protocol
+{
+	uint32_t QuantizeCoord(const float value, const unsigned bits)
+	{
+		assert(bits >= 1 && bits <= 24);
+
+		const uint32_t maxQuantized = (1u << bits) - 1;
+
+		// NaN은 비교가 모두 거짓이라 그대로 두면 정수 변환이 정의되지 않음, POSITION_MIN으로 보냄
+		float clamped = value >= POSITION_MIN ? value : POSITION_MIN;
+		clamped = clamped > POSITION_MAX ? POSITION_MAX : clamped;
+
+		const double normalized = (static_cast<double>(clamped) - POSITION_MIN) / (POSITION_MAX - POSITION_MIN);
+
+		return static_cast<uint32_t>(normalized * maxQuantized + 0.5);
+	}
+
+	float DequantizeCoord(const uint32_t quantized, const unsigned bits)
+	{
+		const uint32_t maxQuantized = (1u << bits) - 1;
+
+		return static_cast<float>(POSITION_MIN + (static_cast<double>(POSITION_MAX) - POSITION_MIN) * quantized / maxQuantized);
+	}
+
+	void EncodePosition(const float x, const float y, PositionPayload& outPayload)
+	{
+		const uint64_t packed = static_cast<uint64_t>(QuantizeCoord(x, POSITION_BITS))
+			| (static_cast<uint64_t>(QuantizeCoord(y, POSITION_BITS)) << POSITION_BITS);
+
+		for (int i = 0; i < POSITION_PAYLOAD_SIZE; ++i)
+		{
+			outPayload.data[i] = static_cast<uint8_t>(packed >> (8 * i));
+		}
+	}
+
+	void DecodePosition(const PositionPayload& payload, float& outX, float& outY)
+	{
+		uint64_t packed = 0;
+		for (int i = 0; i < POSITION_PAYLOAD_SIZE; ++i)
+		{
+			packed |= static_cast<uint64_t>(payload.data[i]) << (8 * i);
+		}
+
+		const uint32_t mask = (1u << POSITION_BITS) - 1;
+
+		outX = DequantizeCoord(static_cast<uint32_t>(packed) & mask, POSITION_BITS);
+		outY = DequantizeCoord(static_cast<uint32_t>(packed >> POSITION_BITS) & mask, POSITION_BITS);
+	}
+
+	size_t EncodeInputs(const uint8_t* pInputs, const size_t count, const uint32_t lastTick, InputPayload& outPayload)
+	{
+		// 최신 입력부터 거꾸로 묶은 뒤 순서를 뒤집음
+		uint8_t runs[MAX_INPUT_RUNS];
+		uint8_t runCount = 0;
+		size_t encodedCount = 0;
+
+		while (encodedCount < count && runCount < MAX_INPUT_RUNS)
+		{
+			const uint8_t input = pInputs[count - 1 - encodedCount] & INPUT_MASK;
+
+			size_t runLength = 1;
+			while (runLength < MAX_INPUT_RUN_LENGTH && encodedCount + runLength < count
+				&& (pInputs[count - 1 - encodedCount - runLength] & INPUT_MASK) == input)
+			{
+				++runLength;
+			}
+
+			runs[runCount++] = static_cast<uint8_t>(((runLength - 1) << INPUT_MASK_BITS) | input);
+			encodedCount += runLength;
+		}
+
+		outPayload.lastTick = lastTick;
+		outPayload.runCount = runCount;
+		for (uint8_t i = 0; i < runCount; ++i)
+		{
+			outPayload.runs[i] = runs[runCount - 1 - i];
+		}
+
+		return encodedCount;
+	}
+
+	size_t GetEncodableInputCount(const uint8_t* pInputs, const size_t count)
+	{
+		// 같은 입력이 이어진 구간마다 16틱씩 나누므로 어느 쪽부터 묶어도 run 수는 같음
+		size_t runCount = 0;
+		size_t index = 0;
+
+		while (index < count && runCount < MAX_INPUT_RUNS)
+		{
+			const uint8_t input = pInputs[index] & INPUT_MASK;
+
+			size_t runLength = 1;
+			while (runLength < MAX_INPUT_RUN_LENGTH && index + runLength < count && (pInputs[index + runLength] & INPUT_MASK) == input)
+			{
+				++runLength;
+			}
+
+			index += runLength;
+			++runCount;
+		}
+
+		return index;
+	}
+
+	bool ReadInputPayload(const MessageView& message, InputPayload& outPayload)
+	{
+		const size_t headerSize = offsetof(InputPayload, runs);
+		if (message.payloadSize < headerSize || message.payloadSize > sizeof(outPayload))
+		{
+			return false;
+		}
+
+		memcpy(&outPayload, message.pPayload, message.payloadSize);
+		if (message.payloadSize != GetInputPayloadSize(outPayload))
+		{
+			return false;
+		}
+
+		// 0틱 이전까지 거슬러 올라가는 입력은 잘못된 것
+		uint32_t tickCount = 0;
+		for (uint8_t i = 0; i < outPayload.runCount; ++i)
+		{
+			tickCount += (outPayload.runs[i] >> INPUT_MASK_BITS) + 1;
+		}
+
+		return tickCount <= outPayload.lastTick + 1ull;
+	}
+
+	size_t WriteMessage(
+		uint8_t* pOutBuffer,
+		const size_t bufferSize,
+		const EMessageType type,
+		const uint32_t sequence,
+		const uint32_t tick,
+		const void* pPayload,
+		const size_t payloadSize
+	)
+	{
+		const size_t length = sizeof(MessageHeader) + payloadSize;
+		if (length > bufferSize || length > MAX_MESSAGE_SIZE)
+		{
+			return 0;
+		}
+
+		MessageHeader header;
+		header.type = type;
+		header.length = static_cast<uint16_t>(length);
+		header.sequence = sequence;
+		header.tick = tick;
+
+		memcpy(pOutBuffer, &header, sizeof(header));
+		if (payloadSize > 0)
+		{
+			memcpy(pOutBuffer + sizeof(header), pPayload, payloadSize);
+		}
+
+		return length;
+	}
+
+	EParseResult ParseMessage(const uint8_t* pData, const size_t size, MessageView& outMessage, size_t& outLength)
+	{
+		if (size < sizeof(MessageHeader))
+		{
+			return PARSE_INCOMPLETE;
+		}
+
+		memcpy(&outMessage.header, pData, sizeof(MessageHeader));
+
+		const size_t length = outMessage.header.length;
+		if (length < sizeof(MessageHeader) || length > MAX_MESSAGE_SIZE
+			|| outMessage.header.type == MSG_INVALID || outMessage.header.type >= MSG_TYPE_COUNT)
+		{
+			return PARSE_ERROR;
+		}
+
+		if (size < length)
+		{
+			return PARSE_INCOMPLETE;
+		}
+
+		outMessage.pPayload = pData + sizeof(MessageHeader);
+		outMessage.payloadSize = length - sizeof(MessageHeader);
+		outLength = length;
+
+		return PARSE_OK;
+	}
+
+	StreamBuffer::StreamBuffer(const size_t capacity)
+		: mBuffer(new uint8_t[capacity])
+		, mCapacity(capacity)
+		, mReadOffset(0)
+		, mWriteOffset(0)
+	{
+		assert(capacity >= 2 * MAX_MESSAGE_SIZE);
+	}
+
+	void StreamBuffer::Compact()
+	{
+		// 매번 옮기지 않도록 뒤쪽 공간이 모자랄 때만
+		if (mCapacity - mWriteOffset < MAX_MESSAGE_SIZE)
+		{
+			const size_t pendingSize = GetPendingSize();
+			memmove(mBuffer.get(), mBuffer.get() + mReadOffset, pendingSize);
+
+			mReadOffset = 0;
+			mWriteOffset = pendingSize;
+		}
+	}
+
+	void StreamBuffer::CommitWrite(const size_t size)
+	{
+		assert(mWriteOffset + size <= mCapacity);
+		mWriteOffset += size;
+	}
+
+	EParseResult StreamBuffer::Parse(MessageView& outMessage)
+	{
+		size_t length;
+		const EParseResult result = ParseMessage(mBuffer.get() + mReadOffset, GetPendingSize(), outMessage, length);
+		if (result != PARSE_OK)
+		{
+			return result;
+		}
+
+		mReadOffset += length;
+		if (mReadOffset == mWriteOffset)
+		{
+			mReadOffset = 0;
+			mWriteOffset = 0;
+		}
+
+		return PARSE_OK;
+	}
+}
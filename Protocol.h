@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 위치 양자화 축당 비트 수 (2 ~ 24)
+// 16비트면 [-1, 1]에서 오차 1.5e-5로, 배경 한 픽셀(0.25 / 1280 = 1.95e-4)보다 훨씬 작음
+#ifndef POSITION_BITS
+#define POSITION_BITS (16)
+#endif
+
+// 와이어 포맷은 리틀 엔디언 (x86/x64 클라이언트와 서버 모두 해당)
+namespace Protocol
+{
+	static_assert(POSITION_BITS >= 2 && POSITION_BITS <= 24, "POSITION_BITS must be in [2, 24]");
+
+	enum
+	{
+		POSITION_PAYLOAD_SIZE = (2 * POSITION_BITS + 7) / 8
+	};
+
+	// 셰이더가 clamp하는 범위와 같음
+	constexpr float POSITION_MIN = -1.f;
+	constexpr float POSITION_MAX = 1.f;
+
+	// 최대 양자화 오차 (한 단계의 절반)
+	constexpr float POSITION_MAX_ERROR = (POSITION_MAX - POSITION_MIN) / ((1u << POSITION_BITS) - 1) * 0.5f;
+
+	enum EMessageType : uint16_t
+	{
+		MSG_INVALID = 0,
+		MSG_POSITION,
+
+		// 전용 서버 -> 클라이언트, 다른 플레이어 위치
+		MSG_ENTITY_POSITION,
+
+		// 클라이언트 -> 서버, 아직 ack 안 된 최근 입력들
+		MSG_INPUT,
+
+		// 서버 -> 클라이언트, 입력을 적용한 클라이언트 자신의 위치
+		MSG_PLAYER_STATE,
+
+		// 지연 측정, 받은 쪽은 보낸 시각을 그대로 MSG_PONG에 담아 돌려줌
+		MSG_PING,
+		MSG_PONG,
+
+		// 전용 서버 -> 클라이언트, 마지막으로 ack된 스냅샷 대비 바뀐 엔티티 (Snapshot.h)
+		// 크면 여러 메시지로 나눠 보내고 마지막 메시지에 SNAPSHOT_LAST_CHUNK 표시
+		MSG_SNAPSHOT,
+
+		// 클라이언트 -> 전용 서버, 다 받은 스냅샷의 틱
+		MSG_SNAPSHOT_ACK,
+
+		// 롤백 모드에서 양쪽이 MSG_INPUT과 함께 보냄, 다음에 필요한 상대 입력의 틱 (Rollback.h)
+		MSG_INPUT_ACK,
+
+		// 여기부터는 신뢰성 채널로 전송
+		MSG_JOIN,
+		MSG_LEAVE,
+		MSG_OVERLAP,
+
+		// 전용 서버 -> 접속한 클라이언트, 자신의 엔티티 ID
+		MSG_WELCOME,
+
+		MSG_TYPE_COUNT
+	};
+
+	inline bool IsReliableMessage(const uint16_t type)
+	{
+		return type >= MSG_JOIN && type < MSG_TYPE_COUNT;
+	}
+
+#pragma pack(push, 1)
+	struct MessageHeader
+	{
+		uint16_t type;
+
+		// 헤더를 포함한 메시지 전체 길이
+		uint16_t length;
+
+		uint32_t sequence;
+		uint32_t tick;
+	};
+
+	// x, y를 각각 POSITION_BITS로 양자화해서 비트 단위로 이어 붙임
+	struct PositionPayload
+	{
+		uint8_t data[POSITION_PAYLOAD_SIZE];
+	};
+
+	struct EntityPositionPayload
+	{
+		uint32_t entityId;
+		PositionPayload pos;
+	};
+
+	enum
+	{
+		// run 한 바이트: 하위 4비트는 방향키 비트(Simulation::EInput), 상위 4비트는 같은 입력이 이어진 틱 수 - 1
+		INPUT_MASK_BITS = 4,
+		INPUT_MASK = (1 << INPUT_MASK_BITS) - 1,
+		MAX_INPUT_RUN_LENGTH = 1 << (8 - INPUT_MASK_BITS),
+
+		// 입력 메시지 하나에 싣는 최대 run 수, 손실 대비로 최근 입력을 겹쳐서 보냄
+		MAX_INPUT_RUNS = 32
+	};
+
+	// runs를 순서대로 풀면 lastTick에서 끝나는 연속된 틱들의 입력, runCount개만 전송
+	struct InputPayload
+	{
+		uint32_t lastTick;
+		uint8_t runCount;
+		uint8_t runs[MAX_INPUT_RUNS];
+	};
+
+	struct InputAckPayload
+	{
+		uint32_t nextTick;
+	};
+
+	struct PlayerStatePayload
+	{
+		// 서버가 마지막으로 적용한 입력의 틱
+		uint32_t lastInputTick;
+		PositionPayload pos;
+	};
+
+	struct PingPayload
+	{
+		// 보낸 쪽 단조 시계 기준 시각(us)
+		uint64_t sendTime;
+	};
+
+	// 헤더의 tick은 pong을 보낼 때 보낸 쪽의 틱
+	struct PongPayload
+	{
+		// 받은 MSG_PING의 sendTime
+		uint64_t pingSendTime;
+
+		// 보낸 쪽 단조 시계 기준 ping을 받은 시각과 pong을 보낸 시각(us)
+		uint64_t receiveTime;
+		uint64_t sendTime;
+
+		// 전용 서버가 직전 틱을 처리하는 데 걸린 시간(us), 부하 측정용, 1:1 호스트는 0
+		uint32_t tickTime;
+	};
+
+	enum : uint8_t
+	{
+		SNAPSHOT_LAST_CHUNK = 1 << 0
+	};
+
+	// MSG_SNAPSHOT payload 앞부분, 뒤로 바뀐 엔티티들이 이어짐
+	// 헤더의 tick이 스냅샷의 틱
+	struct SnapshotPayloadHeader
+	{
+		// 기준으로 삼은 스냅샷의 틱, Snapshot::NO_BASELINE이면 전체 스냅샷
+		uint32_t baselineTick;
+		uint8_t flags;
+	};
+
+	struct SnapshotAckPayload
+	{
+		uint32_t tick;
+	};
+
+	// 전용 서버의 MSG_JOIN, MSG_LEAVE, MSG_WELCOME
+	struct EntityPayload
+	{
+		uint32_t entityId;
+	};
+
+	struct OverlapPayload
+	{
+		uint8_t bOverlapped;
+	};
+
+	// UDP datagram 맨 앞에 붙고 뒤로 메시지들이 이어짐
+	struct PacketHeader
+	{
+		uint16_t protocolId;
+		uint16_t sequence;
+
+		// 상대에게 받은 최신 패킷 시퀀스와 그 이전 32개의 수신 여부
+		uint16_t ack;
+		uint32_t ackBits;
+	};
+#pragma pack(pop)
+	static_assert(sizeof(MessageHeader) == 12, "");
+
+	enum
+	{
+		PROTOCOL_ID = 0x4e53,
+
+		MAX_MESSAGE_SIZE = 1024,
+		STREAM_BUFFER_SIZE = 64 * 1024,
+
+		// 단편화되지 않도록 MTU보다 작게
+		MAX_PACKET_SIZE = 1200
+	};
+
+	// [POSITION_MIN, POSITION_MAX] 밖은 끝으로 clamp, NaN은 POSITION_MIN
+	uint32_t QuantizeCoord(const float value, const unsigned bits);
+	float DequantizeCoord(const uint32_t quantized, const unsigned bits);
+
+	void EncodePosition(const float x, const float y, PositionPayload& outPayload);
+	void DecodePosition(const PositionPayload& payload, float& outX, float& outY);
+
+	// 헤더를 채우고 payload를 붙여 pOutBuffer에 기록, 기록한 바이트 수 반환
+	size_t WriteMessage(
+		uint8_t* pOutBuffer,
+		const size_t bufferSize,
+		const EMessageType type,
+		const uint32_t sequence,
+		const uint32_t tick,
+		const void* pPayload,
+		const size_t payloadSize
+	);
+
+	struct MessageView
+	{
+		MessageHeader header;
+
+		// 수신 버퍼 내부를 직접 가리킴, 다음 Parse/Write 전까지만 유효
+		const uint8_t* pPayload;
+		size_t payloadSize;
+	};
+
+	enum EParseResult
+	{
+		PARSE_OK,
+		PARSE_INCOMPLETE,
+		PARSE_ERROR
+	};
+
+	// 틱별 입력 pInputs[0, count)를 최신 쪽부터 run으로 묶어 들어가는 만큼 기록, 마지막 입력이 lastTick
+	// 기록한 틱 수 반환, 보낼 크기는 GetInputPayloadSize
+	size_t EncodeInputs(const uint8_t* pInputs, const size_t count, const uint32_t lastTick, InputPayload& outPayload);
+
+	// pInputs[0, count) 중 앞쪽부터 run MAX_INPUT_RUNS개에 들어가는 틱 수
+	// 빠짐없이 오래된 틱부터 보내야 할 때 이만큼만 EncodeInputs에 넘김
+	size_t GetEncodableInputCount(const uint8_t* pInputs, const size_t count);
+
+	inline size_t GetInputPayloadSize(const InputPayload& payload)
+	{
+		return offsetof(InputPayload, runs) + payload.runCount;
+	}
+
+	// 받은 MSG_INPUT의 크기와 run을 확인하고 복사, 잘못된 형식이면 false
+	bool ReadInputPayload(const MessageView& message, InputPayload& outPayload);
+
+	// payload에 담긴 입력을 오래된 틱부터 onInput(tick, input)으로 넘김
+	template <class Callback>
+	void ForEachInput(const InputPayload& payload, Callback onInput)
+	{
+		uint32_t tickCount = 0;
+		for (uint8_t i = 0; i < payload.runCount; ++i)
+		{
+			tickCount += (payload.runs[i] >> INPUT_MASK_BITS) + 1;
+		}
+
+		uint32_t tick = payload.lastTick - tickCount + 1;
+		for (uint8_t i = 0; i < payload.runCount; ++i)
+		{
+			const uint8_t input = payload.runs[i] & INPUT_MASK;
+			const uint32_t runLength = (payload.runs[i] >> INPUT_MASK_BITS) + 1u;
+
+			for (uint32_t j = 0; j < runLength; ++j)
+			{
+				onInput(tick++, input);
+			}
+		}
+	}
+
+	// pData에서 메시지 하나를 복사 없이 파싱, 성공 시 outLength에 메시지 길이
+	EParseResult ParseMessage(const uint8_t* pData, const size_t size, MessageView& outMessage, size_t& outLength);
+
+	// TCP 스트림을 메시지 단위로 재조립
+	class StreamBuffer
+	{
+	public:
+		explicit StreamBuffer(const size_t capacity = STREAM_BUFFER_SIZE);
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		// 뒤쪽 공간이 메시지 하나보다 작으면 남은 조각을 앞으로 당김, 채우기 전에 호출
+		void Compact();
+
+		// recv로 바로 채울 위치와 크기, 버퍼를 바꾸지 않으므로 한 식에서 같이 불러도 됨
+		uint8_t* GetWritePtr()
+		{
+			return mBuffer.get() + mWriteOffset;
+		}
+
+		size_t GetWritableSize() const
+		{
+			return mCapacity - mWriteOffset;
+		}
+
+		void CommitWrite(const size_t size);
+
+		// 완성된 메시지가 있으면 복사 없이 버퍼 안에서 파싱하고 소비
+		EParseResult Parse(MessageView& outMessage);
+
+		size_t GetPendingSize() const
+		{
+			return mWriteOffset - mReadOffset;
+		}
+
+	private:
+		std::unique_ptr<uint8_t[]> mBuffer;
+		size_t mCapacity;
+		size_t mReadOffset;
+		size_t mWriteOffset;
+	};
+}
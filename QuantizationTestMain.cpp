@@ -0,0 +1,142 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+#include "Protocol.h"
+
+enum
+{
+	// 비트 수마다 [-1, 1]에서 고르게 뽑는 값 수
+	SWEEP_SAMPLE_COUNT = 1 << 20,
+
+	MIN_BITS = 2,
+	MAX_BITS = 24
+};
+
+// 복원 값이 float로 반올림되는 만큼 여유를 둠, 24비트에서는 한 단계의 절반과 비슷한 크기
+static double getTolerance(const unsigned bits)
+{
+	const double step = (static_cast<double>(Protocol::POSITION_MAX) - Protocol::POSITION_MIN) / ((1u << bits) - 1);
+
+	return step * 0.5 + std::numeric_limits<float>::epsilon() * 0.5;
+}
+
+// |x - dequant(quant(x))|가 한 단계의 절반 이하인지, 어긋난 값 수 반환
+static uint64_t checkRoundTrip(const unsigned bits)
+{
+	const double tolerance = getTolerance(bits);
+
+	uint64_t failureCount = 0;
+	double maxError = 0.0;
+
+	for (uint32_t i = 0; i <= SWEEP_SAMPLE_COUNT; ++i)
+	{
+		const float value = static_cast<float>(Protocol::POSITION_MIN + (static_cast<double>(Protocol::POSITION_MAX) - Protocol::POSITION_MIN) * i / SWEEP_SAMPLE_COUNT);
+		const uint32_t quantized = Protocol::QuantizeCoord(value, bits);
+		const double error = std::fabs(static_cast<double>(value) - Protocol::DequantizeCoord(quantized, bits));
+
+		maxError = error > maxError ? error : maxError;
+
+		if (quantized >= (1u << bits) || error > tolerance)
+		{
+			if (failureCount == 0)
+			{
+				std::cerr << bits << " bits: " << value << " -> " << quantized << ", error " << error << " > " << tolerance << std::endl;
+			}
+
+			++failureCount;
+		}
+	}
+
+	std::cout << bits << " bits: max error " << maxError << ", bound " << tolerance << std::endl;
+
+	return failureCount;
+}
+
+// 범위 밖과 NaN, 무한대는 끝 값으로
+static uint64_t checkOutOfRange(const unsigned bits)
+{
+	const uint32_t maxQuantized = (1u << bits) - 1;
+
+	const struct
+	{
+		float value;
+		uint32_t expected;
+	} cases[] =
+	{
+		{ Protocol::POSITION_MIN, 0 },
+		{ Protocol::POSITION_MAX, maxQuantized },
+		{ -1.5f, 0 },
+		{ 2.f, maxQuantized },
+		{ -std::numeric_limits<float>::infinity(), 0 },
+		{ std::numeric_limits<float>::infinity(), maxQuantized },
+		{ std::numeric_limits<float>::quiet_NaN(), 0 },
+		{ -std::numeric_limits<float>::quiet_NaN(), 0 }
+	};
+
+	uint64_t failureCount = 0;
+	for (const auto& testCase : cases)
+	{
+		const uint32_t quantized = Protocol::QuantizeCoord(testCase.value, bits);
+		if (quantized != testCase.expected)
+		{
+			std::cerr << bits << " bits: " << testCase.value << " -> " << quantized << ", expected " << testCase.expected << std::endl;
+			++failureCount;
+		}
+	}
+
+	return failureCount;
+}
+
+// 허용하는 모든 비트 수에서 위치 양자화의 복원 오차와 범위 밖 값 처리 확인
+// 빌드에 설정된 POSITION_BITS는 EncodePosition/DecodePosition과 POSITION_MAX_ERROR도 확인
+// 사용법: SimpleNetworkQuantizationTest
+// 어긋난 값이 하나라도 있으면 1을 반환
+int main()
+{
+	uint64_t failureCount = 0;
+
+	for (unsigned bits = MIN_BITS; bits <= MAX_BITS; ++bits)
+	{
+		failureCount += checkRoundTrip(bits);
+		failureCount += checkOutOfRange(bits);
+	}
+
+	// 전송에 쓰는 값: EncodePosition/DecodePosition을 거쳐도 POSITION_MAX_ERROR 안
+	for (uint32_t i = 0; i <= SWEEP_SAMPLE_COUNT; i += 97)
+	{
+		const float x = static_cast<float>(-1.0 + 2.0 * i / SWEEP_SAMPLE_COUNT);
+		const float y = -x * 0.5f;
+
+		Protocol::PositionPayload payload;
+		Protocol::EncodePosition(x, y, payload);
+
+		float decodedX;
+		float decodedY;
+		Protocol::DecodePosition(payload, decodedX, decodedY);
+
+		const double bound = getTolerance(POSITION_BITS);
+		if (std::fabs(static_cast<double>(x) - decodedX) > bound || std::fabs(static_cast<double>(y) - decodedY) > bound)
+		{
+			if (failureCount == 0)
+			{
+				std::cerr << "position (" << x << ", " << y << ") decoded as (" << decodedX << ", " << decodedY << ")" << std::endl;
+			}
+
+			++failureCount;
+		}
+	}
+
+	// 다른 곳에서 오차 한도로 쓰는 상수가 실제 한 단계의 절반과 같은지
+	const double halfStep = (static_cast<double>(Protocol::POSITION_MAX) - Protocol::POSITION_MIN) / ((1u << POSITION_BITS) - 1) * 0.5;
+	if (std::fabs(Protocol::POSITION_MAX_ERROR - halfStep) > halfStep * 1e-6)
+	{
+		std::cerr << "POSITION_MAX_ERROR " << Protocol::POSITION_MAX_ERROR << " is not half a step (" << halfStep << ")" << std::endl;
+		++failureCount;
+	}
+
+	std::cout << "quantization: " << failureCount << " failures (POSITION_BITS " << POSITION_BITS << ")" << std::endl;
+
+	return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+#include "Rollback.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace Rollback
+{
+	int32_t ToFixed(const float value)
+	{
+		const float scaled = value * FIXED_ONE;
+
+		return static_cast<int32_t>(scaled < 0.f ? scaled - 0.5f : scaled + 0.5f);
+	}
+
+	GameState MakeInitialState(const Simulation::Float2 positions[PLAYER_COUNT])
+	{
+		GameState state;
+		state.tick = 0;
+
+		for (int i = 0; i < PLAYER_COUNT; ++i)
+		{
+			state.x[i] = ToFixed(positions[i].x);
+			state.y[i] = ToFixed(positions[i].y);
+		}
+
+		return state;
+	}
+
+	Simulation::Float2 GetPosition(const GameState& state, const int player)
+	{
+		return { static_cast<float>(state.x[player]) / FIXED_ONE, static_cast<float>(state.y[player]) / FIXED_ONE };
+	}
+
+	static int32_t clampToWorld(const int32_t value)
+	{
+		return value < -FIXED_ONE ? -FIXED_ONE : (value > FIXED_ONE ? FIXED_ONE : value);
+	}
+
+	void Step(GameState& state, const uint8_t inputs[PLAYER_COUNT])
+	{
+		using namespace Simulation;
+
+		for (int i = 0; i < PLAYER_COUNT; ++i)
+		{
+			const uint8_t input = inputs[i];
+
+			// 배경 텍스처 기준이라 위쪽이 -y
+			const int32_t dx = ((input & INPUT_RIGHT) != 0 ? FIXED_DELTA_DIST : 0) - ((input & INPUT_LEFT) != 0 ? FIXED_DELTA_DIST : 0);
+			const int32_t dy = ((input & INPUT_DOWN) != 0 ? FIXED_DELTA_DIST : 0) - ((input & INPUT_UP) != 0 ? FIXED_DELTA_DIST : 0);
+
+			state.x[i] = clampToWorld(state.x[i] + dx);
+			state.y[i] = clampToWorld(state.y[i] + dy);
+		}
+
+		++state.tick;
+	}
+
+	uint32_t GetChecksum(const GameState& state)
+	{
+		uint8_t bytes[sizeof(GameState)];
+		memcpy(bytes, &state, sizeof(bytes));
+
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < sizeof(bytes); ++i)
+		{
+			hash = (hash ^ bytes[i]) * 16777619u;
+		}
+
+		return hash;
+	}
+
+	Session::Session(const int localPlayer, const GameState& initialState, const uint32_t inputDelay)
+		: mLocalPlayer(localPlayer)
+		, mState(initialState)
+		, mSavedStates()
+		, mLocalInputs()
+		, mRemoteInputs()
+		, mUsedRemoteInputs()
+		, mLocalInputEnd(initialState.tick + inputDelay)
+		, mRemoteInputEnd(initialState.tick)
+		, mbMispredicted(false)
+		, mFirstMispredictedTick(0)
+		, mRollbackCount(0)
+		, mResimulatedFrameCount(0)
+		, mMaxRollbackFrames(0)
+	{
+		assert(localPlayer >= 0 && localPlayer < PLAYER_COUNT);
+		assert(inputDelay <= MAX_INPUT_DELAY);
+
+		// 입력 지연 동안의 틱은 mLocalInputs()로 0(입력 없음)이 들어가 있음
+	}
+
+	void Session::AdvanceFrame(const uint8_t localInput)
+	{
+		assert(CanAdvance());
+
+		Synchronize();
+
+		mLocalInputs[mLocalInputEnd % HISTORY_SIZE] = localInput;
+		++mLocalInputEnd;
+
+		simulate();
+	}
+
+	void Session::Synchronize()
+	{
+		if (!mbMispredicted)
+		{
+			return;
+		}
+
+		mbMispredicted = false;
+
+		const uint32_t frameCount = mState.tick - mFirstMispredictedTick;
+		mState = mSavedStates[mFirstMispredictedTick % HISTORY_SIZE];
+
+		for (uint32_t i = 0; i < frameCount; ++i)
+		{
+			simulate();
+		}
+
+		++mRollbackCount;
+		mResimulatedFrameCount += frameCount;
+		mMaxRollbackFrames = frameCount > mMaxRollbackFrames ? frameCount : mMaxRollbackFrames;
+	}
+
+	void Session::AddRemoteInput(const uint32_t tick, const uint8_t input)
+	{
+		// 아직 다시 시뮬레이션할 수 있는 틱의 입력을 덮어쓰지 않도록 너무 앞선 입력도 무시
+		if (tick != mRemoteInputEnd || tick >= mState.tick + (HISTORY_SIZE - MAX_PREDICTION_FRAMES))
+		{
+			return;
+		}
+
+		mRemoteInputs[tick % HISTORY_SIZE] = input;
+		++mRemoteInputEnd;
+
+		// 순서대로만 받으므로 처음 틀린 틱이 가장 이른 틱
+		if (tick < mState.tick && !mbMispredicted && mUsedRemoteInputs[tick % HISTORY_SIZE] != input)
+		{
+			mbMispredicted = true;
+			mFirstMispredictedTick = tick;
+		}
+	}
+
+	uint8_t Session::GetLocalInput(const uint32_t tick) const
+	{
+		assert(tick < mLocalInputEnd && mLocalInputEnd - tick <= HISTORY_SIZE);
+
+		return mLocalInputs[tick % HISTORY_SIZE];
+	}
+
+	void Session::simulate()
+	{
+		const uint32_t tick = mState.tick;
+		const size_t index = tick % HISTORY_SIZE;
+
+		mSavedStates[index] = mState;
+
+		// 확정 입력이 없으면 마지막 확정 입력이 이어진다고 예측
+		uint8_t remoteInput = Simulation::INPUT_NONE;
+		if (tick < mRemoteInputEnd)
+		{
+			remoteInput = mRemoteInputs[index];
+		}
+		else if (mRemoteInputEnd > 0)
+		{
+			remoteInput = mRemoteInputs[(mRemoteInputEnd - 1) % HISTORY_SIZE];
+		}
+
+		mUsedRemoteInputs[index] = remoteInput;
+
+		uint8_t inputs[PLAYER_COUNT];
+		inputs[mLocalPlayer] = mLocalInputs[index];
+		inputs[1 - mLocalPlayer] = remoteInput;
+
+		Step(mState, inputs);
+	}
+}
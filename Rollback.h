@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Simulation.h"
+
+// 1:1 롤백 (GGPO 방식)
+// 양쪽이 입력만 주고받고 같은 시뮬레이션을 돌림, 상대 입력이 아직 없으면 마지막 입력이 이어진다고 예측하고
+// 실제 입력이 예측과 다르면 그 틱의 상태로 되돌려 현재 틱까지 다시 시뮬레이션
+namespace Rollback
+{
+	enum
+	{
+		PLAYER_COUNT = 2,
+
+		// 상대 입력 없이 예측으로 앞서 나갈 수 있는 최대 틱 수, 넘으면 상대 입력이 올 때까지 멈춤
+		MAX_PREDICTION_FRAMES = 16,
+
+		MAX_INPUT_DELAY = 8,
+
+		// 상태와 입력을 보관하는 틱 수 (2의 거듭제곱)
+		// 상대가 내 입력을 받지 못해 멈춰도 나는 2 * MAX_PREDICTION_FRAMES + 입력 지연까지 앞설 수 있으므로 그만큼 다시 보낼 수 있어야 함
+		HISTORY_SIZE = 64
+	};
+
+	static_assert((HISTORY_SIZE & (HISTORY_SIZE - 1)) == 0, "HISTORY_SIZE must be a power of two");
+	static_assert(HISTORY_SIZE > 2 * MAX_PREDICTION_FRAMES + MAX_INPUT_DELAY, "HISTORY_SIZE is too small");
+
+	// 고정소수점 위치, 월드 [-1, 1]이 [-FIXED_ONE, FIXED_ONE]
+	// 부동소수점은 컴파일러와 명령어(x87, FMA)에 따라 결과가 달라질 수 있어서 상태는 정수로만 계산
+	constexpr int32_t FIXED_ONE = 1 << 16;
+
+	// Simulation::DELTA_DIST에 가장 가까운 값, 60Hz면 0.1% 안쪽 차이
+	constexpr int32_t FIXED_DELTA_DIST = static_cast<int32_t>(Simulation::DELTA_DIST * FIXED_ONE + 0.5f);
+
+	// 저장/복원은 구조체 복사 한 번
+	// 패딩 없이 4바이트 정수만 둬서 체크섬을 바이트 그대로 계산
+	struct GameState
+	{
+		uint32_t tick;
+		int32_t x[PLAYER_COUNT];
+		int32_t y[PLAYER_COUNT];
+	};
+
+	static_assert(sizeof(GameState) == 4 + 8 * PLAYER_COUNT, "GameState must not have padding");
+
+	int32_t ToFixed(const float value);
+
+	GameState MakeInitialState(const Simulation::Float2 positions[PLAYER_COUNT]);
+	Simulation::Float2 GetPosition(const GameState& state, const int player);
+
+	// 한 틱 진행, Simulation::ApplyInput과 같은 규칙을 정수로 계산
+	void Step(GameState& state, const uint8_t inputs[PLAYER_COUNT]);
+
+	// 양쪽 상태 비교용 FNV-1a
+	uint32_t GetChecksum(const GameState& state);
+
+	// 한쪽 플레이어의 롤백 상태
+	class Session
+	{
+	public:
+		Session(const int localPlayer, const GameState& initialState, const uint32_t inputDelay);
+
+		// 예측으로 더 나갈 수 있으면 true, false면 이번 틱은 진행하지 않고 상대 입력을 기다림
+		bool CanAdvance() const
+		{
+			return mState.tick < mRemoteInputEnd + MAX_PREDICTION_FRAMES;
+		}
+
+		// 틀린 예측을 바로잡은 뒤 localInput을 입력 지연만큼 뒤의 틱에 넣고 한 틱 진행
+		void AdvanceFrame(const uint8_t localInput);
+
+		// 틀린 예측이 있으면 그 틱의 상태로 되돌려 현재 틱까지 다시 시뮬레이션
+		void Synchronize();
+
+		// 다음에 필요한 틱(GetRemoteInputEnd)부터 순서대로만 받고 이미 받았거나 건너뛴 틱은 무시
+		void AddRemoteInput(const uint32_t tick, const uint8_t input);
+
+		const GameState& GetState() const
+		{
+			return mState;
+		}
+
+		int GetLocalPlayer() const
+		{
+			return mLocalPlayer;
+		}
+
+		// 상대 입력은 이 틱 전까지 확정, 여기부터는 예측
+		uint32_t GetRemoteInputEnd() const
+		{
+			return mRemoteInputEnd;
+		}
+
+		// 입력 지연만큼 앞서 들어간 로컬 입력의 끝
+		uint32_t GetLocalInputEnd() const
+		{
+			return mLocalInputEnd;
+		}
+
+		// [GetLocalInputEnd() - HISTORY_SIZE, GetLocalInputEnd()) 범위만 유효
+		uint8_t GetLocalInput(const uint32_t tick) const;
+
+		uint64_t GetRollbackCount() const
+		{
+			return mRollbackCount;
+		}
+
+		uint64_t GetResimulatedFrameCount() const
+		{
+			return mResimulatedFrameCount;
+		}
+
+		uint32_t GetMaxRollbackFrames() const
+		{
+			return mMaxRollbackFrames;
+		}
+
+	private:
+		void simulate();
+
+	private:
+		int mLocalPlayer;
+		GameState mState;
+
+		// 틱을 시작할 때의 상태와 그 틱의 입력, 틱 % HISTORY_SIZE 위치
+		GameState mSavedStates[HISTORY_SIZE];
+		uint8_t mLocalInputs[HISTORY_SIZE];
+		uint8_t mRemoteInputs[HISTORY_SIZE];
+
+		// 시뮬레이션에 실제로 쓴 상대 입력 (예측 포함), 확정 입력과 비교
+		uint8_t mUsedRemoteInputs[HISTORY_SIZE];
+
+		uint32_t mLocalInputEnd;
+		uint32_t mRemoteInputEnd;
+
+		bool mbMispredicted;
+		uint32_t mFirstMispredictedTick;
+
+		uint64_t mRollbackCount;
+		uint64_t mResimulatedFrameCount;
+		uint32_t mMaxRollbackFrames;
+	};
+}
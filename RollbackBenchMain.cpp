@@ -0,0 +1,288 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "Rollback.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(const Clock::time_point startTime)
+{
+	return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+// 봇처럼 무작위 방향키를 몇 틱씩 유지
+class InputGenerator
+{
+public:
+	explicit InputGenerator(const uint32_t seed)
+		: mRandom(seed | 1)
+		, mInput(Simulation::INPUT_NONE)
+		, mTicksLeft(0)
+	{
+	}
+
+	uint8_t Next(const uint32_t maxHoldTicks)
+	{
+		if (mTicksLeft == 0)
+		{
+			mInput = static_cast<uint8_t>(nextRandom() & 0x0f);
+			mTicksLeft = 1 + nextRandom() % maxHoldTicks;
+		}
+
+		--mTicksLeft;
+
+		return mInput;
+	}
+
+private:
+	uint32_t nextRandom()
+	{
+		mRandom ^= mRandom << 13;
+		mRandom ^= mRandom >> 17;
+		mRandom ^= mRandom << 5;
+
+		return mRandom;
+	}
+
+private:
+	uint32_t mRandom;
+	uint8_t mInput;
+	uint32_t mTicksLeft;
+};
+
+static Rollback::GameState makeInitialState()
+{
+	const Simulation::Float2 positions[Rollback::PLAYER_COUNT] = { { -0.05f, 0.f }, { 0.05f, 0.f } };
+
+	return Rollback::MakeInitialState(positions);
+}
+
+// 틱마다 상태를 기록하고 다른 틱의 상태로 되돌리는 시간
+static void benchSaveRestore(const uint32_t count)
+{
+	Rollback::GameState history[Rollback::HISTORY_SIZE];
+	Rollback::GameState state = makeInitialState();
+
+	const Clock::time_point startTime = Clock::now();
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		history[i % Rollback::HISTORY_SIZE] = state;
+		state = history[(i * 37) % Rollback::HISTORY_SIZE];
+		++state.tick;
+	}
+
+	const double elapsed = getSeconds(startTime);
+
+	// 체크섬을 출력해서 반복문이 최적화로 사라지지 않도록 함
+	std::cout << "save + restore: " << elapsed * 1e9 / count << " ns"
+		<< " (state " << sizeof(Rollback::GameState) << " bytes, checksum " << Rollback::GetChecksum(state) << ")" << std::endl;
+}
+
+// 상대 입력이 매 틱 바뀌고 MAX_PREDICTION_FRAMES 늦게 와서 매 틱 최대로 되돌리는 최악의 경우
+static void benchRollback(const uint32_t frameCount)
+{
+	Rollback::Session session(0, makeInitialState(), 0);
+	InputGenerator localInputs(1);
+
+	const uint32_t latency = Rollback::MAX_PREDICTION_FRAMES - 1;
+
+	const Clock::time_point startTime = Clock::now();
+
+	for (uint32_t frame = 0; frame < frameCount; ++frame)
+	{
+		if (frame >= latency)
+		{
+			const uint32_t remoteTick = frame - latency;
+			session.AddRemoteInput(remoteTick, (remoteTick & 1) != 0 ? Simulation::INPUT_LEFT : Simulation::INPUT_RIGHT);
+		}
+
+		session.AdvanceFrame(localInputs.Next(30));
+	}
+
+	const double elapsed = getSeconds(startTime);
+	const uint64_t simulatedFrameCount = frameCount + session.GetResimulatedFrameCount();
+
+	std::cout << "rollback: " << session.GetRollbackCount() << " rollbacks of up to " << session.GetMaxRollbackFrames() << " frames"
+		<< " | " << session.GetResimulatedFrameCount() / elapsed << " resimulated frames/s"
+		<< " | " << simulatedFrameCount / elapsed << " frames/s total"
+		<< " | " << elapsed * 1e6 / frameCount << " us per displayed frame" << std::endl;
+}
+
+struct InFlightInput
+{
+	uint32_t arrivalFrame;
+	uint32_t tick;
+	uint8_t input;
+};
+
+// 두 세션이 latency 틱 늦게 입력을 주고받으며 진행한 결과가 입력을 모두 알고 계산한 결과와 같은지
+static bool checkDeterminism(const uint32_t frameCount, const uint32_t latency, const uint32_t inputDelay, const uint32_t seed)
+{
+	const Rollback::GameState initialState = makeInitialState();
+
+	Rollback::Session sessions[Rollback::PLAYER_COUNT] = {
+		Rollback::Session(0, initialState, inputDelay),
+		Rollback::Session(1, initialState, inputDelay)
+	};
+
+	InputGenerator generators[Rollback::PLAYER_COUNT] = { InputGenerator(seed), InputGenerator(seed * 2654435761u) };
+
+	// 틱별 실제 입력, 입력 지연 동안은 입력 없음
+	std::vector<uint8_t> inputs[Rollback::PLAYER_COUNT];
+	std::deque<InFlightInput> inFlight[Rollback::PLAYER_COUNT];
+	uint64_t stallCount = 0;
+
+	// 입력 지연 동안의 빈 입력도 상대에게 보내야 상대가 그 틱을 확정함
+	for (int i = 0; i < Rollback::PLAYER_COUNT; ++i)
+	{
+		inputs[i].assign(inputDelay, Simulation::INPUT_NONE);
+
+		for (uint32_t tick = 0; tick < inputDelay; ++tick)
+		{
+			const InFlightInput message = { latency, tick, Simulation::INPUT_NONE };
+			inFlight[1 - i].push_back(message);
+		}
+	}
+
+	const auto deliver = [&](const int player, const uint32_t frame)
+	{
+		while (!inFlight[player].empty() && inFlight[player].front().arrivalFrame <= frame)
+		{
+			sessions[player].AddRemoteInput(inFlight[player].front().tick, inFlight[player].front().input);
+			inFlight[player].pop_front();
+		}
+	};
+
+	const auto advance = [&](const int player, const uint32_t frame, const uint8_t input)
+	{
+		Rollback::Session& session = sessions[player];
+		session.AdvanceFrame(input);
+
+		const uint32_t tick = session.GetLocalInputEnd() - 1;
+		inputs[player].push_back(input);
+
+		const InFlightInput message = { frame + latency, tick, input };
+		inFlight[1 - player].push_back(message);
+	};
+
+	for (uint32_t frame = 0; frame < frameCount; ++frame)
+	{
+		for (int i = 0; i < Rollback::PLAYER_COUNT; ++i)
+		{
+			deliver(i, frame);
+
+			if (sessions[i].CanAdvance())
+			{
+				advance(i, frame, generators[i].Next(20));
+			}
+			else
+			{
+				sessions[i].Synchronize();
+				++stallCount;
+			}
+		}
+	}
+
+	// 남은 입력을 모두 전달하고 뒤처진 쪽을 입력 없이 따라오게 해서 같은 틱에서 비교
+	for (int i = 0; i < Rollback::PLAYER_COUNT; ++i)
+	{
+		deliver(i, UINT32_MAX);
+	}
+
+	for (int i = 0; i < Rollback::PLAYER_COUNT; ++i)
+	{
+		Rollback::Session& session = sessions[i];
+		const Rollback::Session& other = sessions[1 - i];
+
+		while (session.GetState().tick < other.GetState().tick)
+		{
+			advance(i, frameCount, Simulation::INPUT_NONE);
+			deliver(1 - i, UINT32_MAX);
+		}
+	}
+
+	for (int i = 0; i < Rollback::PLAYER_COUNT; ++i)
+	{
+		sessions[i].Synchronize();
+	}
+
+	const uint32_t finalTick = sessions[0].GetState().tick;
+
+	Rollback::GameState reference = initialState;
+	for (uint32_t tick = 0; tick < finalTick; ++tick)
+	{
+		const uint8_t tickInputs[Rollback::PLAYER_COUNT] = { inputs[0][tick], inputs[1][tick] };
+		Rollback::Step(reference, tickInputs);
+	}
+
+	const uint32_t checksum0 = Rollback::GetChecksum(sessions[0].GetState());
+	const uint32_t checksum1 = Rollback::GetChecksum(sessions[1].GetState());
+	const uint32_t referenceChecksum = Rollback::GetChecksum(reference);
+
+	const bool bMatched = sessions[1].GetState().tick == finalTick
+		&& memcmp(&sessions[0].GetState(), &reference, sizeof(reference)) == 0
+		&& memcmp(&sessions[1].GetState(), &reference, sizeof(reference)) == 0;
+
+	std::cout << "determinism (latency " << latency << ", input delay " << inputDelay << "): tick " << finalTick
+		<< " | checksums " << std::hex << checksum0 << ' ' << checksum1 << " reference " << referenceChecksum << std::dec
+		<< " | rollbacks " << sessions[0].GetRollbackCount() << '/' << sessions[1].GetRollbackCount()
+		<< ", max " << sessions[0].GetMaxRollbackFrames() << '/' << sessions[1].GetMaxRollbackFrames() << " frames"
+		<< " | stalls " << stallCount
+		<< " | " << (bMatched ? "match" : "MISMATCH") << std::endl;
+
+	return bMatched;
+}
+
+// 사용법: SimpleNetworkRollbackBench [--frames N] [--latency N] [--input-delay N] [--seed N]
+// 결과가 하나라도 어긋나면 1을 반환
+int main(int argc, char* argv[])
+{
+	uint32_t frameCount = 1000000;
+	uint32_t latency = 6;
+	uint32_t inputDelay = 2;
+	uint32_t seed = 1;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--frames") == 0 && bHasValue)
+		{
+			frameCount = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--latency") == 0 && bHasValue)
+		{
+			latency = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--input-delay") == 0 && bHasValue)
+		{
+			inputDelay = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && bHasValue)
+		{
+			seed = static_cast<uint32_t>(atoi(argv[++i]));
+		}
+	}
+
+	if (inputDelay > Rollback::MAX_INPUT_DELAY)
+	{
+		std::cerr << "input delay must be at most " << Rollback::MAX_INPUT_DELAY << std::endl;
+		return 1;
+	}
+
+	benchSaveRestore(frameCount * 10);
+	benchRollback(frameCount);
+
+	bool bMatched = checkDeterminism(frameCount, latency, inputDelay, seed);
+
+	// 예측 한도를 넘는 지연에서 멈췄다가 이어가도 같은지
+	bMatched &= checkDeterminism(frameCount / 10, Rollback::MAX_PREDICTION_FRAMES + 4, inputDelay, seed + 1);
+
+	return bMatched ? 0 : 1;
+}
@@ -0,0 +1,1723 @@
+#include "Server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#if USE_IO_URING
+#include <unordered_map>
+
+#include "IoUring.h"
+#endif
+
+#include "NetStats.h"
+#include "Protocol.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+
+namespace Server
+{
+	enum
+	{
+		MAX_EVENTS = 1024,
+
+		// 접속당 버퍼, 수천 명이 접속해도 메모리가 크게 늘지 않도록 작게 잡음
+		RECV_BUFFER_SIZE = 4 * 1024,
+
+		// 이보다 많이 밀리면 느린 클라이언트로 보고 연결을 끊음
+		MAX_SEND_BUFFER_SIZE = 256 * 1024,
+
+		// 계측 출력 때 함께 보여줄 송신 큐가 가장 긴 연결 수
+		NET_STATS_TOP_CONNECTIONS = 3,
+
+		// 밀려서 한꺼번에 온 입력을 받아줄 최대 틱 수, 넘는 입력은 빠르게 움직이려는 것으로 보고 버림
+		MAX_INPUT_BUDGET = Simulation::TICK_RATE_HZ
+	};
+
+	struct Connection
+	{
+		Connection()
+			: fd(-1)
+			, entityId(0)
+			, index(0)
+			, recvBuffer(RECV_BUFFER_SIZE)
+			, sendOffset(0)
+			, inflightOffset(0)
+			, pendingOpCount(0)
+			, bSendInFlight(false)
+			, pos{ 0.f, 0.f }
+			, bPosDirty(false)
+			, bInputReceived(false)
+			, lastInputTick(0)
+			, inputBudget(MAX_INPUT_BUDGET)
+			, inputBudgetTick(0)
+			, cell(-1)
+			, cellSlot(0)
+			, previousCell(-1)
+			, bCellChanged(false)
+			, bActive(false)
+			, bClosing(false)
+			, netCounters()
+			, snapshotState{ 0, 0, 0 }
+		{
+		}
+
+		int fd;
+		uint32_t entityId;
+
+		// sConnections 안에서의 위치
+		size_t index;
+
+		Protocol::StreamBuffer recvBuffer;
+		std::vector<uint8_t> sendBuffer;
+		size_t sendOffset;
+
+		// io_uring: 커널이 읽는 중인 송신 버퍼와 완료되지 않은 요청 수
+		std::vector<uint8_t> inflightBuffer;
+		size_t inflightOffset;
+		uint32_t pendingOpCount;
+		bool bSendInFlight;
+
+		Simulation::Float2 pos;
+		bool bPosDirty;
+
+		// 위치는 클라이언트가 보낸 입력을 서버가 적용해서 계산
+		bool bInputReceived;
+		uint32_t lastInputTick;
+
+		// 서버 틱마다 하나씩 쌓이고 입력을 적용할 때마다 하나씩 씀
+		uint32_t inputBudget;
+		uint32_t inputBudgetTick;
+
+		// 관심 영역 격자, 아직 배치 전이면 -1
+		int cell;
+		size_t cellSlot;
+
+		// 이번 틱에 셀을 옮겼으면 새로 보이게 된 셀의 위치를 보내줌
+		int previousCell;
+		bool bCellChanged;
+
+		// 통계용, 마지막 출력 이후 데이터를 보냈는지
+		bool bActive;
+
+		bool bClosing;
+
+		NetStats::ConnectionCounters netCounters;
+
+		// delta 스냅샷: 이번 틱의 양자화된 위치와 이 클라이언트에게 보낸 스냅샷
+		Snapshot::EntityState snapshotState;
+		Snapshot::Sender snapshotSender;
+	};
+
+	struct Stats
+	{
+		uint64_t acceptedCount;
+		uint64_t closedCount;
+		uint64_t bytesIn;
+		uint64_t bytesOut;
+		uint64_t messagesIn;
+		uint64_t messagesOut;
+		uint64_t syscallCount;
+		uint64_t tickCount;
+
+		// delta 스냅샷: 보낸 바이트, 같은 프레임을 전체로 보냈다면의 바이트, 인코딩 시간
+		uint64_t snapshotBytes;
+		uint64_t snapshotFullBytes;
+		uint64_t snapshotFullCount;
+		uint64_t snapshotClientTicks;
+		uint64_t snapshotEncodeTime;
+
+		// 클라이언트에게 꺼낸 스냅샷 수와 그중 실제로 인코딩한 수, 나머지는 같은 기준의 결과를 재사용
+		uint64_t snapshotWriteCount;
+		uint64_t snapshotEncodeCount;
+
+		// 적용한 입력 틱과 서버 틱보다 빨리 와서 버린 입력 틱
+		uint64_t inputTicks;
+		uint64_t droppedInputTicks;
+	};
+
+	static Config sConfig;
+
+	static int sListenFd = -1;
+	static int sEpollFd = -1;
+
+	static std::vector<std::unique_ptr<Connection>> sConnections;
+	static std::vector<Connection*> sClosingConnections;
+	static uint32_t sNextEntityId = 1;
+
+	static std::atomic<bool> sbRunning(false);
+
+	static Stats sStats;
+
+	static NetStats::Dumper sNetStatsDumper;
+
+	// MSG_PONG에 실어 보내는 직전 틱 처리 시간(us)
+	static uint32_t sLastTickTime;
+
+	// BgPS.hlsl이 맵을 화면 크기 셀 8 x 10개로 나누는 것과 같은 격자
+	// 각 클라이언트는 자기 셀과 주변 8셀의 엔티티 갱신만 받음
+	enum
+	{
+		GRID_COLUMNS = 8,
+		GRID_ROWS = 10,
+		GRID_CELL_COUNT = GRID_COLUMNS * GRID_ROWS
+	};
+
+	static std::vector<Connection*> sCellMembers[GRID_CELL_COUNT];
+
+	// 이번 틱에 셀마다 보낼 위치 메시지
+	static std::vector<uint8_t> sCellUpdates[GRID_CELL_COUNT];
+	static size_t sCellUpdateCounts[GRID_CELL_COUNT];
+
+	// delta 스냅샷: 이번 틱에 엔티티가 움직이거나 들어오거나 나간 셀
+	// 주변 셀까지 모두 그대로면 그 셀의 프레임은 이전과 같으므로 만들지 않음
+	static bool sbCellChanged[GRID_CELL_COUNT];
+
+	// 셀과 상관없이 바뀐 엔티티가 있는지, 관심 영역을 끄고 모두가 공유하는 프레임용
+	static bool sbSnapshotChanged = false;
+
+#if USE_IO_URING
+	enum
+	{
+		RING_ENTRIES = 4096,
+
+		RECV_BUFFER_GROUP = 0,
+		RECV_BUFFER_COUNT = 4096,
+		RECV_PROVIDED_BUFFER_SIZE = 2048
+	};
+
+	enum EUringOp : uint64_t
+	{
+		OP_ACCEPT,
+		OP_RECV,
+		OP_SEND
+	};
+
+	static IoUring::Ring sRing;
+
+	// 완료 시점에 연결을 찾기 위한 맵, 닫혔지만 요청이 남은 연결도 포함
+	static std::unordered_map<uint32_t, Connection*> sConnectionsById;
+	static std::unordered_map<uint32_t, std::unique_ptr<Connection>> sRetiredConnections;
+
+	static bool initializeIoUring();
+	static void pollIoUring(const int64_t timeoutNs, const uint32_t tick);
+#endif
+
+	static bool initializeEpoll();
+	static void pollEpoll(const int timeoutMs, const uint32_t tick);
+
+	// 수천 개의 소켓을 열 수 있도록 fd 제한을 최대로 올림
+	static void raiseFileLimit()
+	{
+		rlimit limit;
+		if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+		{
+			limit.rlim_cur = limit.rlim_max;
+			setrlimit(RLIMIT_NOFILE, &limit);
+		}
+	}
+
+	bool Initialize(const Config& config)
+	{
+		sConfig = config;
+
+		raiseFileLimit();
+
+		sListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, IPPROTO_TCP);
+		if (sListenFd == -1)
+		{
+			std::cerr << "socket failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+
+		const int reuse = 1;
+		setsockopt(sListenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+		sockaddr_in hint;
+		memset(&hint, 0, sizeof(hint));
+
+		hint.sin_family = AF_INET;
+		hint.sin_addr.s_addr = htonl(INADDR_ANY);
+		hint.sin_port = htons(config.port);
+
+		if (bind(sListenFd, reinterpret_cast<sockaddr*>(&hint), sizeof(hint)) == -1)
+		{
+			std::cerr << "bind failed: " << strerror(errno) << std::endl;
+
+			Destroy();
+			return false;
+		}
+
+		if (listen(sListenFd, SOMAXCONN) == -1)
+		{
+			std::cerr << "listen failed: " << strerror(errno) << std::endl;
+
+			Destroy();
+			return false;
+		}
+
+#if USE_IO_URING
+		if (sConfig.backend == BACKEND_IO_URING && !initializeIoUring())
+		{
+			std::cerr << "io_uring unavailable, falling back to epoll" << std::endl;
+
+			sRing.Destroy();
+			sConfig.backend = BACKEND_EPOLL;
+		}
+#else
+		sConfig.backend = BACKEND_EPOLL;
+#endif
+
+		if (sConfig.backend == BACKEND_EPOLL && !initializeEpoll())
+		{
+			Destroy();
+			return false;
+		}
+
+		memset(&sStats, 0, sizeof(sStats));
+
+		// 실제로 바인드된 포트, config.port가 0이면 커널이 고른 포트
+		sockaddr_in bound;
+		socklen_t boundSize = sizeof(bound);
+		const uint16_t port = getsockname(sListenFd, reinterpret_cast<sockaddr*>(&bound), &boundSize) == 0 ? ntohs(bound.sin_port) : config.port;
+
+		std::cout << "Server listening on port " << port
+			<< (sConfig.backend == BACKEND_EPOLL ? " (epoll" : " (io_uring")
+			<< (sConfig.bInterestManagement ? ", interest grid" : ", broadcast")
+			<< (sConfig.bDeltaSnapshots ? ", delta snapshots)" : ")") << std::endl;
+
+		return true;
+	}
+
+	void Destroy()
+	{
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			close(pConnection->fd);
+		}
+		sConnections.clear();
+		sClosingConnections.clear();
+
+		for (std::vector<Connection*>& members : sCellMembers)
+		{
+			members.clear();
+		}
+
+#if USE_IO_URING
+		// 링을 닫으면 남은 요청도 모두 정리됨
+		sRing.Destroy();
+		sConnectionsById.clear();
+		sRetiredConnections.clear();
+#endif
+
+		if (sEpollFd != -1)
+		{
+			close(sEpollFd);
+			sEpollFd = -1;
+		}
+
+		if (sListenFd != -1)
+		{
+			close(sListenFd);
+			sListenFd = -1;
+		}
+	}
+
+	void Stop()
+	{
+		sbRunning.store(false);
+	}
+
+	static void closeConnection(Connection* pConnection)
+	{
+		if (!pConnection->bClosing)
+		{
+			pConnection->bClosing = true;
+			sClosingConnections.push_back(pConnection);
+		}
+	}
+
+	// 보낼 수 있는 만큼 보내고 나머지는 EPOLLOUT 때 이어서 보냄
+	static void flushSendBufferEpoll(Connection* pConnection)
+	{
+		std::vector<uint8_t>& sendBuffer = pConnection->sendBuffer;
+
+		while (pConnection->sendOffset < sendBuffer.size())
+		{
+			++sStats.syscallCount;
+
+			const size_t requestedSize = sendBuffer.size() - pConnection->sendOffset;
+			const ssize_t sentSize = send(
+				pConnection->fd,
+				sendBuffer.data() + pConnection->sendOffset,
+				requestedSize,
+				MSG_NOSIGNAL
+			);
+
+			if (sentSize == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					closeConnection(pConnection);
+				}
+				else
+				{
+					NetStats::Add(pConnection->netCounters, NetStats::WOULD_BLOCK_SENDS);
+				}
+
+				break;
+			}
+
+			pConnection->sendOffset += sentSize;
+			sStats.bytesOut += sentSize;
+
+			NetStats::Add(pConnection->netCounters, NetStats::BYTES_OUT, sentSize);
+			NetStats::Add(pConnection->netCounters, NetStats::PACKETS_OUT);
+			if (static_cast<size_t>(sentSize) < requestedSize)
+			{
+				NetStats::Add(pConnection->netCounters, NetStats::PARTIAL_SENDS);
+			}
+		}
+
+		if (pConnection->sendOffset == sendBuffer.size())
+		{
+			sendBuffer.clear();
+			pConnection->sendOffset = 0;
+		}
+	}
+
+#if USE_IO_URING
+	static uint64_t makeUserData(const uint32_t entityId, const EUringOp op)
+	{
+		return (static_cast<uint64_t>(entityId) << 8) | op;
+	}
+
+	// 송신 요청은 연결당 하나만, 진행 중에 쌓인 데이터는 완료 후 이어서 보냄
+	static void flushSendBufferIoUring(Connection* pConnection)
+	{
+		if (pConnection->bSendInFlight || pConnection->bClosing)
+		{
+			return;
+		}
+
+		if (pConnection->inflightOffset == pConnection->inflightBuffer.size())
+		{
+			if (pConnection->sendBuffer.empty())
+			{
+				return;
+			}
+
+			pConnection->inflightBuffer.clear();
+			pConnection->inflightBuffer.swap(pConnection->sendBuffer);
+			pConnection->inflightOffset = 0;
+		}
+
+		io_uring_sqe* pSqe = sRing.GetSqe();
+		if (pSqe == nullptr)
+		{
+			sRing.SubmitAndWait(0, 0);
+			pSqe = sRing.GetSqe();
+			if (pSqe == nullptr)
+			{
+				return;
+			}
+		}
+
+		pSqe->opcode = IORING_OP_SEND;
+		pSqe->fd = pConnection->fd;
+		pSqe->addr = reinterpret_cast<uint64_t>(pConnection->inflightBuffer.data() + pConnection->inflightOffset);
+		pSqe->len = static_cast<uint32_t>(pConnection->inflightBuffer.size() - pConnection->inflightOffset);
+		pSqe->msg_flags = MSG_NOSIGNAL;
+		pSqe->user_data = makeUserData(pConnection->entityId, OP_SEND);
+
+		pConnection->bSendInFlight = true;
+		++pConnection->pendingOpCount;
+	}
+#endif
+
+	// 아직 커널에 넘기지 못한 바이트, io_uring이면 진행 중인 송신도 포함
+	static size_t getSendQueueSize(const Connection* pConnection)
+	{
+		return pConnection->sendBuffer.size() - pConnection->sendOffset
+			+ pConnection->inflightBuffer.size() - pConnection->inflightOffset;
+	}
+
+	static void flushSendBuffer(Connection* pConnection)
+	{
+#if USE_IO_URING
+		if (sConfig.backend == BACKEND_IO_URING)
+		{
+			flushSendBufferIoUring(pConnection);
+			return;
+		}
+#endif
+
+		flushSendBufferEpoll(pConnection);
+	}
+
+	static void queueSend(Connection* pConnection, const uint8_t* pData, const size_t size)
+	{
+		if (pConnection->bClosing)
+		{
+			return;
+		}
+
+		std::vector<uint8_t>& sendBuffer = pConnection->sendBuffer;
+		if (sendBuffer.size() - pConnection->sendOffset + size > MAX_SEND_BUFFER_SIZE)
+		{
+			closeConnection(pConnection);
+			return;
+		}
+
+		sendBuffer.insert(sendBuffer.end(), pData, pData + size);
+	}
+
+	static void queueMessage(Connection* pConnection, const Protocol::EMessageType type, const uint32_t tick, const void* pPayload, const size_t payloadSize)
+	{
+		uint8_t message[Protocol::MAX_MESSAGE_SIZE];
+		const size_t messageSize = Protocol::WriteMessage(message, sizeof(message), type, 0, tick, pPayload, payloadSize);
+
+		queueSend(pConnection, message, messageSize);
+		++sStats.messagesOut;
+	}
+
+	static void broadcastMessage(const Connection* pExcept, const Protocol::EMessageType type, const uint32_t tick, const void* pPayload, const size_t payloadSize)
+	{
+		uint8_t message[Protocol::MAX_MESSAGE_SIZE];
+		const size_t messageSize = Protocol::WriteMessage(message, sizeof(message), type, 0, tick, pPayload, payloadSize);
+
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			if (pConnection.get() != pExcept)
+			{
+				queueSend(pConnection.get(), message, messageSize);
+				++sStats.messagesOut;
+			}
+		}
+	}
+
+	// 위치는 서버가 정하므로 시작 위치도 서버가 맵 전체에 흩어 놓음, 같은 ID면 항상 같은 위치
+	static Simulation::Float2 getSpawnPosition(const uint32_t entityId)
+	{
+		const uint32_t hash = entityId * 2654435761u;
+		const float x = (hash & 0xffff) / 65535.f;
+		const float y = (hash >> 16) / 65535.f;
+
+		return { Simulation::WORLD_MIN + (Simulation::WORLD_MAX - Simulation::WORLD_MIN) * x, Simulation::WORLD_MIN + (Simulation::WORLD_MAX - Simulation::WORLD_MIN) * y };
+	}
+
+	// cell이 음수면 격자 밖, 전체 프레임만 바뀐 것으로 표시
+	static void markSnapshotChanged(const int cell)
+	{
+		sbSnapshotChanged = true;
+
+		if (cell >= 0)
+		{
+			sbCellChanged[cell] = true;
+		}
+	}
+
+	static Connection* addConnection(const int fd, const uint32_t tick)
+	{
+		const int noDelay = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+		std::unique_ptr<Connection> pConnection(new Connection());
+		pConnection->fd = fd;
+		pConnection->entityId = sNextEntityId++;
+		pConnection->snapshotState.entityId = pConnection->entityId;
+		pConnection->index = sConnections.size();
+		pConnection->inputBudgetTick = tick;
+		pConnection->pos = getSpawnPosition(pConnection->entityId);
+
+		// 다음 틱에 격자에 배치하고 주변에 위치를 알림
+		pConnection->bPosDirty = true;
+		markSnapshotChanged(-1);
+
+		++sStats.acceptedCount;
+
+		const Protocol::EntityPayload entity = { pConnection->entityId };
+		queueMessage(pConnection.get(), Protocol::MSG_WELCOME, tick, &entity, sizeof(entity));
+		broadcastMessage(nullptr, Protocol::MSG_JOIN, tick, &entity, sizeof(entity));
+
+		// 새로 접속한 클라이언트에게 기존 플레이어를 알림
+		for (const std::unique_ptr<Connection>& pOther : sConnections)
+		{
+			const Protocol::EntityPayload other = { pOther->entityId };
+			queueMessage(pConnection.get(), Protocol::MSG_JOIN, tick, &other, sizeof(other));
+		}
+
+		sConnections.push_back(std::move(pConnection));
+
+		return sConnections.back().get();
+	}
+
+	// 아직 적용하지 않은 틱의 입력만 순서대로 적용
+	static void applyInputs(Connection* pConnection, const Protocol::InputPayload& payload, const uint32_t tick)
+	{
+		pConnection->inputBudget = std::min<uint32_t>(pConnection->inputBudget + (tick - pConnection->inputBudgetTick), MAX_INPUT_BUDGET);
+		pConnection->inputBudgetTick = tick;
+
+		Protocol::ForEachInput(payload, [pConnection](const uint32_t inputTick, const uint8_t input)
+		{
+			if (pConnection->bInputReceived && inputTick <= pConnection->lastInputTick)
+			{
+				return;
+			}
+
+			// 클라이언트 틱이 서버보다 빨리 갈 수 없음, 빠진 틱은 입력 없음으로 처리
+			if (pConnection->inputBudget == 0)
+			{
+				++sStats.droppedInputTicks;
+				return;
+			}
+
+			--pConnection->inputBudget;
+			++sStats.inputTicks;
+
+			const Simulation::Float2 pos = Simulation::ApplyInput(pConnection->pos, input);
+			if (pos.x != pConnection->pos.x || pos.y != pConnection->pos.y)
+			{
+				pConnection->pos = pos;
+				pConnection->bPosDirty = true;
+			}
+
+			pConnection->lastInputTick = inputTick;
+			pConnection->bInputReceived = true;
+		});
+	}
+
+	static void handleMessage(Connection* pConnection, const Protocol::MessageView& message, const uint32_t tick)
+	{
+		++sStats.messagesIn;
+
+		switch (message.header.type)
+		{
+		// 클라이언트가 보낸 위치는 믿지 않고 입력만 받음
+		case Protocol::MSG_INPUT:
+			{
+				Protocol::InputPayload payload;
+				if (Protocol::ReadInputPayload(message, payload))
+				{
+					applyInputs(pConnection, payload, tick);
+				}
+			}
+			break;
+
+		case Protocol::MSG_PING:
+			{
+				Protocol::PingPayload ping;
+				if (message.payloadSize != sizeof(ping))
+				{
+					break;
+				}
+
+				memcpy(&ping, message.pPayload, sizeof(ping));
+
+				// 틱을 기다리지 않고 바로 보냄, epoll은 send를 바로 하고 io_uring은 다음 제출 때 나감
+				// 백엔드와 상관없이 RTT가 네트워크와 이벤트 루프 대기만 포함하도록
+				const uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+				const Protocol::PongPayload pong = { ping.sendTime, now, now, sLastTickTime };
+				queueMessage(pConnection, Protocol::MSG_PONG, tick, &pong, sizeof(pong));
+				flushSendBuffer(pConnection);
+			}
+			break;
+
+		case Protocol::MSG_SNAPSHOT_ACK:
+			{
+				Protocol::SnapshotAckPayload ack;
+				if (message.payloadSize != sizeof(ack))
+				{
+					break;
+				}
+
+				memcpy(&ack, message.pPayload, sizeof(ack));
+				pConnection->snapshotSender.OnAck(ack.tick);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// recvBuffer에 새로 들어온 데이터를 메시지 단위로 처리
+	static void parseReceived(Connection* pConnection, const size_t receivedSize, const uint32_t tick)
+	{
+		Protocol::StreamBuffer& recvBuffer = pConnection->recvBuffer;
+
+		recvBuffer.CommitWrite(receivedSize);
+		sStats.bytesIn += receivedSize;
+		pConnection->bActive = true;
+
+		Protocol::MessageView message;
+		Protocol::EParseResult result;
+		while ((result = recvBuffer.Parse(message)) == Protocol::PARSE_OK)
+		{
+			handleMessage(pConnection, message, tick);
+		}
+
+		if (result == Protocol::PARSE_ERROR)
+		{
+			closeConnection(pConnection);
+		}
+		else if (recvBuffer.GetPendingSize() > 0)
+		{
+			NetStats::Add(pConnection->netCounters, NetStats::PARTIAL_FRAMES);
+		}
+	}
+
+	// BgPS.hlsl의 카메라 계산과 같은 매핑, [-1, 1] -> 열 [0, 8) x 행 [0, 10)
+	static int getCell(const Simulation::Float2& pos)
+	{
+		using namespace Simulation;
+
+		const float u = (pos.x - WORLD_MIN) / (WORLD_MAX - WORLD_MIN);
+		const float v = (pos.y - WORLD_MIN) / (WORLD_MAX - WORLD_MIN);
+
+		const int column = std::min(std::max(static_cast<int>(u * GRID_COLUMNS), 0), GRID_COLUMNS - 1);
+		const int row = std::min(std::max(static_cast<int>(v * GRID_ROWS), 0), GRID_ROWS - 1);
+
+		return row * GRID_COLUMNS + column;
+	}
+
+	static bool isNeighborCell(const int cell, const int other)
+	{
+		if (cell < 0 || other < 0)
+		{
+			return false;
+		}
+
+		const int dx = cell % GRID_COLUMNS - other % GRID_COLUMNS;
+		const int dy = cell / GRID_COLUMNS - other / GRID_COLUMNS;
+
+		return dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1;
+	}
+
+	// cell과 주변 셀마다 onCell(neighbor) 호출
+	template <class Callback>
+	static void forEachNeighborCell(const int cell, Callback onCell)
+	{
+		if (cell < 0)
+		{
+			return;
+		}
+
+		const int column = cell % GRID_COLUMNS;
+		const int row = cell / GRID_COLUMNS;
+
+		for (int y = std::max(row - 1, 0); y <= std::min(row + 1, GRID_ROWS - 1); ++y)
+		{
+			for (int x = std::max(column - 1, 0); x <= std::min(column + 1, GRID_COLUMNS - 1); ++x)
+			{
+				onCell(y * GRID_COLUMNS + x);
+			}
+		}
+	}
+
+	static void removeFromCell(Connection* pConnection)
+	{
+		if (pConnection->cell < 0)
+		{
+			return;
+		}
+
+		std::vector<Connection*>& members = sCellMembers[pConnection->cell];
+		members[pConnection->cellSlot] = members.back();
+		members[pConnection->cellSlot]->cellSlot = pConnection->cellSlot;
+		members.pop_back();
+
+		pConnection->cell = -1;
+	}
+
+	static void moveToCell(Connection* pConnection, const int cell)
+	{
+		pConnection->previousCell = pConnection->cell;
+		pConnection->bCellChanged = true;
+
+		removeFromCell(pConnection);
+
+		pConnection->cell = cell;
+		pConnection->cellSlot = sCellMembers[cell].size();
+		sCellMembers[cell].push_back(pConnection);
+	}
+
+	// 이벤트 처리가 끝난 뒤 한꺼번에 해제, 같은 배치 안의 포인터가 무효화되지 않도록
+	static void releaseClosedConnections(const uint32_t tick)
+	{
+		// broadcast 중 새로 닫히는 연결이 뒤에 추가될 수 있으므로 인덱스로 순회
+		for (size_t i = 0; i < sClosingConnections.size(); ++i)
+		{
+			Connection* pConnection = sClosingConnections[i];
+			++sStats.closedCount;
+
+			const Protocol::EntityPayload entity = { pConnection->entityId };
+
+			markSnapshotChanged(pConnection->cell);
+			removeFromCell(pConnection);
+
+			// 마지막 원소를 빈자리로 옮겨서 제거
+			const size_t index = pConnection->index;
+			std::unique_ptr<Connection> pRemoved = std::move(sConnections[index]);
+			if (index + 1 < sConnections.size())
+			{
+				sConnections[index] = std::move(sConnections.back());
+				sConnections[index]->index = index;
+			}
+			sConnections.pop_back();
+
+#if USE_IO_URING
+			// 커널이 아직 버퍼를 쓰고 있으면 완료될 때까지 해제를 미룸
+			if (sConfig.backend == BACKEND_IO_URING)
+			{
+				shutdown(pRemoved->fd, SHUT_RDWR);
+
+				if (pRemoved->pendingOpCount > 0)
+				{
+					const uint32_t entityId = pRemoved->entityId;
+					sRetiredConnections[entityId] = std::move(pRemoved);
+				}
+				else
+				{
+					sConnectionsById.erase(pRemoved->entityId);
+					close(pRemoved->fd);
+				}
+			}
+			else
+#endif
+			{
+				close(pRemoved->fd);
+			}
+
+			broadcastMessage(nullptr, Protocol::MSG_LEAVE, tick, &entity, sizeof(entity));
+		}
+
+		sClosingConnections.clear();
+	}
+
+	enum
+	{
+		ENTITY_POSITION_MESSAGE_SIZE = sizeof(Protocol::MessageHeader) + sizeof(Protocol::EntityPositionPayload)
+	};
+
+	static void writeEntityPosition(const Connection* pConnection, const uint32_t tick, uint8_t* pOutMessage)
+	{
+		Protocol::EntityPositionPayload payload;
+		payload.entityId = pConnection->entityId;
+		Protocol::EncodePosition(pConnection->pos.x, pConnection->pos.y, payload.pos);
+
+		Protocol::WriteMessage(pOutMessage, ENTITY_POSITION_MESSAGE_SIZE, Protocol::MSG_ENTITY_POSITION, 0, tick, &payload, sizeof(payload));
+	}
+
+	// 필터 없이 바뀐 위치를 모두에게 보냄
+	static void broadcastPositions(const uint32_t tick)
+	{
+		std::vector<uint8_t> updates;
+		updates.reserve(sConnections.size() * ENTITY_POSITION_MESSAGE_SIZE);
+
+		size_t updateCount = 0;
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			if (!pConnection->bPosDirty)
+			{
+				continue;
+			}
+
+			pConnection->bPosDirty = false;
+
+			uint8_t message[ENTITY_POSITION_MESSAGE_SIZE];
+			writeEntityPosition(pConnection.get(), tick, message);
+
+			updates.insert(updates.end(), message, message + sizeof(message));
+			++updateCount;
+		}
+
+		if (!updates.empty())
+		{
+			for (const std::unique_ptr<Connection>& pConnection : sConnections)
+			{
+				queueSend(pConnection.get(), updates.data(), updates.size());
+			}
+
+			sStats.messagesOut += updateCount * sConnections.size();
+		}
+	}
+
+	// 바뀐 위치를 셀별로 모으고 각 클라이언트에게 주변 셀 것만 보냄
+	static void sendPositionsByInterest(const uint32_t tick)
+	{
+		static std::vector<int> sTouchedCells;
+
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			if (!pConnection->bPosDirty)
+			{
+				continue;
+			}
+
+			pConnection->bPosDirty = false;
+
+			uint8_t message[ENTITY_POSITION_MESSAGE_SIZE];
+			writeEntityPosition(pConnection.get(), tick, message);
+
+			const int cell = getCell(pConnection->pos);
+			if (cell != pConnection->cell)
+			{
+				// 시야에서 벗어나는 쪽에도 마지막 위치는 보내줌
+				forEachNeighborCell(pConnection->cell, [&](const int neighbor)
+				{
+					if (isNeighborCell(cell, neighbor))
+					{
+						return;
+					}
+
+					for (Connection* pMember : sCellMembers[neighbor])
+					{
+						queueSend(pMember, message, sizeof(message));
+						++sStats.messagesOut;
+					}
+				});
+
+				moveToCell(pConnection.get(), cell);
+			}
+
+			std::vector<uint8_t>& updates = sCellUpdates[cell];
+			if (updates.empty())
+			{
+				sTouchedCells.push_back(cell);
+			}
+
+			updates.insert(updates.end(), message, message + sizeof(message));
+			++sCellUpdateCounts[cell];
+		}
+
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			Connection* pReceiver = pConnection.get();
+
+			// 움직이지 않는 엔티티는 갱신이 없으므로 새로 보이게 된 셀의 위치는 직접 보냄
+			if (pReceiver->bCellChanged)
+			{
+				pReceiver->bCellChanged = false;
+
+				forEachNeighborCell(pReceiver->cell, [&](const int neighbor)
+				{
+					if (isNeighborCell(pReceiver->previousCell, neighbor))
+					{
+						return;
+					}
+
+					for (const Connection* pMember : sCellMembers[neighbor])
+					{
+						if (pMember == pReceiver)
+						{
+							continue;
+						}
+
+						uint8_t message[ENTITY_POSITION_MESSAGE_SIZE];
+						writeEntityPosition(pMember, tick, message);
+
+						queueSend(pReceiver, message, sizeof(message));
+						++sStats.messagesOut;
+					}
+				});
+			}
+
+			forEachNeighborCell(pReceiver->cell, [&](const int neighbor)
+			{
+				const std::vector<uint8_t>& updates = sCellUpdates[neighbor];
+				if (!updates.empty())
+				{
+					queueSend(pReceiver, updates.data(), updates.size());
+					sStats.messagesOut += sCellUpdateCounts[neighbor];
+				}
+			});
+		}
+
+		for (const int cell : sTouchedCells)
+		{
+			sCellUpdates[cell].clear();
+			sCellUpdateCounts[cell] = 0;
+		}
+		sTouchedCells.clear();
+	}
+
+	// cell과 주변 셀의 엔티티로 프레임을 만듦, cell이 음수면 모든 엔티티
+	static Snapshot::FramePtr buildFrame(const int cell, const uint32_t tick)
+	{
+		std::shared_ptr<Snapshot::Frame> pFrame = std::make_shared<Snapshot::Frame>();
+		pFrame->tick = tick;
+
+		if (cell < 0)
+		{
+			pFrame->entities.reserve(sConnections.size());
+			for (const std::unique_ptr<Connection>& pConnection : sConnections)
+			{
+				pFrame->entities.push_back(pConnection->snapshotState);
+			}
+		}
+		else
+		{
+			forEachNeighborCell(cell, [&](const int neighbor)
+			{
+				for (const Connection* pMember : sCellMembers[neighbor])
+				{
+					pFrame->entities.push_back(pMember->snapshotState);
+				}
+			});
+		}
+
+		std::sort(pFrame->entities.begin(), pFrame->entities.end(), [](const Snapshot::EntityState& lhs, const Snapshot::EntityState& rhs)
+		{
+			return lhs.entityId < rhs.entityId;
+		});
+
+		return pFrame;
+	}
+
+	static void sendSnapshot(Connection* pReceiver, Snapshot::EncodeCache& cache)
+	{
+		if (pReceiver->bClosing)
+		{
+			return;
+		}
+
+		++sStats.snapshotWriteCount;
+
+		const bool bHadBaseline = pReceiver->snapshotSender.HasBaseline();
+		const uint8_t* pMessages = nullptr;
+		const Snapshot::EncodeResult result = pReceiver->snapshotSender.Write(cache, pMessages);
+		if (result.size == 0)
+		{
+			return;
+		}
+
+		queueSend(pReceiver, pMessages, result.size);
+
+		sStats.messagesOut += result.messageCount;
+		sStats.snapshotBytes += result.size;
+		sStats.snapshotFullBytes += result.fullSize;
+		sStats.snapshotFullCount += bHadBaseline ? 0 : 1;
+	}
+
+	// 클라이언트마다 ack된 기준 대비 바뀐 엔티티만 보냄 (자신 포함)
+	// 프레임은 시야가 같은 클라이언트끼리, 즉 같은 셀에 있는 클라이언트끼리 공유
+	// 보이는 엔티티가 그대로인 셀은 건너뜀, 이미 보낸 스냅샷은 TCP라 잃지 않고 ack가 오면 기준이 따라옴
+	static void sendSnapshots(const uint32_t tick)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		static Snapshot::EncodeCache sEncodeCache;
+
+		const Clock::time_point startTime = Clock::now();
+		const uint64_t encodeCount = sEncodeCache.GetEncodeCount();
+
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			if (!pConnection->bPosDirty)
+			{
+				continue;
+			}
+
+			pConnection->bPosDirty = false;
+
+			const uint32_t x = Protocol::QuantizeCoord(pConnection->pos.x, POSITION_BITS);
+			const uint32_t y = Protocol::QuantizeCoord(pConnection->pos.y, POSITION_BITS);
+			const bool bMoved = x != pConnection->snapshotState.x || y != pConnection->snapshotState.y;
+
+			pConnection->snapshotState.x = x;
+			pConnection->snapshotState.y = y;
+
+			if (sConfig.bInterestManagement)
+			{
+				const int cell = getCell(pConnection->pos);
+				if (cell != pConnection->cell)
+				{
+					markSnapshotChanged(pConnection->cell);
+					moveToCell(pConnection.get(), cell);
+					markSnapshotChanged(cell);
+				}
+
+				// 새로 보이게 된 엔티티는 스냅샷에 새 엔티티로 들어감
+				pConnection->bCellChanged = false;
+			}
+
+			if (bMoved)
+			{
+				markSnapshotChanged(pConnection->cell);
+			}
+		}
+
+		if (sConfig.bInterestManagement)
+		{
+			for (int cell = 0; cell < GRID_CELL_COUNT; ++cell)
+			{
+				if (sCellMembers[cell].empty())
+				{
+					continue;
+				}
+
+				bool bChanged = false;
+				forEachNeighborCell(cell, [&](const int neighbor)
+				{
+					bChanged = bChanged || sbCellChanged[neighbor];
+				});
+
+				if (!bChanged)
+				{
+					continue;
+				}
+
+				sEncodeCache.Reset(buildFrame(cell, tick));
+				for (Connection* pMember : sCellMembers[cell])
+				{
+					sendSnapshot(pMember, sEncodeCache);
+				}
+			}
+		}
+		else if (sbSnapshotChanged)
+		{
+			sEncodeCache.Reset(buildFrame(-1, tick));
+			for (const std::unique_ptr<Connection>& pConnection : sConnections)
+			{
+				sendSnapshot(pConnection.get(), sEncodeCache);
+			}
+		}
+
+		// 다음 틱까지 들고 있지 않도록 프레임을 놓음, 보낸 프레임은 각 Sender가 가짐
+		sEncodeCache.Reset(nullptr);
+
+		std::fill(std::begin(sbCellChanged), std::end(sbCellChanged), false);
+		sbSnapshotChanged = false;
+
+		sStats.snapshotClientTicks += sConnections.size();
+		sStats.snapshotEncodeCount += sEncodeCache.GetEncodeCount() - encodeCount;
+		sStats.snapshotEncodeTime += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count();
+	}
+
+	static void tick(const uint32_t tick)
+	{
+		if (sConfig.bDeltaSnapshots)
+		{
+			sendSnapshots(tick);
+		}
+		else if (sConfig.bInterestManagement)
+		{
+			sendPositionsByInterest(tick);
+		}
+		else
+		{
+			broadcastPositions(tick);
+		}
+
+		int64_t sendQueueBytes = 0;
+		int64_t recvQueueBytes = 0;
+
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			flushSendBuffer(pConnection.get());
+
+			sendQueueBytes += getSendQueueSize(pConnection.get());
+			recvQueueBytes += pConnection->recvBuffer.GetPendingSize();
+		}
+
+		NetStats::SetGauge(NetStats::SEND_QUEUE_BYTES, sendQueueBytes);
+		NetStats::SetGauge(NetStats::RECV_QUEUE_BYTES, recvQueueBytes);
+
+		++sStats.tickCount;
+	}
+
+	static bool initializeEpoll()
+	{
+		sEpollFd = epoll_create1(EPOLL_CLOEXEC);
+		if (sEpollFd == -1)
+		{
+			std::cerr << "epoll_create1 failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+
+		// 리슨 소켓은 data.ptr == nullptr로 구분
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN | EPOLLET;
+		event.data.ptr = nullptr;
+
+		if (epoll_ctl(sEpollFd, EPOLL_CTL_ADD, sListenFd, &event) == -1)
+		{
+			std::cerr << "epoll_ctl failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	static void acceptConnectionsEpoll(const uint32_t tick)
+	{
+		// edge-triggered이므로 EAGAIN까지 모두 받아야 함
+		while (true)
+		{
+			sockaddr_in clientSockInfo;
+			socklen_t clientSize = sizeof(clientSockInfo);
+
+			++sStats.syscallCount;
+
+			const int fd = accept4(sListenFd, reinterpret_cast<sockaddr*>(&clientSockInfo), &clientSize, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd == -1)
+			{
+				if (errno == EINTR || errno == ECONNABORTED)
+				{
+					continue;
+				}
+
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					std::cerr << "accept failed: " << strerror(errno) << std::endl;
+				}
+
+				break;
+			}
+
+			Connection* pConnection = addConnection(fd, tick);
+
+			epoll_event event;
+			memset(&event, 0, sizeof(event));
+			event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+			event.data.ptr = pConnection;
+
+			if (epoll_ctl(sEpollFd, EPOLL_CTL_ADD, fd, &event) == -1)
+			{
+				closeConnection(pConnection);
+			}
+		}
+	}
+
+	static void receiveMessagesEpoll(Connection* pConnection, const uint32_t tick)
+	{
+		Protocol::StreamBuffer& recvBuffer = pConnection->recvBuffer;
+
+		while (!pConnection->bClosing)
+		{
+			++sStats.syscallCount;
+
+			recvBuffer.Compact();
+			const ssize_t receivedSize = recv(pConnection->fd, recvBuffer.GetWritePtr(), recvBuffer.GetWritableSize(), 0);
+			if (receivedSize == 0)
+			{
+				closeConnection(pConnection);
+				break;
+			}
+
+			if (receivedSize == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+				{
+					closeConnection(pConnection);
+				}
+				else
+				{
+					NetStats::Add(pConnection->netCounters, NetStats::WOULD_BLOCK_RECVS);
+				}
+
+				break;
+			}
+
+			NetStats::Add(pConnection->netCounters, NetStats::BYTES_IN, receivedSize);
+			NetStats::Add(pConnection->netCounters, NetStats::PACKETS_IN);
+
+			parseReceived(pConnection, receivedSize, tick);
+		}
+	}
+
+	static void pollEpoll(const int timeoutMs, const uint32_t tick)
+	{
+		epoll_event events[MAX_EVENTS];
+
+		++sStats.syscallCount;
+
+		const int eventCount = epoll_wait(sEpollFd, events, MAX_EVENTS, timeoutMs);
+		if (eventCount == -1 && errno != EINTR)
+		{
+			std::cerr << "epoll_wait failed: " << strerror(errno) << std::endl;
+			Stop();
+
+			return;
+		}
+
+		for (int i = 0; i < eventCount; ++i)
+		{
+			Connection* pConnection = static_cast<Connection*>(events[i].data.ptr);
+			if (pConnection == nullptr)
+			{
+				acceptConnectionsEpoll(tick);
+				continue;
+			}
+
+			const uint32_t flags = events[i].events;
+			if ((flags & EPOLLIN) != 0)
+			{
+				receiveMessagesEpoll(pConnection, tick);
+			}
+
+			if ((flags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0)
+			{
+				closeConnection(pConnection);
+				continue;
+			}
+
+			if ((flags & EPOLLOUT) != 0)
+			{
+				flushSendBufferEpoll(pConnection);
+			}
+		}
+	}
+
+#if USE_IO_URING
+	static io_uring_sqe* getSqe()
+	{
+		io_uring_sqe* pSqe = sRing.GetSqe();
+		if (pSqe == nullptr)
+		{
+			// SQ가 가득 차면 먼저 제출해서 자리를 만듦
+			sRing.SubmitAndWait(0, 0);
+			pSqe = sRing.GetSqe();
+		}
+
+		return pSqe;
+	}
+
+	static void armAccept()
+	{
+		io_uring_sqe* pSqe = getSqe();
+		assert(pSqe != nullptr);
+
+		pSqe->opcode = IORING_OP_ACCEPT;
+		pSqe->fd = sListenFd;
+		pSqe->ioprio = IORING_ACCEPT_MULTISHOT;
+		pSqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+		pSqe->user_data = makeUserData(0, OP_ACCEPT);
+	}
+
+	// 멀티샷 recv: 한 번 등록하면 데이터가 올 때마다 등록 버퍼 링에서 버퍼를 골라 완료를 올려줌
+	static void armRecv(Connection* pConnection)
+	{
+		io_uring_sqe* pSqe = getSqe();
+		if (pSqe == nullptr)
+		{
+			closeConnection(pConnection);
+			return;
+		}
+
+		pSqe->opcode = IORING_OP_RECV;
+		pSqe->fd = pConnection->fd;
+		pSqe->ioprio = IORING_RECV_MULTISHOT;
+		pSqe->flags = IOSQE_BUFFER_SELECT;
+		pSqe->buf_group = RECV_BUFFER_GROUP;
+		pSqe->user_data = makeUserData(pConnection->entityId, OP_RECV);
+
+		++pConnection->pendingOpCount;
+	}
+
+	static bool initializeIoUring()
+	{
+		if (!sRing.Initialize(RING_ENTRIES))
+		{
+			return false;
+		}
+
+		if (!sRing.RegisterBufferRing(RECV_BUFFER_GROUP, RECV_BUFFER_COUNT, RECV_PROVIDED_BUFFER_SIZE))
+		{
+			return false;
+		}
+
+		armAccept();
+
+		return sRing.SubmitAndWait(0, 0) >= 0;
+	}
+
+	static void onRecvCompleted(Connection* pConnection, const io_uring_cqe& cqe, const uint32_t tick)
+	{
+		const bool bHasBuffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+		const uint16_t bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+		if (cqe.res > 0 && bHasBuffer && !pConnection->bClosing)
+		{
+			// 메시지가 버퍼 경계에 걸칠 수 있으므로 연결별 재조립 버퍼로 옮김
+			const uint8_t* pData = sRing.GetBuffer(bufferId);
+			size_t remainingSize = cqe.res;
+
+			NetStats::Add(pConnection->netCounters, NetStats::BYTES_IN, cqe.res);
+			NetStats::Add(pConnection->netCounters, NetStats::PACKETS_IN);
+
+			while (remainingSize > 0 && !pConnection->bClosing)
+			{
+				Protocol::StreamBuffer& recvBuffer = pConnection->recvBuffer;
+				recvBuffer.Compact();
+
+				const size_t copySize = std::min(remainingSize, recvBuffer.GetWritableSize());
+				memcpy(recvBuffer.GetWritePtr(), pData, copySize);
+				parseReceived(pConnection, copySize, tick);
+
+				pData += copySize;
+				remainingSize -= copySize;
+			}
+		}
+
+		if (bHasBuffer)
+		{
+			sRing.RecycleBuffer(bufferId);
+		}
+
+		if ((cqe.flags & IORING_CQE_F_MORE) != 0)
+		{
+			return;
+		}
+
+		// 멀티샷이 끝남: 연결 종료, 오류, 혹은 버퍼 부족(-ENOBUFS)이면 다시 등록
+		--pConnection->pendingOpCount;
+
+		if (cqe.res == 0 || (cqe.res < 0 && cqe.res != -ENOBUFS))
+		{
+			closeConnection(pConnection);
+		}
+		else if (!pConnection->bClosing)
+		{
+			armRecv(pConnection);
+		}
+	}
+
+	static void onSendCompleted(Connection* pConnection, const io_uring_cqe& cqe)
+	{
+		--pConnection->pendingOpCount;
+		pConnection->bSendInFlight = false;
+
+		if (cqe.res < 0)
+		{
+			closeConnection(pConnection);
+			return;
+		}
+
+		const size_t requestedSize = pConnection->inflightBuffer.size() - pConnection->inflightOffset;
+
+		pConnection->inflightOffset += cqe.res;
+		sStats.bytesOut += cqe.res;
+
+		NetStats::Add(pConnection->netCounters, NetStats::BYTES_OUT, cqe.res);
+		NetStats::Add(pConnection->netCounters, NetStats::PACKETS_OUT);
+		if (static_cast<size_t>(cqe.res) < requestedSize)
+		{
+			NetStats::Add(pConnection->netCounters, NetStats::PARTIAL_SENDS);
+		}
+
+		// 일부만 보냈으면 나머지를, 다 보냈으면 그동안 쌓인 데이터를 이어서 보냄
+		flushSendBufferIoUring(pConnection);
+	}
+
+	static void onCompletion(const io_uring_cqe& cqe, const uint32_t tick)
+	{
+		const EUringOp op = static_cast<EUringOp>(cqe.user_data & 0xff);
+		const uint32_t entityId = static_cast<uint32_t>(cqe.user_data >> 8);
+
+		if (op == OP_ACCEPT)
+		{
+			if (cqe.res >= 0)
+			{
+				Connection* pConnection = addConnection(cqe.res, tick);
+				sConnectionsById[pConnection->entityId] = pConnection;
+
+				armRecv(pConnection);
+			}
+
+			if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+			{
+				armAccept();
+			}
+
+			return;
+		}
+
+		const std::unordered_map<uint32_t, Connection*>::iterator it = sConnectionsById.find(entityId);
+		if (it == sConnectionsById.end())
+		{
+			if ((cqe.flags & IORING_CQE_F_BUFFER) != 0)
+			{
+				sRing.RecycleBuffer(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+			}
+
+			return;
+		}
+
+		Connection* pConnection = it->second;
+		if (op == OP_RECV)
+		{
+			onRecvCompleted(pConnection, cqe, tick);
+		}
+		else
+		{
+			onSendCompleted(pConnection, cqe);
+		}
+
+		// 닫힌 연결은 마지막 요청이 끝나면 해제
+		if (pConnection->pendingOpCount == 0 && sRetiredConnections.count(entityId) > 0)
+		{
+			close(pConnection->fd);
+			sConnectionsById.erase(it);
+			sRetiredConnections.erase(entityId);
+		}
+	}
+
+	static void pollIoUring(const int64_t timeoutNs, const uint32_t tick)
+	{
+		// 이번 루프에서 쌓인 모든 요청을 한 번의 io_uring_enter로 제출하고 완료를 기다림
+		const uint64_t enterCount = sRing.GetEnterCount();
+		if (sRing.SubmitAndWait(1, timeoutNs) < 0 && errno != EBUSY)
+		{
+			std::cerr << "io_uring_enter failed: " << strerror(errno) << std::endl;
+			Stop();
+
+			return;
+		}
+
+		sRing.ForEachCompletion([tick](const io_uring_cqe& cqe)
+		{
+			onCompletion(cqe, tick);
+		});
+
+		sStats.syscallCount += sRing.GetEnterCount() - enterCount;
+	}
+#endif
+
+	static double getCpuTime()
+	{
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+
+		return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6
+			+ usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+	}
+
+	static void printStats(const double elapsed, const double cpuTime)
+	{
+		size_t activeCount = 0;
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			if (pConnection->bActive)
+			{
+				++activeCount;
+				pConnection->bActive = false;
+			}
+		}
+
+		const size_t connectionCount = sConnections.size();
+		const double cpuPercent = 100.0 * cpuTime / elapsed;
+		const double messagesPerSecond = (sStats.messagesIn + sStats.messagesOut) / elapsed;
+
+		std::cout << "connections " << connectionCount
+			<< " (active " << activeCount << ", idle " << connectionCount - activeCount << ")"
+			<< " | accepted/s " << sStats.acceptedCount / elapsed
+			<< " | closed/s " << sStats.closedCount / elapsed
+			<< " | in " << sStats.bytesIn / elapsed / 1024.0 << " KiB/s"
+			<< " | out " << sStats.bytesOut / elapsed / 1024.0 << " KiB/s"
+			<< " | msgs/s " << messagesPerSecond
+			<< " | syscalls/tick " << (sStats.tickCount > 0 ? static_cast<double>(sStats.syscallCount) / sStats.tickCount : 0.0)
+			<< " | cpu " << cpuPercent << "%";
+
+		if (connectionCount > 0)
+		{
+			std::cout << " (" << cpuPercent * 1000.0 / connectionCount << "% per 1000 clients)";
+		}
+
+		// 단일 스레드이므로 코어당 처리량 = CPU 사용률로 나눈 처리량
+		if (cpuTime > 0.0)
+		{
+			std::cout << " | msgs/s per core " << (sStats.messagesIn + sStats.messagesOut) / cpuTime;
+		}
+
+		// 전체 스냅샷 대비 실제로 보낸 비율과 클라이언트 한 명의 한 틱 스냅샷을 만드는 데 든 시간
+		if (sStats.snapshotFullBytes > 0)
+		{
+			std::cout << " | snapshot " << 100.0 * sStats.snapshotBytes / sStats.snapshotFullBytes << "% of full"
+				<< ", " << sStats.snapshotEncodeTime / 1000.0 / std::max<uint64_t>(sStats.snapshotClientTicks, 1) << " us/client/tick"
+				<< ", full " << sStats.snapshotFullCount / elapsed << "/s"
+				<< ", reused " << 100.0 * (sStats.snapshotWriteCount - sStats.snapshotEncodeCount) / std::max<uint64_t>(sStats.snapshotWriteCount, 1) << "%";
+		}
+
+		if (sStats.inputTicks + sStats.droppedInputTicks > 0)
+		{
+			std::cout << " | inputs/s " << sStats.inputTicks / elapsed
+				<< " (dropped " << sStats.droppedInputTicks / elapsed << "/s)";
+		}
+
+		std::cout << std::endl;
+
+		memset(&sStats, 0, sizeof(sStats));
+	}
+
+	static double getSeconds(const std::chrono::steady_clock::time_point time)
+	{
+		return std::chrono::duration<double>(time.time_since_epoch()).count();
+	}
+
+	// 합계 한 줄 뒤에 송신 큐가 가장 긴 연결들의 카운터를 덧붙임
+	static void dumpNetStats(const double now)
+	{
+		if (!sNetStatsDumper.Update(now))
+		{
+			return;
+		}
+
+		std::vector<const Connection*> connections;
+		connections.reserve(sConnections.size());
+		for (const std::unique_ptr<Connection>& pConnection : sConnections)
+		{
+			connections.push_back(pConnection.get());
+		}
+
+		const size_t count = std::min<size_t>(connections.size(), NET_STATS_TOP_CONNECTIONS);
+		std::partial_sort(connections.begin(), connections.begin() + count, connections.end(), [](const Connection* pLhs, const Connection* pRhs)
+		{
+			// 큐가 모두 비어 있으면 많이 보낸 순서로
+			const size_t lhsQueueSize = getSendQueueSize(pLhs);
+			const size_t rhsQueueSize = getSendQueueSize(pRhs);
+			if (lhsQueueSize != rhsQueueSize)
+			{
+				return lhsQueueSize > rhsQueueSize;
+			}
+
+			return pLhs->netCounters.values[NetStats::BYTES_OUT] > pRhs->netCounters.values[NetStats::BYTES_OUT];
+		});
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			NetStats::WriteConnection(sNetStatsDumper.GetStream(), connections[i]->entityId, connections[i]->netCounters);
+		}
+	}
+
+	// timeoutNs가 음수면 이벤트가 올 때까지 대기
+	static void poll(const int64_t timeoutNs, const uint32_t tick)
+	{
+#if USE_IO_URING
+		if (sConfig.backend == BACKEND_IO_URING)
+		{
+			pollIoUring(timeoutNs, tick);
+
+			return;
+		}
+#endif
+
+		// 1ms 미만을 0으로 내리면 틱 직전에 바쁜 대기가 되므로 올림
+		const int timeoutMs = timeoutNs < 0 ? -1 : static_cast<int>((timeoutNs + 999999) / 1000000);
+		pollEpoll(timeoutMs, tick);
+	}
+
+	int Run()
+	{
+		using Clock = std::chrono::steady_clock;
+
+		const Clock::duration tickInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(Simulation::TICK_INTERVAL));
+
+		Clock::time_point nextTickTime = Clock::now() + tickInterval;
+		Clock::time_point statsTime = Clock::now();
+		double statsCpuTime = getCpuTime();
+
+		uint32_t currentTick = 0;
+
+		if (!sNetStatsDumper.Initialize(sConfig.pNetStatsPath, sConfig.netStatsInterval, getSeconds(Clock::now())))
+		{
+			return 1;
+		}
+
+		sbRunning.store(true);
+		while (sbRunning.load())
+		{
+			// 접속자가 없으면 틱을 돌리지 않고 새 연결(또는 통계 출력)까지 잠듦
+			const bool bIdle = sConnections.empty();
+
+			int64_t timeoutNs;
+			if (!bIdle)
+			{
+				timeoutNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::max(nextTickTime - Clock::now(), Clock::duration::zero())).count();
+			}
+			else
+			{
+				timeoutNs = -1;
+
+				if (sConfig.bPrintStats)
+				{
+					timeoutNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::max(statsTime + std::chrono::seconds(1) - Clock::now(), Clock::duration::zero())).count();
+				}
+
+				const double nextDumpTime = sNetStatsDumper.GetNextDumpTime();
+				if (nextDumpTime >= 0.0)
+				{
+					const int64_t dumpTimeoutNs = static_cast<int64_t>(std::max(nextDumpTime - getSeconds(Clock::now()), 0.0) * 1e9);
+					timeoutNs = timeoutNs < 0 ? dumpTimeoutNs : std::min(timeoutNs, dumpTimeoutNs);
+				}
+			}
+
+			poll(timeoutNs, currentTick);
+
+			if (bIdle)
+			{
+				// 쉬는 동안의 틱은 몰아서 돌리지 않고 첫 접속부터 다시 셈
+				nextTickTime = Clock::now() + tickInterval;
+			}
+			else if (Clock::now() >= nextTickTime)
+			{
+				const Clock::time_point tickStartTime = Clock::now();
+				tick(currentTick++);
+				sLastTickTime = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - tickStartTime).count());
+				nextTickTime += tickInterval;
+
+				// 오래 멈췄다면 밀린 틱을 몰아서 돌리지 않음
+				if (Clock::now() > nextTickTime + tickInterval)
+				{
+					nextTickTime = Clock::now() + tickInterval;
+				}
+			}
+
+			releaseClosedConnections(currentTick);
+
+			if (sConfig.bPrintStats)
+			{
+				const Clock::time_point now = Clock::now();
+				const double elapsed = std::chrono::duration<double>(now - statsTime).count();
+				if (elapsed >= 1.0)
+				{
+					const double cpuTime = getCpuTime();
+					printStats(elapsed, cpuTime - statsCpuTime);
+
+					statsTime = now;
+					statsCpuTime = cpuTime;
+				}
+			}
+
+			dumpNetStats(getSeconds(Clock::now()));
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+// 리눅스 전용 다중 접속 서버 (epoll edge-triggered)
+namespace Server
+{
+	enum
+	{
+		DEFAULT_PORT = 25565
+	};
+
+	enum EBackend
+	{
+		BACKEND_EPOLL,
+
+		// USE_IO_URING으로 빌드했을 때만 사용 가능, 실패하면 epoll로 대체
+		BACKEND_IO_URING
+	};
+
+	struct Config
+	{
+		uint16_t port;
+		EBackend backend;
+
+		// 1초마다 접속/CPU 통계를 출력
+		bool bPrintStats;
+
+		// 위치 갱신을 주변 셀의 클라이언트에게만 보냄, 끄면 모두에게 보냄
+		bool bInterestManagement;
+
+		// 엔티티 위치를 클라이언트가 마지막으로 ack한 스냅샷 대비 delta로 보냄, 끄면 바뀐 위치마다 MSG_ENTITY_POSITION
+		bool bDeltaSnapshots;
+
+		// 이 간격(초)마다 소켓 계측 카운터와 송신 큐가 가장 긴 연결들을 출력, 0이면 끔
+		double netStatsInterval;
+
+		// 계측 출력 파일, nullptr이면 stdout
+		const char* pNetStatsPath;
+	};
+
+	bool Initialize(const Config& config);
+	void Destroy();
+	int Run();
+
+	// 다른 스레드나 시그널 핸들러에서 Run 종료 요청
+	void Stop();
+}
@@ -0,0 +1,110 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "Server.h"
+
+static void onSignal(const int)
+{
+	Server::Stop();
+}
+
+static const char* const USAGE = "usage: SimpleNetworkServer [--quiet] [--io-uring] [--no-interest] [--no-delta] [--net-stats S] [--net-stats-file FILE] [port]";
+
+// 1 ~ 65535의 10진수만 받음
+static bool parsePort(const char* pText, uint16_t& outPort)
+{
+	char* pEnd = nullptr;
+	errno = 0;
+	const long value = strtol(pText, &pEnd, 10);
+	if (errno != 0 || pEnd == pText || *pEnd != '\0' || value < 1 || value > 65535)
+	{
+		return false;
+	}
+
+	outPort = static_cast<uint16_t>(value);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	Server::Config config;
+	config.port = Server::DEFAULT_PORT;
+	config.backend = Server::BACKEND_EPOLL;
+	config.bPrintStats = true;
+	config.bInterestManagement = true;
+	config.bDeltaSnapshots = true;
+	config.netStatsInterval = 0.0;
+	config.pNetStatsPath = nullptr;
+
+	bool bHasPort = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bTakesValue = strcmp(argv[i], "--net-stats") == 0 || strcmp(argv[i], "--net-stats-file") == 0;
+		if (bTakesValue && i + 1 >= argc)
+		{
+			std::cerr << argv[i] << " needs a value" << std::endl << USAGE << std::endl;
+			return 1;
+		}
+
+		if (strcmp(argv[i], "--quiet") == 0)
+		{
+			config.bPrintStats = false;
+		}
+		else if (strcmp(argv[i], "--io-uring") == 0)
+		{
+			config.backend = Server::BACKEND_IO_URING;
+		}
+		else if (strcmp(argv[i], "--no-interest") == 0)
+		{
+			config.bInterestManagement = false;
+		}
+		else if (strcmp(argv[i], "--no-delta") == 0)
+		{
+			config.bDeltaSnapshots = false;
+		}
+		else if (strcmp(argv[i], "--net-stats") == 0)
+		{
+			config.netStatsInterval = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--net-stats-file") == 0)
+		{
+			config.pNetStatsPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if (argv[i][0] == '-' || bHasPort || !parsePort(argv[i], config.port))
+		{
+			std::cerr << "invalid argument: " << argv[i] << std::endl << USAGE << std::endl;
+			return 1;
+		}
+		else
+		{
+			bHasPort = true;
+		}
+	}
+
+	// SA_RESTART 없이 등록해야 접속자가 없어 무기한 대기 중일 때도 바로 깨어남
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = onSignal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	if (!Server::Initialize(config))
+	{
+		return 1;
+	}
+
+	const int exitCode = Server::Run();
+	Server::Destroy();
+
+	return exitCode;
+}
@@ -0,0 +1,386 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+
+namespace ShaderCache
+{
+	enum
+	{
+		CACHE_MAGIC = 0x43534e53, // "SNSC"
+
+		// 캐시 파일 형식이나 키 계산이 바뀌면 올려서 이전 캐시를 무시
+		CACHE_VERSION = 1
+	};
+
+	struct CacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint64_t size;
+	};
+
+	static_assert(sizeof(CacheHeader) == 24, "CacheHeader must not have padding");
+
+	const char* GetSourceName(const ESource source)
+	{
+		switch (source)
+		{
+		case SOURCE_PREBUILT:
+			return "prebuilt";
+
+		case SOURCE_CACHE:
+			return "cache";
+
+		case SOURCE_COMPILED:
+			return "compiled";
+
+		default:
+			return "failed";
+		}
+	}
+
+	void Hasher::Add(const void* pData, const size_t size)
+	{
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			mHash = (mHash ^ pBytes[i]) * 1099511628211ull;
+		}
+	}
+
+	void Hasher::AddString(const std::string& text)
+	{
+		AddUint32(static_cast<uint32_t>(text.size()));
+		Add(text.data(), text.size());
+	}
+
+	void Hasher::AddUint32(const uint32_t value)
+	{
+		// 바이트 순서와 상관없이 같은 값
+		const uint8_t bytes[4] = {
+			static_cast<uint8_t>(value),
+			static_cast<uint8_t>(value >> 8),
+			static_cast<uint8_t>(value >> 16),
+			static_cast<uint8_t>(value >> 24)
+		};
+
+		Add(bytes, sizeof(bytes));
+	}
+
+	static bool readFile(const std::string& path, std::string& outData)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			return false;
+		}
+
+		outData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		return !file.bad();
+	}
+
+	static bool getModifiedTime(const std::string& path, int64_t& outTime)
+	{
+#if defined(_WIN32)
+		struct _stat64 info;
+		if (_stat64(path.c_str(), &info) != 0)
+		{
+			return false;
+		}
+#else
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0)
+		{
+			return false;
+		}
+#endif
+
+		outTime = static_cast<int64_t>(info.st_mtime);
+
+		return true;
+	}
+
+	static bool makeDirectory(const std::string& path)
+	{
+		if (path.empty())
+		{
+			return true;
+		}
+
+#if defined(_WIN32)
+		const int result = _mkdir(path.c_str());
+#else
+		const int result = mkdir(path.c_str(), 0755);
+#endif
+
+		return result == 0 || errno == EEXIST;
+	}
+
+	static std::string getDirectory(const std::string& path)
+	{
+		const size_t slash = path.find_last_of("/\\");
+
+		return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+	}
+
+	static std::string getFileStem(const std::string& path)
+	{
+		const size_t slash = path.find_last_of("/\\");
+		const std::string fileName = slash == std::string::npos ? path : path.substr(slash + 1);
+
+		return fileName.substr(0, fileName.find_last_of('.'));
+	}
+
+	// 한 줄에서 #include "name" 또는 #include <name>의 name, 없으면 false
+	static bool parseInclude(const std::string& line, std::string& outName)
+	{
+		size_t i = line.find_first_not_of(" \t");
+		if (i == std::string::npos || line[i] != '#')
+		{
+			return false;
+		}
+
+		i = line.find_first_not_of(" \t", i + 1);
+		if (i == std::string::npos || line.compare(i, 7, "include") != 0)
+		{
+			return false;
+		}
+
+		i = line.find_first_not_of(" \t", i + 7);
+		if (i == std::string::npos || (line[i] != '"' && line[i] != '<'))
+		{
+			return false;
+		}
+
+		const char closing = line[i] == '"' ? '"' : '>';
+		const size_t end = line.find(closing, i + 1);
+		if (end == std::string::npos)
+		{
+			return false;
+		}
+
+		outName = line.substr(i + 1, end - i - 1);
+
+		return true;
+	}
+
+	bool ReadSourceFiles(const std::string& sourcePath, std::vector<SourceFile>& outFiles)
+	{
+		outFiles.clear();
+
+		// 읽은 순서대로 include를 찾아 뒤에 붙임, 같은 파일은 한 번만
+		std::vector<std::string> paths(1, sourcePath);
+		for (size_t fileIndex = 0; fileIndex < paths.size(); ++fileIndex)
+		{
+			SourceFile file;
+			file.path = paths[fileIndex];
+
+			if (!readFile(file.path, file.data) || !getModifiedTime(file.path, file.modifiedTime))
+			{
+				return false;
+			}
+
+			// D3D_COMPILE_STANDARD_FILE_INCLUDE처럼 포함하는 파일의 디렉터리 기준
+			const std::string directory = getDirectory(file.path);
+
+			std::istringstream lines(file.data);
+			std::string line;
+			while (std::getline(lines, line))
+			{
+				std::string includeName;
+				if (!parseInclude(line, includeName))
+				{
+					continue;
+				}
+
+				const std::string includePath = directory + includeName;
+				if (std::find(paths.begin(), paths.end(), includePath) == paths.end())
+				{
+					paths.push_back(includePath);
+				}
+			}
+
+			outFiles.push_back(std::move(file));
+		}
+
+		return true;
+	}
+
+	uint64_t ComputeKey(const ShaderDesc& desc, const std::vector<SourceFile>& sourceFiles)
+	{
+		Hasher hasher;
+
+		hasher.AddUint32(CACHE_VERSION);
+		hasher.AddString(desc.entryPoint);
+		hasher.AddString(desc.target);
+		hasher.AddUint32(desc.flags);
+
+		hasher.AddUint32(static_cast<uint32_t>(desc.defines.size()));
+		for (const std::string& define : desc.defines)
+		{
+			hasher.AddString(define);
+		}
+
+		// 경로까지 넣어서 include 대상이 바뀐 경우도 구분, 수정 시각은 넣지 않음
+		hasher.AddUint32(static_cast<uint32_t>(sourceFiles.size()));
+		for (const SourceFile& file : sourceFiles)
+		{
+			hasher.AddString(file.path);
+			hasher.AddString(file.data);
+		}
+
+		return hasher.GetHash();
+	}
+
+	std::string GetCachePath(const std::string& cacheDirectory, const ShaderDesc& desc, const uint64_t key)
+	{
+		char keyText[17];
+		snprintf(keyText, sizeof(keyText), "%016llx", static_cast<unsigned long long>(key));
+
+		std::string path = cacheDirectory;
+		if (!path.empty() && path.back() != '/' && path.back() != '\\')
+		{
+			path += '/';
+		}
+
+		return path + getFileStem(desc.sourcePath) + '_' + desc.target + '_' + keyText + ".cso";
+	}
+
+	bool ReadCacheFile(const std::string& path, const uint64_t key, std::vector<uint8_t>& outBytecode)
+	{
+		std::string data;
+		if (!readFile(path, data) || data.size() < sizeof(CacheHeader))
+		{
+			return false;
+		}
+
+		CacheHeader header;
+		memcpy(&header, data.data(), sizeof(header));
+
+		if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.key != key
+			|| header.size != data.size() - sizeof(header))
+		{
+			return false;
+		}
+
+		outBytecode.assign(data.begin() + sizeof(header), data.end());
+
+		return true;
+	}
+
+	bool WriteCacheFile(const std::string& path, const uint64_t key, const std::vector<uint8_t>& bytecode)
+	{
+		if (!makeDirectory(getDirectory(path)))
+		{
+			return false;
+		}
+
+		// 서버와 클라이언트를 동시에 띄워도 임시 파일이 겹치지 않도록 시각을 붙임
+		const std::string tempPath = path + '.' + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file)
+			{
+				return false;
+			}
+
+			const CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, key, bytecode.size() };
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+
+			if (!file.flush())
+			{
+				file.close();
+				std::remove(tempPath.c_str());
+
+				return false;
+			}
+		}
+
+		// 키가 같으면 내용도 같으므로 다른 프로세스가 먼저 만들었어도 그대로 둠 (Windows의 rename은 덮어쓰지 않음)
+		if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+		{
+			std::remove(tempPath.c_str());
+
+			std::vector<uint8_t> existing;
+			return ReadCacheFile(path, key, existing);
+		}
+
+		return true;
+	}
+
+	ESource Load(
+		const ShaderDesc& desc,
+		const std::string& prebuiltPath,
+		const std::string& cacheDirectory,
+		const CompileFunction& compile,
+		std::vector<uint8_t>& outBytecode
+	)
+	{
+		outBytecode.clear();
+
+		std::vector<SourceFile> sourceFiles;
+		const bool bHasSources = ReadSourceFiles(desc.sourcePath, sourceFiles);
+
+		// 소스 없이 배포했으면 빌드 결과만 사용
+		int64_t prebuiltTime;
+		if (!prebuiltPath.empty() && getModifiedTime(prebuiltPath, prebuiltTime))
+		{
+			int64_t newestSourceTime = INT64_MIN;
+			for (const SourceFile& file : sourceFiles)
+			{
+				newestSourceTime = std::max(newestSourceTime, file.modifiedTime);
+			}
+
+			std::string data;
+			if ((!bHasSources || prebuiltTime >= newestSourceTime) && readFile(prebuiltPath, data) && !data.empty())
+			{
+				outBytecode.assign(data.begin(), data.end());
+
+				return SOURCE_PREBUILT;
+			}
+		}
+
+		if (!bHasSources)
+		{
+			return SOURCE_FAILED;
+		}
+
+		const uint64_t key = ComputeKey(desc, sourceFiles);
+		const std::string cachePath = GetCachePath(cacheDirectory, desc, key);
+
+		if (ReadCacheFile(cachePath, key, outBytecode))
+		{
+			return SOURCE_CACHE;
+		}
+
+		if (!compile(desc, outBytecode))
+		{
+			outBytecode.clear();
+
+			return SOURCE_FAILED;
+		}
+
+		// 캐시에 쓰지 못해도 이번 실행에는 지장 없음
+		WriteCacheFile(cachePath, key, outBytecode);
+
+		return SOURCE_COMPILED;
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 셰이더 바이트코드를 찾는 순서
+// 1. 빌드가 만든 .cso (FxCompile)가 소스와 include보다 새로우면 그대로 사용
+// 2. 소스, include, define, 플래그의 해시를 이름으로 하는 디스크 캐시
+// 3. 둘 다 없을 때만 컴파일하고 캐시에 저장
+// D3D에 의존하지 않음, 컴파일은 호출하는 쪽이 넘김
+namespace ShaderCache
+{
+	struct ShaderDesc
+	{
+		std::string sourcePath;
+		std::string entryPoint;
+		std::string target;
+
+		// "NAME=VALUE", 순서도 키에 들어감
+		std::vector<std::string> defines;
+
+		uint32_t flags;
+	};
+
+	struct SourceFile
+	{
+		std::string path;
+		std::string data;
+		int64_t modifiedTime;
+	};
+
+	enum ESource
+	{
+		SOURCE_PREBUILT,
+		SOURCE_CACHE,
+		SOURCE_COMPILED,
+		SOURCE_FAILED
+	};
+
+	const char* GetSourceName(const ESource source);
+
+	// 64비트 FNV-1a
+	class Hasher
+	{
+	public:
+		Hasher()
+			: mHash(14695981039346656037ull)
+		{
+		}
+
+		void Add(const void* pData, const size_t size);
+
+		// 길이를 함께 넣어서 ("ab", "c")와 ("a", "bc")를 구분
+		void AddString(const std::string& text);
+
+		void AddUint32(const uint32_t value);
+
+		uint64_t GetHash() const
+		{
+			return mHash;
+		}
+
+	private:
+		uint64_t mHash;
+	};
+
+	// sourcePath와 그 안의 #include "..."를 포함한 파일을 재귀로 따라가서 읽음 (sourcePath가 처음)
+	// #if 안쪽도 모두 따라가므로 실제보다 많이 포함할 수는 있어도 빠뜨리지는 않음
+	// 하나라도 읽지 못하면 false
+	bool ReadSourceFiles(const std::string& sourcePath, std::vector<SourceFile>& outFiles);
+
+	uint64_t ComputeKey(const ShaderDesc& desc, const std::vector<SourceFile>& sourceFiles);
+
+	// cacheDirectory/<소스 이름>_<target>_<키 16진수>.cso
+	std::string GetCachePath(const std::string& cacheDirectory, const ShaderDesc& desc, const uint64_t key);
+
+	// 헤더의 키와 크기가 맞을 때만 true
+	bool ReadCacheFile(const std::string& path, const uint64_t key, std::vector<uint8_t>& outBytecode);
+
+	// 임시 파일에 쓴 뒤 이름을 바꿔서 다른 프로세스가 쓰다 만 파일을 읽지 않도록 함
+	bool WriteCacheFile(const std::string& path, const uint64_t key, const std::vector<uint8_t>& bytecode);
+
+	typedef std::function<bool(const ShaderDesc& desc, std::vector<uint8_t>& outBytecode)> CompileFunction;
+
+	// prebuiltPath가 비어 있으면 빌드 결과는 보지 않음
+	ESource Load(
+		const ShaderDesc& desc,
+		const std::string& prebuiltPath,
+		const std::string& cacheDirectory,
+		const CompileFunction& compile,
+		std::vector<uint8_t>& outBytecode
+	);
+}
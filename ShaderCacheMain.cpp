@@ -0,0 +1,99 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ShaderCache.h"
+
+// 셰이더의 캐시 키와 캐시 파일, 키에 들어간 파일 목록을 출력 (컴파일은 하지 않음)
+// 사용법: SimpleNetworkShaderCache [--cache-dir DIR] [--flags N] [--define NAME=VALUE]... [--entry NAME]
+//         [--prebuilt FILE] SOURCE TARGET
+// 캐시에 있거나 빌드 결과가 최신이면 0, 컴파일해야 하면 2, 소스를 읽지 못하면 1을 반환
+int main(int argc, char* argv[])
+{
+	ShaderCache::ShaderDesc desc;
+	desc.entryPoint = "main";
+	desc.flags = 0;
+
+	std::string cacheDirectory = "ShaderCache";
+	std::string prebuiltPath;
+	std::vector<const char*> positionalArgs;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--cache-dir") == 0 && bHasValue)
+		{
+			cacheDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--flags") == 0 && bHasValue)
+		{
+			desc.flags = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+		}
+		else if (strcmp(argv[i], "--define") == 0 && bHasValue)
+		{
+			desc.defines.push_back(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--entry") == 0 && bHasValue)
+		{
+			desc.entryPoint = argv[++i];
+		}
+		else if (strcmp(argv[i], "--prebuilt") == 0 && bHasValue)
+		{
+			prebuiltPath = argv[++i];
+		}
+		else
+		{
+			positionalArgs.push_back(argv[i]);
+		}
+	}
+
+	if (positionalArgs.size() != 2)
+	{
+		std::cerr << "usage: SimpleNetworkShaderCache [--cache-dir DIR] [--flags N] [--define NAME=VALUE]... [--entry NAME] [--prebuilt FILE] SOURCE TARGET" << std::endl;
+		return 1;
+	}
+
+	desc.sourcePath = positionalArgs[0];
+	desc.target = positionalArgs[1];
+
+	std::vector<ShaderCache::SourceFile> sourceFiles;
+	if (!ShaderCache::ReadSourceFiles(desc.sourcePath, sourceFiles))
+	{
+		std::cerr << "failed to read " << desc.sourcePath << " or one of its includes" << std::endl;
+		return 1;
+	}
+
+	const uint64_t key = ShaderCache::ComputeKey(desc, sourceFiles);
+	const std::string cachePath = ShaderCache::GetCachePath(cacheDirectory, desc, key);
+
+	for (const ShaderCache::SourceFile& file : sourceFiles)
+	{
+		std::cout << "source: " << file.path << " (" << file.data.size() << " bytes)" << std::endl;
+	}
+
+	std::cout << "key: " << std::hex << key << std::dec << std::endl;
+	std::cout << "cache: " << cachePath << std::endl;
+
+	// 컴파일 대신 실패를 넘겨서 컴파일 없이 찾을 수 있는지만 확인
+	std::vector<uint8_t> bytecode;
+	const ShaderCache::ESource source = ShaderCache::Load(
+		desc,
+		prebuiltPath,
+		cacheDirectory,
+		[](const ShaderCache::ShaderDesc&, std::vector<uint8_t>&) { return false; },
+		bytecode
+	);
+
+	if (source == ShaderCache::SOURCE_FAILED)
+	{
+		std::cout << "found: no, needs compiling" << std::endl;
+		return 2;
+	}
+
+	std::cout << "found: " << ShaderCache::GetSourceName(source) << " (" << bytecode.size() << " bytes)" << std::endl;
+
+	return 0;
+}
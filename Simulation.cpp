@@ -0,0 +1,159 @@
+#include "Simulation.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace Simulation
+{
+	Float2 Lerp(const Float2& from, const Float2& to, const float t)
+	{
+		return { from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t };
+	}
+
+	Float2 ClampToWorld(const Float2& pos)
+	{
+		Float2 clamped = pos;
+		clamped.x = clamped.x < WORLD_MIN ? WORLD_MIN : (clamped.x > WORLD_MAX ? WORLD_MAX : clamped.x);
+		clamped.y = clamped.y < WORLD_MIN ? WORLD_MIN : (clamped.y > WORLD_MAX ? WORLD_MAX : clamped.y);
+
+		return clamped;
+	}
+
+	Float2 ApplyInput(const Float2& pos, const uint8_t input)
+	{
+		Float2 moved = pos;
+
+		if ((input & INPUT_UP) != 0)
+		{
+			moved.y -= DELTA_DIST;
+		}
+
+		if ((input & INPUT_DOWN) != 0)
+		{
+			moved.y += DELTA_DIST;
+		}
+
+		if ((input & INPUT_LEFT) != 0)
+		{
+			moved.x -= DELTA_DIST;
+		}
+
+		if ((input & INPUT_RIGHT) != 0)
+		{
+			moved.x += DELTA_DIST;
+		}
+
+		// 화면 밖으로 계속 밀려나가지 않고 양자화 범위 안에 머물도록
+		return ClampToWorld(moved);
+	}
+
+	InputPrediction::InputPrediction()
+		: mOldestIndex(0)
+		, mPendingCount(0)
+		, mNewestTick(0)
+		, mbAckedAny(false)
+		, mLastAckedTick(0)
+		, mLastError(0.f)
+		, mMaxError(0.f)
+		, mOverflowCount(0)
+	{
+	}
+
+	Float2 InputPrediction::PushInput(const uint32_t tick, const uint8_t input, const Float2& pos)
+	{
+		// 입력이 없으면 이동도 없으므로, 확인 대기 중인 입력이 없을 때는 보관하지 않음
+		// 보관하는 동안에는 틱이 빠지지 않게 빈 입력도 넣어서 서버와 같은 순서로 다시 적용
+		if (input != INPUT_NONE || mPendingCount > 0)
+		{
+			assert(mPendingCount == 0 || tick == mNewestTick + 1);
+
+			if (mPendingCount == MAX_PENDING_INPUTS)
+			{
+				mOldestIndex = (mOldestIndex + 1) % MAX_PENDING_INPUTS;
+				--mPendingCount;
+				++mOverflowCount;
+			}
+
+			mInputs[(mOldestIndex + mPendingCount) % MAX_PENDING_INPUTS] = input;
+			++mPendingCount;
+			mNewestTick = tick;
+		}
+
+		return ApplyInput(pos, input);
+	}
+
+	Float2 InputPrediction::Reconcile(const uint32_t lastInputTick, const Float2& authoritativePos, const Float2& predictedPos)
+	{
+		if (mbAckedAny && lastInputTick < mLastAckedTick)
+		{
+			return predictedPos;
+		}
+
+		mbAckedAny = true;
+		mLastAckedTick = lastInputTick;
+
+		// 서버가 처리한 입력 제거
+		while (mPendingCount > 0)
+		{
+			const uint32_t oldestTick = mNewestTick - static_cast<uint32_t>(mPendingCount - 1);
+			if (oldestTick > lastInputTick)
+			{
+				break;
+			}
+
+			mOldestIndex = (mOldestIndex + 1) % MAX_PENDING_INPUTS;
+			--mPendingCount;
+		}
+
+		Float2 corrected = authoritativePos;
+		for (size_t i = 0; i < mPendingCount; ++i)
+		{
+			corrected = ApplyInput(corrected, GetPendingInput(i));
+		}
+
+		const float dx = corrected.x - predictedPos.x;
+		const float dy = corrected.y - predictedPos.y;
+		mLastError = std::sqrt(dx * dx + dy * dy);
+		mMaxError = mLastError > mMaxError ? mLastError : mMaxError;
+
+		return corrected;
+	}
+
+	uint8_t InputPrediction::GetPendingInput(const size_t index) const
+	{
+		assert(index < mPendingCount);
+
+		return mInputs[(mOldestIndex + index) % MAX_PENDING_INPUTS];
+	}
+
+	FixedTimestep::FixedTimestep()
+		: mPrevTime(std::chrono::steady_clock::now())
+		, mAccumulator(0.0)
+		, mTick(0)
+	{
+	}
+
+	int FixedTimestep::Advance()
+	{
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		mAccumulator += std::chrono::duration<double>(now - mPrevTime).count();
+		mPrevTime = now;
+
+		// 창 이동 등으로 오래 멈췄을 때 몰아서 시뮬레이션하다 계속 밀리는 것 방지
+		if (mAccumulator > MAX_FRAME_TIME)
+		{
+			mAccumulator = MAX_FRAME_TIME;
+		}
+
+		const int tickCount = static_cast<int>(mAccumulator / TICK_INTERVAL);
+		mAccumulator -= tickCount * TICK_INTERVAL;
+		mTick += tickCount;
+
+		return tickCount;
+	}
+
+	float FixedTimestep::GetAlpha() const
+	{
+		return static_cast<float>(mAccumulator / TICK_INTERVAL);
+	}
+}
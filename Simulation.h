@@ -0,0 +1,160 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// 30 / 60 / 128 중 선택
+#ifndef TICK_RATE
+#define TICK_RATE (60)
+#endif
+
+namespace Simulation
+{
+	static_assert(TICK_RATE > 0, "TICK_RATE must be positive");
+
+	enum
+	{
+		TICK_RATE_HZ = TICK_RATE
+	};
+
+	constexpr double TICK_INTERVAL = 1.0 / TICK_RATE_HZ;
+
+	// 한 프레임에서 따라잡을 최대 시간(초)
+	constexpr double MAX_FRAME_TIME = 0.25;
+
+	// 초당 이동 거리 (기존 60fps 기준 프레임당 0.005f)
+	constexpr float MOVE_SPEED = 0.3f;
+	constexpr float DELTA_DIST = static_cast<float>(MOVE_SPEED * TICK_INTERVAL);
+
+	// 셰이더가 위치를 clamp하는 범위
+	constexpr float WORLD_MIN = -1.f;
+	constexpr float WORLD_MAX = 1.f;
+
+	struct Float2
+	{
+		float x;
+		float y;
+	};
+
+	struct PlayerState
+	{
+		Float2 prevPos;
+		Float2 pos;
+	};
+
+	Float2 Lerp(const Float2& from, const Float2& to, const float t);
+	Float2 ClampToWorld(const Float2& pos);
+
+	// 한 틱 동안 눌린 방향키 비트
+	enum EInput : uint8_t
+	{
+		INPUT_NONE = 0,
+		INPUT_UP = 1 << 0,
+		INPUT_DOWN = 1 << 1,
+		INPUT_LEFT = 1 << 2,
+		INPUT_RIGHT = 1 << 3
+	};
+
+	// 한 틱 이동 규칙, 서버와 클라이언트 예측이 반드시 같은 함수를 사용
+	// 배경 텍스처 기준이라 위쪽이 -y
+	Float2 ApplyInput(const Float2& pos, const uint8_t input);
+
+	// 클라이언트 예측, 입력을 바로 적용하고 서버가 확인할 때까지 보관
+	// 권한 있는 상태가 오면 그 위에 아직 확인 안 된 입력을 다시 적용
+	class InputPrediction
+	{
+	public:
+		enum
+		{
+			// 60Hz 기준 4초 이상 ack가 없으면 오래된 입력부터 버림
+			MAX_PENDING_INPUTS = 256
+		};
+
+		InputPrediction();
+
+		// input을 pos에 적용한 예측 위치 반환
+		Float2 PushInput(const uint32_t tick, const uint8_t input, const Float2& pos);
+
+		// lastInputTick까지 적용된 서버 위치에 남은 입력을 다시 적용한 위치 반환
+		// 이미 처리한 것보다 오래된 상태면 predictedPos를 그대로 반환
+		Float2 Reconcile(const uint32_t lastInputTick, const Float2& authoritativePos, const Float2& predictedPos);
+
+		size_t GetPendingCount() const
+		{
+			return mPendingCount;
+		}
+
+		bool HasPendingInputs() const
+		{
+			return mPendingCount > 0;
+		}
+
+		// 가장 최근 입력의 틱, 보관 중인 입력이 있을 때만 의미 있음
+		uint32_t GetNewestTick() const
+		{
+			return mNewestTick;
+		}
+
+		// 0이 가장 오래된 입력
+		uint8_t GetPendingInput(const size_t index) const;
+
+		// 보정 직전 예측 위치와 보정 후 위치의 거리
+		float GetLastError() const
+		{
+			return mLastError;
+		}
+
+		float GetMaxError() const
+		{
+			return mMaxError;
+		}
+
+		uint32_t GetOverflowCount() const
+		{
+			return mOverflowCount;
+		}
+
+	private:
+		uint8_t mInputs[MAX_PENDING_INPUTS];
+		size_t mOldestIndex;
+		size_t mPendingCount;
+		uint32_t mNewestTick;
+
+		bool mbAckedAny;
+		uint32_t mLastAckedTick;
+
+		float mLastError;
+		float mMaxError;
+		uint32_t mOverflowCount;
+	};
+
+	// 렌더/vsync와 무관하게 고정 간격으로 틱을 진행
+	class FixedTimestep
+	{
+	public:
+		FixedTimestep();
+
+		// 이번 프레임에 실행할 틱 수
+		int Advance();
+
+		// 마지막 두 틱 사이 보간 비율 [0, 1)
+		float GetAlpha() const;
+
+		// 마지막 Advance 기준 다음 틱까지 남은 시간(초)
+		double GetTimeUntilNextTick() const
+		{
+			return TICK_INTERVAL - mAccumulator;
+		}
+
+		uint32_t GetTick() const
+		{
+			return mTick;
+		}
+
+	private:
+		std::chrono::steady_clock::time_point mPrevTime;
+		double mAccumulator;
+		uint32_t mTick;
+	};
+}
@@ -0,0 +1,545 @@
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace Snapshot
+{
+	// 엔티티 하나의 첫 varint = (앞 엔티티와의 ID 차이 << TAG_BITS) | 태그
+	// ID 차이는 메시지마다 0부터 다시 세서 나눠 보낸 메시지를 각자 해석할 수 있음
+	enum : uint8_t
+	{
+		TAG_BITS = 3,
+
+		TAG_REMOVED = 0,
+
+		// 기준 대비 차이를 zigzag varint로, 바뀐 축만
+		TAG_DELTA_X = 1,
+		TAG_DELTA_Y = 2,
+		TAG_DELTA_XY = TAG_DELTA_X | TAG_DELTA_Y,
+
+		// 기준에 없던 엔티티, 위치 전체
+		TAG_NEW = 4
+	};
+
+	enum
+	{
+		// ID 키 5바이트 + 축마다 최대 4바이트 (24비트 양자화의 zigzag)
+		MAX_ENTRY_SIZE = 16,
+
+		MAX_CHUNK_PAYLOAD_SIZE = Protocol::MAX_MESSAGE_SIZE - sizeof(Protocol::MessageHeader),
+
+		// 서버가 ack를 기다리는 스냅샷 수보다 하나 더 보관하면 서버가 고를 수 있는 기준은 항상 남아 있음
+		MAX_RECEIVED_FRAMES = MAX_PENDING_FRAMES + 1
+	};
+
+	static size_t writeVarint(uint8_t* pOut, uint64_t value)
+	{
+		size_t size = 0;
+		while (value >= 0x80)
+		{
+			pOut[size++] = static_cast<uint8_t>(value | 0x80);
+			value >>= 7;
+		}
+
+		pOut[size++] = static_cast<uint8_t>(value);
+
+		return size;
+	}
+
+	static size_t getVarintSize(uint64_t value)
+	{
+		size_t size = 1;
+		while (value >= 0x80)
+		{
+			value >>= 7;
+			++size;
+		}
+
+		return size;
+	}
+
+	// 실패하면 false, 성공하면 pData와 remainingSize를 읽은 만큼 옮김
+	static bool readVarint(const uint8_t*& pData, size_t& remainingSize, uint64_t& outValue)
+	{
+		outValue = 0;
+		for (unsigned shift = 0; shift < 64 && remainingSize > 0; shift += 7)
+		{
+			const uint8_t byte = *pData++;
+			--remainingSize;
+
+			outValue |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	static uint32_t zigzag(const uint32_t value, const uint32_t baseline)
+	{
+		const int32_t delta = static_cast<int32_t>(value - baseline);
+
+		return (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+	}
+
+	static uint32_t unzigzag(const uint32_t encoded, const uint32_t baseline)
+	{
+		const uint32_t delta = (encoded >> 1) ^ (0u - (encoded & 1));
+
+		return baseline + delta;
+	}
+
+	// tick1이 tick2보다 앞이면 true, 래핑 고려
+	static bool isOlderTick(const uint32_t tick1, const uint32_t tick2)
+	{
+		return static_cast<int32_t>(tick1 - tick2) < 0;
+	}
+
+	// 나눠 보낼 MSG_SNAPSHOT 하나를 채우는 중인 상태
+	class ChunkWriter
+	{
+	public:
+		ChunkWriter(const uint32_t tick, const uint32_t baselineTick, std::vector<uint8_t>& outMessages)
+			: mTick(tick)
+			, mOutMessages(outMessages)
+			, mSize(sizeof(Protocol::SnapshotPayloadHeader))
+			, mPrevId(0)
+			, mEntryCount(0)
+			, mResult{ 0, 0, 0 }
+		{
+			Protocol::SnapshotPayloadHeader header;
+			header.baselineTick = baselineTick;
+			header.flags = 0;
+			memcpy(mPayload, &header, sizeof(header));
+		}
+
+		void WriteEntry(const uint32_t entityId, const uint8_t tag, const uint32_t value1, const uint32_t value2)
+		{
+			if (mSize + MAX_ENTRY_SIZE > sizeof(mPayload))
+			{
+				flush(false);
+			}
+
+			mSize += writeVarint(mPayload + mSize, (static_cast<uint64_t>(entityId - mPrevId) << TAG_BITS) | tag);
+			if (tag == TAG_NEW || tag == TAG_DELTA_XY)
+			{
+				mSize += writeVarint(mPayload + mSize, value1);
+				mSize += writeVarint(mPayload + mSize, value2);
+			}
+			else if (tag != TAG_REMOVED)
+			{
+				mSize += writeVarint(mPayload + mSize, value1);
+			}
+
+			mPrevId = entityId;
+			++mEntryCount;
+		}
+
+		// bForce면 엔티티가 없어도 마지막 메시지를 보냄
+		EncodeResult Finish(const bool bForce)
+		{
+			if (mEntryCount > 0 || bForce)
+			{
+				flush(true);
+			}
+
+			return mResult;
+		}
+
+	private:
+		void flush(const bool bLast)
+		{
+			mPayload[offsetof(Protocol::SnapshotPayloadHeader, flags)] = bLast ? Protocol::SNAPSHOT_LAST_CHUNK : 0;
+
+			const size_t offset = mOutMessages.size();
+			const size_t messageSize = sizeof(Protocol::MessageHeader) + mSize;
+			mOutMessages.resize(offset + messageSize);
+
+			Protocol::WriteMessage(mOutMessages.data() + offset, messageSize, Protocol::MSG_SNAPSHOT, 0, mTick, mPayload, mSize);
+
+			mResult.size += messageSize;
+			++mResult.messageCount;
+
+			mSize = sizeof(Protocol::SnapshotPayloadHeader);
+			mPrevId = 0;
+		}
+
+	private:
+		uint32_t mTick;
+		std::vector<uint8_t>& mOutMessages;
+
+		uint8_t mPayload[MAX_CHUNK_PAYLOAD_SIZE];
+		size_t mSize;
+		uint32_t mPrevId;
+		size_t mEntryCount;
+
+		EncodeResult mResult;
+	};
+
+	// 전체 스냅샷 크기 추정, 메시지를 나누며 ID 차이를 다시 세는 비용은 무시
+	static size_t getFullSize(const Frame& frame)
+	{
+		size_t entriesSize = 0;
+		uint32_t prevId = 0;
+		for (const EntityState& entity : frame.entities)
+		{
+			entriesSize += getVarintSize((static_cast<uint64_t>(entity.entityId - prevId) << TAG_BITS) | TAG_NEW)
+				+ getVarintSize(entity.x) + getVarintSize(entity.y);
+			prevId = entity.entityId;
+		}
+
+		const size_t chunkCapacity = MAX_CHUNK_PAYLOAD_SIZE - sizeof(Protocol::SnapshotPayloadHeader) - MAX_ENTRY_SIZE;
+		const size_t chunkCount = std::max<size_t>(1, (entriesSize + chunkCapacity - 1) / chunkCapacity);
+
+		return entriesSize + chunkCount * (sizeof(Protocol::MessageHeader) + sizeof(Protocol::SnapshotPayloadHeader));
+	}
+
+	EncodeResult WriteMessages(const Frame* pBaseline, const Frame& current, std::vector<uint8_t>& outMessages)
+	{
+		ChunkWriter writer(current.tick, pBaseline != nullptr ? pBaseline->tick : NO_BASELINE, outMessages);
+
+		if (pBaseline == nullptr)
+		{
+			for (const EntityState& entity : current.entities)
+			{
+				writer.WriteEntry(entity.entityId, TAG_NEW, entity.x, entity.y);
+			}
+		}
+		else
+		{
+			// 두 프레임 모두 ID 순이므로 한 번에 병합하며 비교
+			const std::vector<EntityState>& baseline = pBaseline->entities;
+			const std::vector<EntityState>& entities = current.entities;
+
+			size_t i = 0;
+			size_t j = 0;
+			while (i < baseline.size() || j < entities.size())
+			{
+				if (j == entities.size() || (i < baseline.size() && baseline[i].entityId < entities[j].entityId))
+				{
+					writer.WriteEntry(baseline[i].entityId, TAG_REMOVED, 0, 0);
+					++i;
+				}
+				else if (i == baseline.size() || entities[j].entityId < baseline[i].entityId)
+				{
+					writer.WriteEntry(entities[j].entityId, TAG_NEW, entities[j].x, entities[j].y);
+					++j;
+				}
+				else
+				{
+					const EntityState& from = baseline[i];
+					const EntityState& to = entities[j];
+
+					const uint8_t tag = (from.x != to.x ? TAG_DELTA_X : 0) | (from.y != to.y ? TAG_DELTA_Y : 0);
+					if (tag == TAG_DELTA_X)
+					{
+						writer.WriteEntry(to.entityId, tag, zigzag(to.x, from.x), 0);
+					}
+					else if (tag == TAG_DELTA_Y)
+					{
+						writer.WriteEntry(to.entityId, tag, zigzag(to.y, from.y), 0);
+					}
+					else if (tag == TAG_DELTA_XY)
+					{
+						writer.WriteEntry(to.entityId, tag, zigzag(to.x, from.x), zigzag(to.y, from.y));
+					}
+
+					++i;
+					++j;
+				}
+			}
+		}
+
+		// 전체 스냅샷은 비어 있어도 보내야 클라이언트가 ack해서 기준이 생김
+		EncodeResult result = writer.Finish(pBaseline == nullptr);
+		result.fullSize = getFullSize(current);
+
+		return result;
+	}
+
+	EncodeCache::EncodeCache()
+		: mEncodeCount(0)
+	{
+	}
+
+	void EncodeCache::Reset(const FramePtr& pFrame)
+	{
+		mpFrame = pFrame;
+		mEntries.clear();
+		mMessages.clear();
+	}
+
+	EncodeResult EncodeCache::Get(const FramePtr& pBaseline, const uint8_t*& outpMessages)
+	{
+		for (const Entry& entry : mEntries)
+		{
+			if (entry.pBaseline == pBaseline)
+			{
+				outpMessages = mMessages.data() + entry.offset;
+				return entry.result;
+			}
+		}
+
+		const size_t offset = mMessages.size();
+		const EncodeResult result = WriteMessages(pBaseline.get(), *mpFrame, mMessages);
+		++mEncodeCount;
+
+		mEntries.push_back({ pBaseline, offset, result });
+
+		outpMessages = mMessages.data() + offset;
+		return result;
+	}
+
+	Sender::Sender()
+		: mFullCount(0)
+		, mBaselineLossCount(0)
+	{
+	}
+
+	void Sender::OnAck(const uint32_t tick)
+	{
+		for (size_t i = 0; i < mSentFrames.size(); ++i)
+		{
+			if (mSentFrames[i]->tick != tick)
+			{
+				continue;
+			}
+
+			// 더 오래된 스냅샷은 이제 기준으로 쓰지 않음
+			mpBaseline = mSentFrames[i];
+			mSentFrames.erase(mSentFrames.begin(), mSentFrames.begin() + i + 1);
+
+			return;
+		}
+	}
+
+	EncodeResult Sender::Write(EncodeCache& cache, const uint8_t*& outpMessages)
+	{
+		// ack가 너무 오래 오지 않으면 클라이언트가 기준을 갖고 있다고 믿을 수 없음
+		if (mSentFrames.size() >= MAX_PENDING_FRAMES)
+		{
+			mSentFrames.clear();
+			mpBaseline.reset();
+			++mBaselineLossCount;
+		}
+
+		const EncodeResult result = cache.Get(mpBaseline, outpMessages);
+		if (result.size == 0)
+		{
+			return result;
+		}
+
+		if (mpBaseline == nullptr)
+		{
+			++mFullCount;
+		}
+
+		mSentFrames.push_back(cache.GetFrame());
+
+		return result;
+	}
+
+	Receiver::Receiver()
+		: mbPending(false)
+		, mPendingTick(0)
+		, mPendingBaselineTick(NO_BASELINE)
+	{
+	}
+
+	Receiver::EResult Receiver::Receive(const Protocol::MessageView& message)
+	{
+		Protocol::SnapshotPayloadHeader header;
+		if (message.payloadSize < sizeof(header))
+		{
+			mbPending = false;
+			return RESULT_ERROR;
+		}
+
+		memcpy(&header, message.pPayload, sizeof(header));
+
+		// 새 스냅샷이 시작되면 다 받지 못한 이전 스냅샷은 버림
+		if (!mbPending || message.header.tick != mPendingTick)
+		{
+			mbPending = true;
+			mPendingTick = message.header.tick;
+			mPendingBaselineTick = header.baselineTick;
+			mChanges.clear();
+		}
+		else if (header.baselineTick != mPendingBaselineTick)
+		{
+			mbPending = false;
+			return RESULT_ERROR;
+		}
+
+		const uint8_t* pData = message.pPayload + sizeof(header);
+		size_t remainingSize = message.payloadSize - sizeof(header);
+		uint32_t prevId = 0;
+
+		while (remainingSize > 0)
+		{
+			uint64_t key;
+			if (!readVarint(pData, remainingSize, key))
+			{
+				mbPending = false;
+				return RESULT_ERROR;
+			}
+
+			Change change;
+			change.entityId = static_cast<uint32_t>(prevId + (key >> TAG_BITS));
+			change.tag = static_cast<uint8_t>(key & ((1u << TAG_BITS) - 1));
+			change.x = 0;
+			change.y = 0;
+
+			uint64_t value1 = 0;
+			uint64_t value2 = 0;
+			bool bValid = change.tag <= TAG_NEW;
+			if (change.tag == TAG_NEW || change.tag == TAG_DELTA_XY)
+			{
+				bValid = bValid && readVarint(pData, remainingSize, value1) && readVarint(pData, remainingSize, value2);
+			}
+			else if (change.tag != TAG_REMOVED)
+			{
+				bValid = bValid && readVarint(pData, remainingSize, value1);
+			}
+
+			// 스냅샷 전체에서 ID가 오름차순이어야 기준과 한 번에 병합할 수 있음
+			if (!bValid || (!mChanges.empty() && change.entityId <= mChanges.back().entityId))
+			{
+				mbPending = false;
+				return RESULT_ERROR;
+			}
+
+			change.x = static_cast<uint32_t>(change.tag == TAG_DELTA_Y ? 0 : value1);
+			change.y = static_cast<uint32_t>(change.tag == TAG_DELTA_Y ? value1 : value2);
+
+			mChanges.push_back(change);
+			prevId = change.entityId;
+		}
+
+		if ((header.flags & Protocol::SNAPSHOT_LAST_CHUNK) == 0)
+		{
+			return RESULT_PENDING;
+		}
+
+		mbPending = false;
+
+		const bool bHasBaseline = mPendingBaselineTick != NO_BASELINE;
+
+		// 서버의 기준은 ack 순서로만 바뀌므로 이번 기준보다 오래된 프레임은 다시 쓰이지 않음
+		// 지운 프레임의 메모리는 새 프레임에 재사용
+		Frame frame;
+		while (!mFrames.empty()
+			&& ((bHasBaseline && isOlderTick(mFrames.front().tick, mPendingBaselineTick))
+				|| (mFrames.size() >= MAX_RECEIVED_FRAMES && mFrames.front().tick != mPendingBaselineTick)))
+		{
+			frame.entities.swap(mFrames.front().entities);
+			mFrames.pop_front();
+		}
+
+		const Frame* pBaseline = nullptr;
+		if (bHasBaseline)
+		{
+			for (const Frame& received : mFrames)
+			{
+				if (received.tick == mPendingBaselineTick)
+				{
+					pBaseline = &received;
+					break;
+				}
+			}
+
+			if (pBaseline == nullptr)
+			{
+				return RESULT_ERROR;
+			}
+		}
+
+		frame.tick = mPendingTick;
+		if (!applyChanges(pBaseline, frame))
+		{
+			return RESULT_ERROR;
+		}
+
+		mFrames.push_back(std::move(frame));
+
+		return RESULT_FRAME;
+	}
+
+	bool Receiver::applyChanges(const Frame* pBaseline, Frame& outFrame) const
+	{
+		std::vector<EntityState>& entities = outFrame.entities;
+		entities.clear();
+
+		if (pBaseline == nullptr)
+		{
+			for (const Change& change : mChanges)
+			{
+				if (change.tag != TAG_NEW)
+				{
+					return false;
+				}
+
+				entities.push_back({ change.entityId, change.x, change.y });
+			}
+
+			return true;
+		}
+
+		const std::vector<EntityState>& baseline = pBaseline->entities;
+		entities.reserve(baseline.size() + mChanges.size());
+
+		size_t i = 0;
+		for (const Change& change : mChanges)
+		{
+			// 바뀌지 않은 엔티티는 기준에서 그대로 복사
+			while (i < baseline.size() && baseline[i].entityId < change.entityId)
+			{
+				entities.push_back(baseline[i++]);
+			}
+
+			const bool bInBaseline = i < baseline.size() && baseline[i].entityId == change.entityId;
+			if (change.tag == TAG_NEW)
+			{
+				if (bInBaseline)
+				{
+					return false;
+				}
+
+				entities.push_back({ change.entityId, change.x, change.y });
+				continue;
+			}
+
+			if (!bInBaseline)
+			{
+				return false;
+			}
+
+			const EntityState& from = baseline[i++];
+			if (change.tag == TAG_REMOVED)
+			{
+				continue;
+			}
+
+			EntityState to = from;
+			if ((change.tag & TAG_DELTA_X) != 0)
+			{
+				to.x = unzigzag(change.x, from.x);
+			}
+
+			if ((change.tag & TAG_DELTA_Y) != 0)
+			{
+				to.y = unzigzag(change.y, from.y);
+			}
+
+			entities.push_back(to);
+		}
+
+		entities.insert(entities.end(), baseline.begin() + i, baseline.end());
+
+		return true;
+	}
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "Protocol.h"
+
+// 전용 서버의 엔티티 스냅샷과 delta 압축
+// 서버는 클라이언트가 마지막으로 ack한 스냅샷을 기준으로 바뀐 필드만 보내고
+// 기준이 없거나 너무 오래되면 전체 스냅샷을 보냄
+namespace Snapshot
+{
+	enum : uint32_t
+	{
+		NO_BASELINE = 0xffffffff
+	};
+
+	enum
+	{
+		// ack를 기다리는 스냅샷이 이만큼 쌓이면 기준을 잃은 것으로 보고 전체 스냅샷으로 다시 시작
+		MAX_PENDING_FRAMES = 32
+	};
+
+	// 위치는 POSITION_BITS로 양자화한 값, 양자화 단위에서 비교하므로 전송 정밀도 아래의 변화는 보내지 않음
+	struct EntityState
+	{
+		uint32_t entityId;
+		uint32_t x;
+		uint32_t y;
+	};
+
+	// entities는 entityId 오름차순
+	struct Frame
+	{
+		uint32_t tick;
+		std::vector<EntityState> entities;
+	};
+
+	// 같은 시야의 클라이언트들이 같은 프레임을 공유, 만든 뒤에는 바꾸지 않음
+	typedef std::shared_ptr<const Frame> FramePtr;
+
+	struct EncodeResult
+	{
+		// outMessages에 추가한 바이트와 메시지 수, 바뀐 게 없으면 0
+		size_t size;
+		size_t messageCount;
+
+		// 같은 프레임을 전체 스냅샷으로 보냈을 때의 바이트, 압축률 계산용
+		size_t fullSize;
+	};
+
+	// pBaseline 대비 추가/삭제/바뀐 엔티티를 MSG_SNAPSHOT 메시지들로 outMessages 뒤에 추가
+	// pBaseline이 nullptr이면 전체 스냅샷, 기준이 있는데 바뀐 게 없으면 아무것도 쓰지 않음
+	EncodeResult WriteMessages(const Frame* pBaseline, const Frame& current, std::vector<uint8_t>& outMessages);
+
+	// 한 프레임을 기준별로 인코딩한 메시지를 클라이언트끼리 재사용
+	// 같은 셀의 클라이언트는 같은 프레임을 ack하므로 기준 프레임도 대개 같음
+	class EncodeCache
+	{
+	public:
+		EncodeCache();
+
+		// 보낼 프레임을 바꾸고 이전 결과는 버림, 버퍼 메모리는 재사용
+		void Reset(const FramePtr& pFrame);
+
+		const FramePtr& GetFrame() const
+		{
+			return mpFrame;
+		}
+
+		// pBaseline 대비 메시지, 처음 보는 기준이면 인코딩해서 보관
+		// outpMessages는 다음 Get이나 Reset 전까지 유효
+		EncodeResult Get(const FramePtr& pBaseline, const uint8_t*& outpMessages);
+
+		// 실제로 인코딩한 횟수, 재사용률 계산용
+		uint64_t GetEncodeCount() const
+		{
+			return mEncodeCount;
+		}
+
+	private:
+		struct Entry
+		{
+			// 기준은 포인터로 구분, 틱이 같아도 셀이 다르면 다른 프레임
+			FramePtr pBaseline;
+			size_t offset;
+			EncodeResult result;
+		};
+
+		FramePtr mpFrame;
+		std::vector<Entry> mEntries;
+		std::vector<uint8_t> mMessages;
+
+		uint64_t mEncodeCount;
+	};
+
+	// 서버 쪽, 클라이언트 하나에 보낸 스냅샷과 ack된 기준을 관리
+	class Sender
+	{
+	public:
+		Sender();
+
+		void OnAck(const uint32_t tick);
+
+		// cache의 프레임을 기준이 있으면 delta, 없으면 전체 스냅샷으로 꺼내고 ack를 기다리는 목록에 추가
+		// outpMessages는 cache가 가진 메시지, 바뀐 게 없으면 크기 0
+		EncodeResult Write(EncodeCache& cache, const uint8_t*& outpMessages);
+
+		bool HasBaseline() const
+		{
+			return mpBaseline != nullptr;
+		}
+
+		// 기준 없이 보낸 스냅샷 수
+		uint64_t GetFullCount() const
+		{
+			return mFullCount;
+		}
+
+		// ack가 오지 않아 기준을 버린 횟수
+		uint64_t GetBaselineLossCount() const
+		{
+			return mBaselineLossCount;
+		}
+
+	private:
+		// 보냈지만 아직 ack가 오지 않은 스냅샷, 오래된 것부터
+		std::deque<FramePtr> mSentFrames;
+		FramePtr mpBaseline;
+
+		uint64_t mFullCount;
+		uint64_t mBaselineLossCount;
+	};
+
+	// 클라이언트 쪽, 나눠 온 MSG_SNAPSHOT을 모아서 기준 프레임에 적용
+	class Receiver
+	{
+	public:
+		enum EResult
+		{
+			// 같은 스냅샷의 다음 메시지를 기다림
+			RESULT_PENDING,
+
+			// 스냅샷 완성, GetLatest()로 확인하고 그 틱으로 MSG_SNAPSHOT_ACK를 보냄
+			RESULT_FRAME,
+
+			// 기준 프레임이 없거나 형식이 잘못됨, 이 스냅샷은 버림
+			RESULT_ERROR
+		};
+
+		Receiver();
+
+		EResult Receive(const Protocol::MessageView& message);
+
+		bool HasFrame() const
+		{
+			return !mFrames.empty();
+		}
+
+		const Frame& GetLatest() const
+		{
+			return mFrames.back();
+		}
+
+	private:
+		struct Change
+		{
+			uint32_t entityId;
+			uint8_t tag;
+			uint32_t x;
+			uint32_t y;
+		};
+
+		bool applyChanges(const Frame* pBaseline, Frame& outFrame) const;
+
+	private:
+		// 서버가 기준으로 쓸 수 있는 프레임, 오래된 것부터
+		std::deque<Frame> mFrames;
+
+		// 받는 중인 스냅샷
+		bool mbPending;
+		uint32_t mPendingTick;
+		uint32_t mPendingBaselineTick;
+		std::vector<Change> mChanges;
+	};
+}
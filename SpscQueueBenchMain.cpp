@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Concurrency.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(const Clock::time_point startTime)
+{
+	return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+static uint64_t getTimeNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// App의 PeerSnapshot과 비슷한 크기
+struct Item
+{
+	uint64_t sendTime;
+	uint64_t words[3];
+};
+
+// App.cpp의 sPeerSnapshotQueue와 같은 용량
+static Concurrency::SpscQueue<Item, 256> sRequests;
+static Concurrency::SpscQueue<Item, 256> sReplies;
+
+// 코어가 하나뿐이면 상대 스레드가 돌 수 있도록 양보
+static bool sbYield = false;
+
+static void wait()
+{
+	if (sbYield)
+	{
+		std::this_thread::yield();
+	}
+}
+
+// 받은 항목을 그대로 돌려보냄
+static void echo(const uint32_t count)
+{
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Item item;
+		while (!sRequests.TryPop(item))
+		{
+			wait();
+		}
+
+		while (!sReplies.TryPush(item))
+		{
+			wait();
+		}
+	}
+}
+
+static double getPercentile(const std::vector<uint64_t>& samples, const double percentile)
+{
+	return static_cast<double>(samples[static_cast<size_t>(percentile * (samples.size() - 1) + 0.5)]);
+}
+
+// 한 번에 하나씩 보내고 돌아올 때까지 기다림, 왕복의 절반을 한 방향 전달 시간으로 봄
+static void benchHandoffLatency(const uint32_t count)
+{
+	std::vector<uint64_t> samples;
+	samples.reserve(count);
+
+	std::thread echoThread(echo, count);
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Item item = {};
+		item.sendTime = getTimeNs();
+
+		while (!sRequests.TryPush(item))
+		{
+			wait();
+		}
+
+		while (!sReplies.TryPop(item))
+		{
+			wait();
+		}
+
+		samples.push_back((getTimeNs() - item.sendTime) / 2);
+	}
+
+	echoThread.join();
+
+	std::sort(samples.begin(), samples.end());
+
+	std::cout << "handoff latency (half round trip): p50 " << getPercentile(samples, 0.5) << " ns"
+		<< " | p99 " << getPercentile(samples, 0.99) << " ns"
+		<< " | max " << getPercentile(samples, 1.0) << " ns" << std::endl;
+}
+
+// 생산자가 쉬지 않고 넣고 소비자가 꺼내는 처리량
+static void benchThroughput(const uint32_t count)
+{
+	std::atomic<uint64_t> checksum(0);
+
+	const Clock::time_point startTime = Clock::now();
+
+	std::thread consumer([count, &checksum]()
+	{
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			Item item;
+			while (!sRequests.TryPop(item))
+			{
+				wait();
+			}
+
+			sum += item.sendTime;
+		}
+
+		checksum.store(sum);
+	});
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Item item = {};
+		item.sendTime = i;
+
+		while (!sRequests.TryPush(item))
+		{
+			wait();
+		}
+	}
+
+	consumer.join();
+
+	const double elapsed = getSeconds(startTime);
+
+	std::cout << "throughput: " << count / elapsed / 1e6 << " M items/s"
+		<< " | " << elapsed * 1e9 / count << " ns per item"
+		<< " (checksum " << checksum.load() << ")" << std::endl;
+}
+
+// 두 스레드 사이에서 SpscQueue로 항목 하나를 넘기는 시간과 처리량
+// 사용법: SimpleNetworkSpscQueueBench [--items N] [--yield]
+// --yield는 큐가 비거나 찼을 때 바쁜 대기 대신 양보, 코어가 하나면 필요
+int main(int argc, char* argv[])
+{
+	uint32_t count = 1000000;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--items") == 0 && bHasValue)
+		{
+			count = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else if (strcmp(argv[i], "--yield") == 0)
+		{
+			sbYield = true;
+		}
+		else
+		{
+			std::cerr << "usage: SimpleNetworkSpscQueueBench [--items N] [--yield]" << std::endl;
+			return 1;
+		}
+	}
+
+	if (count == 0)
+	{
+		std::cerr << "--items must be positive" << std::endl;
+		return 1;
+	}
+
+	if (!sbYield && std::thread::hardware_concurrency() < 2)
+	{
+		std::cerr << "only one core, busy waiting would measure the scheduler; pass --yield" << std::endl;
+		return 1;
+	}
+
+	benchHandoffLatency(count / 10 > 0 ? count / 10 : 1);
+	benchThroughput(count);
+
+	return 0;
+}
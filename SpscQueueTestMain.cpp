@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "Concurrency.h"
+
+// App의 PeerSnapshot처럼 여러 워드로 된 항목, 한 워드만 새 값이면 찢어진 읽기
+struct Item
+{
+	uint64_t sequence;
+	uint64_t words[7];
+};
+
+// 작은 용량으로 가득 참/빔과 인덱스 wrap을 자주 겪게 함
+static Concurrency::SpscQueue<Item, 16> sQueue;
+
+static uint64_t getWord(const uint64_t sequence, const int index)
+{
+	return sequence * 0x9e3779b97f4a7c15ull + static_cast<uint64_t>(index);
+}
+
+static void produce(const uint64_t count)
+{
+	for (uint64_t sequence = 0; sequence < count; ++sequence)
+	{
+		Item item;
+		item.sequence = sequence;
+		for (int i = 0; i < 7; ++i)
+		{
+			item.words[i] = getWord(sequence, i);
+		}
+
+		while (!sQueue.TryPush(item))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+// 순서대로 빠짐없이, 찢어지지 않은 항목만 나와야 함, 틀린 항목 수 반환
+static uint64_t consume(const uint64_t count)
+{
+	uint64_t errorCount = 0;
+
+	for (uint64_t expected = 0; expected < count; ++expected)
+	{
+		Item item;
+		while (!sQueue.TryPop(item))
+		{
+			std::this_thread::yield();
+		}
+
+		bool bValid = item.sequence == expected;
+		for (int i = 0; i < 7; ++i)
+		{
+			bValid &= item.words[i] == getWord(expected, i);
+		}
+
+		if (!bValid)
+		{
+			if (errorCount == 0)
+			{
+				std::cerr << "expected item " << expected << ", got " << item.sequence << std::endl;
+			}
+
+			++errorCount;
+		}
+	}
+
+	return errorCount;
+}
+
+// 생산자/소비자 스레드 둘로 SpscQueue에 항목을 흘려보내며 순서와 내용 확인
+// 메모리 순서 오류는 -DSANITIZE_THREAD=ON으로 빌드해서 ThreadSanitizer로 잡음
+// 사용법: SimpleNetworkSpscQueueTest [--items N]
+// 틀린 항목이 하나라도 있으면 1을 반환
+int main(int argc, char* argv[])
+{
+	uint64_t count = 1000000;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--items") == 0 && bHasValue)
+		{
+			count = strtoull(argv[++i], nullptr, 10);
+		}
+		else
+		{
+			std::cerr << "usage: SimpleNetworkSpscQueueTest [--items N]" << std::endl;
+			return 1;
+		}
+	}
+
+	uint64_t errorCount = 0;
+
+	std::thread consumer([count, &errorCount]()
+	{
+		errorCount = consume(count);
+	});
+
+	produce(count);
+	consumer.join();
+
+	// 소비자가 모두 꺼냈으면 비어 있어야 함
+	Item item;
+	const bool bEmpty = !sQueue.TryPop(item);
+
+	std::cout << "spsc queue: " << count << " items, " << errorCount << " errors"
+		<< (bEmpty ? "" : ", queue not empty") << std::endl;
+
+	return errorCount == 0 && bEmpty ? 0 : 1;
+}
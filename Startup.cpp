@@ -0,0 +1,168 @@
+#include "Startup.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace Startup
+{
+	TaskGraph::TaskGraph()
+		: mRemainingCount(0)
+		, mWallTime(0.0)
+		, mThreadCount(0)
+	{
+	}
+
+	TaskGraph::TaskId TaskGraph::Add(const char* pName, std::function<void()> task, std::initializer_list<TaskId> dependencies, const EThread thread)
+	{
+		const TaskId id = mTasks.size();
+
+		Task newTask;
+		newTask.pName = pName;
+		newTask.function = std::move(task);
+		newTask.pendingCount = dependencies.size();
+		newTask.thread = thread;
+		newTask.startTime = 0.0;
+		newTask.duration = 0.0;
+		newTask.threadIndex = 0;
+
+		for (const TaskId dependency : dependencies)
+		{
+			assert(dependency < id);
+			mTasks[dependency].dependents.push_back(id);
+		}
+
+		mTasks.push_back(std::move(newTask));
+
+		return id;
+	}
+
+	void TaskGraph::Run(const unsigned workerCount)
+	{
+		mStartTime = std::chrono::steady_clock::now();
+		mRemainingCount = mTasks.size();
+		mThreadCount = 1 + workerCount;
+
+		for (TaskId id = 0; id < mTasks.size(); ++id)
+		{
+			if (mTasks[id].pendingCount == 0)
+			{
+				(mTasks[id].thread == MAIN_THREAD ? mReadyMainTasks : mReadyTasks).push_back(id);
+			}
+		}
+
+		std::vector<std::thread> workers;
+		workers.reserve(workerCount);
+		for (unsigned i = 0; i < workerCount; ++i)
+		{
+			workers.emplace_back([this, i]() { runTasks(1 + i, false, false); });
+		}
+
+		runTasks(0, true, workerCount == 0);
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+
+		mWallTime = getElapsedTime();
+	}
+
+	void TaskGraph::PrintProfile(std::ostream& stream) const
+	{
+		std::vector<const Task*> tasks;
+		double totalDuration = 0.0;
+		for (const Task& task : mTasks)
+		{
+			tasks.push_back(&task);
+			totalDuration += task.duration;
+		}
+
+		std::sort(tasks.begin(), tasks.end(), [](const Task* pA, const Task* pB) { return pA->startTime < pB->startTime; });
+
+		// 스트림 형식을 바꾸지 않도록 따로 만들어서 한 번에 출력
+		std::ostringstream text;
+		text << std::fixed << std::setprecision(1)
+			<< "Startup " << mWallTime * 1000.0 << " ms on " << mThreadCount << " threads"
+			<< " (stages " << totalDuration * 1000.0 << " ms in total)" << std::endl;
+
+		for (const Task* pTask : tasks)
+		{
+			text << "  " << std::left << std::setw(16) << pTask->pName << std::right
+				<< " at " << std::setw(7) << pTask->startTime * 1000.0 << " ms"
+				<< " took " << std::setw(7) << pTask->duration * 1000.0 << " ms";
+
+			if (pTask->threadIndex == 0)
+			{
+				text << "  [main]" << std::endl;
+			}
+			else
+			{
+				text << "  [worker " << pTask->threadIndex << ']' << std::endl;
+			}
+		}
+
+		stream << text.str();
+	}
+
+	void TaskGraph::runTasks(const unsigned threadIndex, const bool bMainThread, const bool bRunAll)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		while (mRemainingCount > 0)
+		{
+			std::vector<TaskId>* pReadyTasks = nullptr;
+			if (bMainThread && !mReadyMainTasks.empty())
+			{
+				pReadyTasks = &mReadyMainTasks;
+			}
+			else if ((!bMainThread || bRunAll) && !mReadyTasks.empty())
+			{
+				pReadyTasks = &mReadyTasks;
+			}
+
+			if (pReadyTasks == nullptr)
+			{
+				mCondition.wait(lock);
+				continue;
+			}
+
+			// 먼저 준비된 단계부터
+			const TaskId id = pReadyTasks->front();
+			pReadyTasks->erase(pReadyTasks->begin());
+
+			// 실행 중에는 다른 스레드가 이 단계를 건드리지 않음
+			Task& task = mTasks[id];
+
+			lock.unlock();
+
+			const double startTime = getElapsedTime();
+			task.function();
+			const double endTime = getElapsedTime();
+
+			lock.lock();
+
+			task.startTime = startTime;
+			task.duration = endTime - startTime;
+			task.threadIndex = threadIndex;
+			--mRemainingCount;
+
+			for (const TaskId dependent : task.dependents)
+			{
+				if (--mTasks[dependent].pendingCount == 0)
+				{
+					(mTasks[dependent].thread == MAIN_THREAD ? mReadyMainTasks : mReadyTasks).push_back(dependent);
+				}
+			}
+
+			mCondition.notify_all();
+		}
+	}
+
+	double TaskGraph::getElapsedTime() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// 시작 단계를 의존 관계 그래프로 묶어 여러 스레드에서 동시에 실행하고 단계마다 걸린 시간을 기록
+namespace Startup
+{
+	class TaskGraph
+	{
+	public:
+		typedef size_t TaskId;
+
+		enum EThread
+		{
+			ANY_THREAD,
+
+			// 창 메시지를 받는 스레드에서 해야 하는 일 (창 생성, 스왑 체인, 즉시 컨텍스트)
+			MAIN_THREAD
+		};
+
+		TaskGraph();
+
+		// dependencies가 모두 끝난 뒤에 실행, 먼저 추가한 단계에만 의존할 수 있으므로 순환이 생기지 않음
+		TaskId Add(const char* pName, std::function<void()> task, std::initializer_list<TaskId> dependencies = {}, const EThread thread = ANY_THREAD);
+
+		// 모든 단계가 끝날 때까지 반환하지 않음
+		// 호출한 스레드는 MAIN_THREAD 단계를, 작업 스레드 workerCount개는 나머지를 실행 (0이면 호출한 스레드가 모두 실행)
+		void Run(const unsigned workerCount);
+
+		// 단계별 시작 시각과 걸린 시간, 실행한 스레드 (ms)
+		void PrintProfile(std::ostream& stream) const;
+
+		double GetWallTime() const
+		{
+			return mWallTime;
+		}
+
+	private:
+		struct Task
+		{
+			const char* pName;
+			std::function<void()> function;
+			std::vector<TaskId> dependents;
+			size_t pendingCount;
+			EThread thread;
+
+			double startTime;
+			double duration;
+			unsigned threadIndex;
+		};
+
+		// 실행할 수 있는 단계가 없으면 기다리고, 모두 끝났으면 반환
+		void runTasks(const unsigned threadIndex, const bool bMainThread, const bool bRunAll);
+
+		double getElapsedTime() const;
+
+	private:
+		std::vector<Task> mTasks;
+
+		// 아래는 Run 동안 mMutex로 보호
+		std::vector<TaskId> mReadyTasks;
+		std::vector<TaskId> mReadyMainTasks;
+		size_t mRemainingCount;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+
+		std::chrono::steady_clock::time_point mStartTime;
+		double mWallTime;
+		unsigned mThreadCount;
+	};
+}
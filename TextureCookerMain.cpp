@@ -0,0 +1,464 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <png.h>
+
+#include "BlockCompression.h"
+#include "DdsFile.h"
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(const Clock::time_point startTime)
+{
+	return std::chrono::duration<double>(Clock::now() - startTime).count();
+}
+
+enum
+{
+	TEXEL_BYTES = 4
+};
+
+// RGBA8 행 우선
+struct Image
+{
+	uint32_t width;
+	uint32_t height;
+	std::vector<uint8_t> texels;
+};
+
+struct Format
+{
+	const char* pName;
+	uint32_t dxgiFormat;
+	uint32_t blockBytes;
+	void (*pEncode)(const uint8_t* pTexels, uint8_t* pOutBlock);
+};
+
+static const Format FORMATS[] = {
+	{ "bc1", DdsFile::FORMAT_BC1_UNORM, BlockCompression::BC1_BLOCK_BYTES, BlockCompression::EncodeBC1 },
+	{ "bc7", DdsFile::FORMAT_BC7_UNORM, BlockCompression::BC7_BLOCK_BYTES, BlockCompression::EncodeBC7 },
+};
+
+static bool loadPng(const std::string& path, Image& outImage)
+{
+	png_image png;
+	memset(&png, 0, sizeof(png));
+	png.version = PNG_IMAGE_VERSION;
+
+	if (!png_image_begin_read_from_file(&png, path.c_str()))
+	{
+		std::cerr << "failed to open " << path << ": " << png.message << std::endl;
+		return false;
+	}
+
+	// 팔레트, 그레이, 16비트 모두 RGBA8로 변환
+	png.format = PNG_FORMAT_RGBA;
+
+	outImage.width = png.width;
+	outImage.height = png.height;
+	outImage.texels.resize(PNG_IMAGE_SIZE(png));
+
+	if (!png_image_finish_read(&png, nullptr, outImage.texels.data(), 0, nullptr))
+	{
+		std::cerr << "failed to decode " << path << ": " << png.message << std::endl;
+		png_image_free(&png);
+		return false;
+	}
+
+	return true;
+}
+
+// D3D11은 블록 압축 텍스처의 mip 0 크기가 4의 배수여야 하므로 가장자리 텍셀을 반복해서 늘림
+static Image padToBlockSize(const Image& image)
+{
+	Image padded;
+	padded.width = (image.width + 3) & ~3u;
+	padded.height = (image.height + 3) & ~3u;
+	padded.texels.resize(static_cast<size_t>(padded.width) * padded.height * TEXEL_BYTES);
+
+	for (uint32_t y = 0; y < padded.height; ++y)
+	{
+		const uint8_t* pSrcRow = &image.texels[static_cast<size_t>(std::min(y, image.height - 1)) * image.width * TEXEL_BYTES];
+		uint8_t* pDstRow = &padded.texels[static_cast<size_t>(y) * padded.width * TEXEL_BYTES];
+
+		memcpy(pDstRow, pSrcRow, static_cast<size_t>(image.width) * TEXEL_BYTES);
+
+		for (uint32_t x = image.width; x < padded.width; ++x)
+		{
+			memcpy(pDstRow + x * TEXEL_BYTES, pSrcRow + (image.width - 1) * TEXEL_BYTES, TEXEL_BYTES);
+		}
+	}
+
+	return padded;
+}
+
+// 박스 필터로 절반 크기 mip, 홀수 크기면 마지막 텍셀이 남는 행/열까지 평균
+// 런타임 경로와 같이 UNORM 값 그대로 평균
+static Image makeNextMip(const Image& image)
+{
+	Image mip;
+	mip.width = std::max(image.width / 2, 1u);
+	mip.height = std::max(image.height / 2, 1u);
+	mip.texels.resize(static_cast<size_t>(mip.width) * mip.height * TEXEL_BYTES);
+
+	for (uint32_t y = 0; y < mip.height; ++y)
+	{
+		const uint32_t srcY0 = y * image.height / mip.height;
+		const uint32_t srcY1 = (y + 1) * image.height / mip.height;
+
+		for (uint32_t x = 0; x < mip.width; ++x)
+		{
+			const uint32_t srcX0 = x * image.width / mip.width;
+			const uint32_t srcX1 = (x + 1) * image.width / mip.width;
+
+			uint32_t sums[TEXEL_BYTES] = {};
+			for (uint32_t srcY = srcY0; srcY < srcY1; ++srcY)
+			{
+				for (uint32_t srcX = srcX0; srcX < srcX1; ++srcX)
+				{
+					const uint8_t* pTexel = &image.texels[(static_cast<size_t>(srcY) * image.width + srcX) * TEXEL_BYTES];
+					for (int c = 0; c < TEXEL_BYTES; ++c)
+					{
+						sums[c] += pTexel[c];
+					}
+				}
+			}
+
+			const uint32_t count = (srcX1 - srcX0) * (srcY1 - srcY0);
+			uint8_t* pTexel = &mip.texels[(static_cast<size_t>(y) * mip.width + x) * TEXEL_BYTES];
+			for (int c = 0; c < TEXEL_BYTES; ++c)
+			{
+				pTexel[c] = static_cast<uint8_t>((sums[c] + count / 2) / count);
+			}
+		}
+	}
+
+	return mip;
+}
+
+// 4x4 블록을 모음, 이미지 밖은 가장자리 텍셀 (작은 mip은 4의 배수가 아님)
+static void loadBlock(const Image& image, const uint32_t blockX, const uint32_t blockY, uint8_t* pOutTexels)
+{
+	for (uint32_t row = 0; row < BlockCompression::BLOCK_DIMENSION; ++row)
+	{
+		const uint32_t y = std::min(blockY * BlockCompression::BLOCK_DIMENSION + row, image.height - 1);
+
+		for (uint32_t column = 0; column < BlockCompression::BLOCK_DIMENSION; ++column)
+		{
+			const uint32_t x = std::min(blockX * BlockCompression::BLOCK_DIMENSION + column, image.width - 1);
+
+			memcpy(
+				pOutTexels + (row * BlockCompression::BLOCK_DIMENSION + column) * TEXEL_BYTES,
+				&image.texels[(static_cast<size_t>(y) * image.width + x) * TEXEL_BYTES],
+				TEXEL_BYTES
+			);
+		}
+	}
+}
+
+static uint32_t getBlockCount(const uint32_t size)
+{
+	return (size + BlockCompression::BLOCK_DIMENSION - 1) / BlockCompression::BLOCK_DIMENSION;
+}
+
+// 스레드마다 블록 한 행씩 가져가서 압축
+static void encodeMips(const std::vector<Image>& mips, const Format& format, const uint32_t threadCount, std::vector<uint8_t>& outData)
+{
+	struct BlockRow
+	{
+		uint32_t mip;
+		uint32_t blockY;
+		size_t offset;
+	};
+
+	std::vector<BlockRow> rows;
+	size_t offset = 0;
+
+	for (uint32_t mip = 0; mip < mips.size(); ++mip)
+	{
+		const uint32_t blockCountX = getBlockCount(mips[mip].width);
+		const uint32_t blockCountY = getBlockCount(mips[mip].height);
+
+		for (uint32_t blockY = 0; blockY < blockCountY; ++blockY)
+		{
+			const BlockRow row = { mip, blockY, offset };
+			rows.push_back(row);
+
+			offset += static_cast<size_t>(blockCountX) * format.blockBytes;
+		}
+	}
+
+	outData.resize(offset);
+
+	std::atomic<size_t> nextRow(0);
+
+	const auto encodeRows = [&]()
+	{
+		uint8_t texels[BlockCompression::BLOCK_TEXEL_COUNT * TEXEL_BYTES];
+
+		for (size_t i = nextRow.fetch_add(1); i < rows.size(); i = nextRow.fetch_add(1))
+		{
+			const BlockRow& row = rows[i];
+			const Image& image = mips[row.mip];
+			const uint32_t blockCountX = getBlockCount(image.width);
+
+			for (uint32_t blockX = 0; blockX < blockCountX; ++blockX)
+			{
+				loadBlock(image, blockX, row.blockY, texels);
+				format.pEncode(texels, &outData[row.offset + static_cast<size_t>(blockX) * format.blockBytes]);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 1; i < threadCount; ++i)
+	{
+		threads.emplace_back(encodeRows);
+	}
+
+	encodeRows();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+// mip 0을 다시 풀어서 원본(늘리기 전)과 비교한 PSNR (dB)
+static double computePsnr(const Image& source, const Format& format, const uint8_t* pBlocks)
+{
+	const uint32_t blockCountX = getBlockCount(source.width);
+	const uint32_t blockCountY = getBlockCount(source.height);
+
+	uint8_t texels[BlockCompression::BLOCK_TEXEL_COUNT * TEXEL_BYTES];
+	double squaredError = 0.0;
+
+	for (uint32_t blockY = 0; blockY < blockCountY; ++blockY)
+	{
+		for (uint32_t blockX = 0; blockX < blockCountX; ++blockX)
+		{
+			const uint8_t* pBlock = pBlocks + (static_cast<size_t>(blockY) * blockCountX + blockX) * format.blockBytes;
+
+			if (format.dxgiFormat == DdsFile::FORMAT_BC1_UNORM)
+			{
+				BlockCompression::DecodeBC1(pBlock, texels);
+			}
+			else if (!BlockCompression::DecodeBC7(pBlock, texels))
+			{
+				return 0.0;
+			}
+
+			for (uint32_t row = 0; row < BlockCompression::BLOCK_DIMENSION; ++row)
+			{
+				const uint32_t y = blockY * BlockCompression::BLOCK_DIMENSION + row;
+
+				for (uint32_t column = 0; column < BlockCompression::BLOCK_DIMENSION; ++column)
+				{
+					const uint32_t x = blockX * BlockCompression::BLOCK_DIMENSION + column;
+					if (x >= source.width || y >= source.height)
+					{
+						continue;
+					}
+
+					const uint8_t* pSource = &source.texels[(static_cast<size_t>(y) * source.width + x) * TEXEL_BYTES];
+					const uint8_t* pDecoded = texels + (row * BlockCompression::BLOCK_DIMENSION + column) * TEXEL_BYTES;
+
+					for (int c = 0; c < TEXEL_BYTES; ++c)
+					{
+						const double diff = static_cast<double>(pSource[c]) - pDecoded[c];
+						squaredError += diff * diff;
+					}
+				}
+			}
+		}
+	}
+
+	const double meanSquaredError = squaredError / (static_cast<double>(source.width) * source.height * TEXEL_BYTES);
+
+	return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : INFINITY;
+}
+
+static std::string replaceExtension(const std::string& path, const char* pExtension)
+{
+	const size_t slash = path.find_last_of("/\\");
+	const size_t dot = path.find_last_of('.');
+
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+	{
+		return path + pExtension;
+	}
+
+	return path.substr(0, dot) + pExtension;
+}
+
+static double toMegabytes(const size_t bytes)
+{
+	return bytes / (1024.0 * 1024.0);
+}
+
+// PNG를 mip 전체가 들어간 블록 압축 DDS로 변환 (DirectX::CreateDDSTextureFromFile로 읽음)
+// 사용법: SimpleNetworkTextureCooker [--format bc1|bc7] [--threads N] [--output FILE] INPUT.png
+// 출력 경로를 주지 않으면 입력 경로의 확장자를 .dds로 바꿈
+int main(int argc, char* argv[])
+{
+	const Format* pFormat = &FORMATS[1];
+	uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	std::string outputPath;
+	std::vector<const char*> positionalArgs;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--format") == 0 && bHasValue)
+		{
+			const char* pName = argv[++i];
+
+			pFormat = nullptr;
+			for (const Format& format : FORMATS)
+			{
+				if (strcmp(format.pName, pName) == 0)
+				{
+					pFormat = &format;
+				}
+			}
+
+			if (pFormat == nullptr)
+			{
+				std::cerr << "unknown format " << pName << std::endl;
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--threads") == 0 && bHasValue)
+		{
+			threadCount = std::max(static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10)), 1u);
+		}
+		else if (strcmp(argv[i], "--output") == 0 && bHasValue)
+		{
+			outputPath = argv[++i];
+		}
+		else
+		{
+			positionalArgs.push_back(argv[i]);
+		}
+	}
+
+	if (positionalArgs.size() != 1)
+	{
+		std::cerr << "usage: SimpleNetworkTextureCooker [--format bc1|bc7] [--threads N] [--output FILE] INPUT.png" << std::endl;
+		return 1;
+	}
+
+	const std::string inputPath = positionalArgs[0];
+	if (outputPath.empty())
+	{
+		outputPath = replaceExtension(inputPath, ".dds");
+	}
+
+	// 디코딩과 mip 생성은 PNG를 그대로 쓰면 시작할 때마다 하던 일
+	Clock::time_point startTime = Clock::now();
+
+	Image source;
+	if (!loadPng(inputPath, source))
+	{
+		return 1;
+	}
+
+	const double decodeSeconds = getSeconds(startTime);
+	startTime = Clock::now();
+
+	std::vector<Image> mips;
+	mips.push_back(padToBlockSize(source));
+	while (mips.back().width > 1 || mips.back().height > 1)
+	{
+		mips.push_back(makeNextMip(mips.back()));
+	}
+
+	const double mipSeconds = getSeconds(startTime);
+	startTime = Clock::now();
+
+	std::vector<uint8_t> blocks;
+	encodeMips(mips, *pFormat, threadCount, blocks);
+
+	const double encodeSeconds = getSeconds(startTime);
+
+	const double psnr = computePsnr(source, *pFormat, blocks.data());
+
+	std::vector<uint8_t> prefix(DdsFile::DX10_PREFIX_SIZE);
+	DdsFile::WriteTexture2DPrefix(
+		prefix.data(),
+		mips[0].width,
+		mips[0].height,
+		static_cast<uint32_t>(mips.size()),
+		pFormat->dxgiFormat,
+		pFormat->blockBytes
+	);
+
+	{
+		std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(prefix.data()), prefix.size());
+		file.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+
+		if (!file)
+		{
+			std::cerr << "failed to write " << outputPath << std::endl;
+			return 1;
+		}
+	}
+
+	// 런타임이 DDS에서 하는 일은 파일을 읽는 것뿐
+	startTime = Clock::now();
+
+	size_t readBytes = 0;
+	{
+		std::ifstream file(outputPath, std::ios::binary);
+		std::vector<char> data(prefix.size() + blocks.size());
+		file.read(data.data(), data.size());
+		readBytes = static_cast<size_t>(file.gcount());
+	}
+
+	const double readSeconds = getSeconds(startTime);
+
+	// PNG 경로는 원본 크기의 RGBA8 텍스처에 전체 mip
+	size_t uncompressedBytes = 0;
+	{
+		uint32_t width = source.width;
+		uint32_t height = source.height;
+		for (;;)
+		{
+			uncompressedBytes += static_cast<size_t>(width) * height * TEXEL_BYTES;
+			if (width == 1 && height == 1)
+			{
+				break;
+			}
+
+			width = std::max(width / 2, 1u);
+			height = std::max(height / 2, 1u);
+		}
+	}
+
+	std::cout << inputPath << ": " << source.width << "x" << source.height
+		<< " -> " << pFormat->pName << " " << mips[0].width << "x" << mips[0].height << ", " << mips.size() << " mips" << std::endl;
+	std::cout << "png decode: " << decodeSeconds * 1e3 << " ms | mips: " << mipSeconds * 1e3 << " ms" << std::endl;
+	std::cout << "encode: " << encodeSeconds * 1e3 << " ms (" << BlockCompression::GetInstructionSetName() << ", "
+		<< threadCount << " threads, " << blocks.size() / pFormat->blockBytes / encodeSeconds / 1e6 << " Mblocks/s)" << std::endl;
+	std::cout << "mip 0 psnr: " << psnr << " dB" << std::endl;
+	std::cout << "vram: " << toMegabytes(uncompressedBytes) << " MB rgba8 -> " << toMegabytes(blocks.size()) << " MB "
+		<< pFormat->pName << " (saved " << toMegabytes(uncompressedBytes - blocks.size()) << " MB, "
+		<< static_cast<double>(uncompressedBytes) / blocks.size() << "x)" << std::endl;
+	std::cout << "load: png decode + mips " << (decodeSeconds + mipSeconds) * 1e3 << " ms -> dds read "
+		<< readSeconds * 1e3 << " ms (" << toMegabytes(readBytes) << " MB)" << std::endl;
+	std::cout << "wrote " << outputPath << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include "TimeSync.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Simulation.h"
+
+namespace TimeSync
+{
+	// RFC 6298의 srtt 가중치와 RFC 3550의 jitter 가중치
+	static constexpr double RTT_GAIN = 1.0 / 8.0;
+	static constexpr double JITTER_GAIN = 1.0 / 16.0;
+
+	Estimator::Estimator()
+		: mSampleCount(0)
+		, mNextSample(0)
+		, mSmoothedRtt(0.0)
+		, mLastRtt(0.0)
+		, mJitter(0.0)
+		, mClockOffset(0.0)
+		, mAnchorRemoteTime(0.0)
+		, mAnchorTick(0)
+	{
+	}
+
+	void Estimator::AddSample(
+		const double pingSendTime,
+		const double remoteReceiveTime,
+		const double remoteSendTime,
+		const double pongReceiveTime,
+		const uint32_t remoteTick)
+	{
+		const double rtt = std::max((pongReceiveTime - pingSendTime) - (remoteSendTime - remoteReceiveTime), 0.0);
+
+		// 가는 길과 오는 길이 같다고 가정, 오차는 최대 rtt / 2
+		const double clockOffset = ((remoteReceiveTime - pingSendTime) + (remoteSendTime - pongReceiveTime)) * 0.5;
+
+		if (mSampleCount == 0)
+		{
+			mSmoothedRtt = rtt;
+		}
+		else
+		{
+			mSmoothedRtt += (rtt - mSmoothedRtt) * RTT_GAIN;
+			mJitter += (std::abs(rtt - mLastRtt) - mJitter) * JITTER_GAIN;
+		}
+		mLastRtt = rtt;
+
+		Sample& sample = mSamples[mNextSample];
+		sample.rtt = rtt;
+		sample.clockOffset = clockOffset;
+		sample.remoteTime = remoteSendTime;
+		sample.remoteTick = remoteTick;
+
+		mNextSample = (mNextSample + 1) % OFFSET_WINDOW;
+		mSampleCount = std::min<size_t>(mSampleCount + 1, OFFSET_WINDOW);
+
+		const Sample* pBest = &mSamples[0];
+		for (size_t i = 1; i < mSampleCount; ++i)
+		{
+			if (mSamples[i].rtt < pBest->rtt)
+			{
+				pBest = &mSamples[i];
+			}
+		}
+
+		mClockOffset = pBest->clockOffset;
+		mAnchorRemoteTime = pBest->remoteTime;
+		mAnchorTick = pBest->remoteTick;
+	}
+
+	double Estimator::RemoteTickToLocalTime(const uint32_t tick) const
+	{
+		// 틱 번호가 한 바퀴 돌아도 가까운 틱이면 차이가 맞도록 부호 있는 값으로 계산
+		const int32_t tickDelta = static_cast<int32_t>(tick - mAnchorTick);
+
+		return RemoteToLocalTime(mAnchorRemoteTime + tickDelta * Simulation::TICK_INTERVAL);
+	}
+}
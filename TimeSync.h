@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace TimeSync
+{
+	// 와이어 포맷의 시각은 단조 시계 기준 us 단위 정수
+	inline uint64_t ToWireTime(const double seconds)
+	{
+		return static_cast<uint64_t>(seconds * 1e6);
+	}
+
+	inline double FromWireTime(const uint64_t time)
+	{
+		return time * 1e-6;
+	}
+
+	// ping/pong 한 번의 네 시각으로 RTT, 흔들림, 상대 시계와의 차이를 추정 (NTP 방식)
+	class Estimator
+	{
+	public:
+		enum
+		{
+			// 최근 이만큼의 샘플 중 RTT가 가장 짧은 것의 시계 차이를 사용, 큐에 오래 머문 샘플은 오차가 큼
+			OFFSET_WINDOW = 8
+		};
+
+		Estimator();
+
+		// pingSendTime, pongReceiveTime: 로컬 시계 기준 ping을 보낸 시각과 pong을 받은 시각
+		// remoteReceiveTime, remoteSendTime: 상대 시계 기준 ping을 받은 시각과 pong을 보낸 시각
+		// remoteTick: pong을 보낼 때 상대의 틱
+		void AddSample(
+			const double pingSendTime,
+			const double remoteReceiveTime,
+			const double remoteSendTime,
+			const double pongReceiveTime,
+			const uint32_t remoteTick
+		);
+
+		bool HasSample() const
+		{
+			return mSampleCount > 0;
+		}
+
+		// 상대가 처리하느라 붙잡고 있던 시간은 뺀 왕복 시간의 평활값(초)
+		double GetRtt() const
+		{
+			return mSmoothedRtt;
+		}
+
+		double GetLastRtt() const
+		{
+			return mLastRtt;
+		}
+
+		// 연속한 RTT 차이의 평균 (RFC 3550 방식)
+		double GetJitter() const
+		{
+			return mJitter;
+		}
+
+		// 상대 시계 - 로컬 시계(초)
+		double GetClockOffset() const
+		{
+			return mClockOffset;
+		}
+
+		double RemoteToLocalTime(const double remoteTime) const
+		{
+			return remoteTime - mClockOffset;
+		}
+
+		// 상대가 tick을 시뮬레이션한 시각을 로컬 시계로, 샘플이 없으면 의미 없음
+		double RemoteTickToLocalTime(const uint32_t tick) const;
+
+	private:
+		struct Sample
+		{
+			double rtt;
+			double clockOffset;
+			double remoteTime;
+			uint32_t remoteTick;
+		};
+
+	private:
+		Sample mSamples[OFFSET_WINDOW];
+		size_t mSampleCount;
+		size_t mNextSample;
+
+		double mSmoothedRtt;
+		double mLastRtt;
+		double mJitter;
+
+		double mClockOffset;
+
+		// 틱 -> 시각 변환 기준, 시계 차이를 고른 샘플의 값
+		double mAnchorRemoteTime;
+		uint32_t mAnchorTick;
+	};
+}
@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "Channel.h"
+#include "Impairment.h"
+#include "Protocol.h"
+#include "Simulation.h"
+
+// 1ms 단위로 시간을 진행
+static constexpr double TIME_STEP = 0.001;
+
+// 리눅스 TCP의 재전송 타이머 범위 (TCP_RTO_MIN, TCP_RTO_MAX)
+static constexpr double TCP_MIN_RTO = 0.2;
+static constexpr double TCP_MAX_RTO = 120.0;
+
+// 이만큼 같은 ack가 오면 빠른 재전송 (RFC 5681)
+enum
+{
+	TCP_DUPLICATE_ACK_THRESHOLD = 3
+};
+
+struct LinkSettings
+{
+	double delay;
+	double jitter;
+	double lossRate;
+	uint32_t seed;
+};
+
+static Impairment::Config makeLinkConfig(const LinkSettings& settings, const uint32_t seed)
+{
+	Impairment::Config config = {};
+	config.delay = settings.delay;
+	config.jitter = settings.jitter;
+	config.lossRate = settings.lossRate;
+	config.seed = seed;
+
+	return config;
+}
+
+// 틱마다 보내는 위치 메시지, 헤더의 tick으로 보낸 시각을 알 수 있음
+static size_t writePositionMessage(const uint32_t tick, uint8_t* pOutMessage, const size_t bufferSize)
+{
+	Protocol::EntityPositionPayload payload;
+	payload.entityId = 1;
+	Protocol::EncodePosition(0.f, 0.f, payload.pos);
+
+	return Protocol::WriteMessage(pOutMessage, bufferSize, Protocol::MSG_ENTITY_POSITION, 0, tick, &payload, sizeof(payload));
+}
+
+static double getSendTime(const uint32_t tick)
+{
+	return tick * Simulation::TICK_INTERVAL;
+}
+
+struct Measurement
+{
+	// 받는 쪽에 새 위치가 반영될 때마다 보낸 시각부터 걸린 시간
+	std::vector<double> updateLatencies;
+
+	// 1ms마다 잰, 받는 쪽이 가진 가장 새 위치의 나이
+	std::vector<double> stateAges;
+
+	uint32_t sentCount;
+	uint32_t retransmitCount;
+};
+
+// App의 USE_UDP 경로: 틱마다 datagram 하나, UnreliableSequenced로 늦거나 중복된 패킷은 버림
+static Measurement runUdp(const LinkSettings& settings, const double duration)
+{
+	Impairment::Link link(makeLinkConfig(settings, settings.seed));
+	Channel::UnreliableSequenced channel;
+
+	Measurement measurement = {};
+	uint16_t sequence = 0;
+	uint32_t nextTick = 0;
+	double newestSendTime = -1.0;
+
+	for (double now = 0.0; now < duration; now += TIME_STEP)
+	{
+		while (getSendTime(nextTick) <= now)
+		{
+			uint8_t packet[Protocol::MAX_PACKET_SIZE];
+
+			Protocol::PacketHeader header = {};
+			header.protocolId = Protocol::PROTOCOL_ID;
+			header.sequence = sequence++;
+			memcpy(packet, &header, sizeof(header));
+
+			const size_t messageSize = writePositionMessage(nextTick, packet + sizeof(header), sizeof(packet) - sizeof(header));
+			link.Push(packet, sizeof(header) + messageSize, now);
+
+			++nextTick;
+			++measurement.sentCount;
+		}
+
+		link.ForEachArrived(now, [&](const uint8_t* pData, const size_t size)
+		{
+			Protocol::PacketHeader header;
+			memcpy(&header, pData, sizeof(header));
+			if (!channel.Accept(header.sequence))
+			{
+				return;
+			}
+
+			Protocol::MessageView message;
+			size_t length;
+			if (Protocol::ParseMessage(pData + sizeof(header), size - sizeof(header), message, length) == Protocol::PARSE_OK)
+			{
+				const double sendTime = getSendTime(message.header.tick);
+				measurement.updateLatencies.push_back(now - sendTime);
+				newestSendTime = std::max(newestSendTime, sendTime);
+			}
+		});
+
+		if (newestSendTime >= 0.0)
+		{
+			measurement.stateAges.push_back(now - newestSendTime);
+		}
+	}
+
+	return measurement;
+}
+
+// TCP 흉내: 세그먼트마다 누적 ack, 같은 ack 세 번이면 빠른 재전송, 아니면 RTO(최소 200ms, 지수 백오프)
+// RTT는 리눅스처럼 타임스탬프 옵션으로 잼, ack가 그 ack를 만든 세그먼트의 보낸 시각을 돌려줌
+// 받는 쪽은 순서대로만 전달하므로 세그먼트 하나가 빠지면 뒤의 위치도 재전송될 때까지 묶임
+// 혼잡 제어, SACK, tail loss probe는 넣지 않음, 틱당 세그먼트 하나라 혼잡 창은 제한이 되지 않음
+class TcpModel
+{
+public:
+	explicit TcpModel(const LinkSettings& settings)
+		: mDataLink(makeLinkConfig(settings, settings.seed))
+		, mAckLink(makeLinkConfig(settings, settings.seed + 1))
+		, mNextSegment(0)
+		, mUnackedSegment(0)
+		, mDuplicateAckCount(0)
+		, mbHasRttSample(false)
+		, mSmoothedRtt(0.0)
+		, mRttVariance(0.0)
+		, mResendTimeout(1.0)
+		, mBackoff(1.0)
+		, mTimerStartTime(0.0)
+		, mNextExpectedSegment(0)
+		, mRetransmitCount(0)
+	{
+	}
+
+	void Send(const uint8_t* pData, const size_t size, const double now)
+	{
+		Segment segment;
+		segment.data.assign(pData, pData + size);
+
+		if (mSegments.empty())
+		{
+			mTimerStartTime = now;
+		}
+
+		mSegments.push_back(std::move(segment));
+		transmit(mNextSegment, now);
+		++mNextSegment;
+	}
+
+	// 순서대로 받은 데이터마다 onData(pData, size)
+	template <class Callback>
+	void Update(const double now, Callback onData)
+	{
+		mDataLink.ForEachArrived(now, [&](const uint8_t* pData, const size_t size)
+		{
+			SegmentHeader header;
+			memcpy(&header, pData, sizeof(header));
+
+			if (header.index >= mNextExpectedSegment)
+			{
+				mOutOfOrder[header.index].assign(pData + sizeof(header), pData + size);
+			}
+
+			// 순서가 맞는 것부터 전달
+			std::map<uint32_t, std::vector<uint8_t>>::iterator it;
+			while ((it = mOutOfOrder.find(mNextExpectedSegment)) != mOutOfOrder.end())
+			{
+				onData(it->second.data(), it->second.size());
+				mOutOfOrder.erase(it);
+				++mNextExpectedSegment;
+			}
+
+			// 받을 때마다 바로 누적 ack (TCP_NODELAY인 상호작용 트래픽의 quick ack)
+			const SegmentHeader ack = { mNextExpectedSegment, header.transmitTime };
+			mAckLink.Push(reinterpret_cast<const uint8_t*>(&ack), sizeof(ack), now);
+		});
+
+		mAckLink.ForEachArrived(now, [&](const uint8_t* pData, const size_t)
+		{
+			SegmentHeader ack;
+			memcpy(&ack, pData, sizeof(ack));
+			onAck(ack, now);
+		});
+
+		if (!mSegments.empty() && now - mTimerStartTime >= mResendTimeout * mBackoff)
+		{
+			mBackoff = std::min(mBackoff * 2.0, TCP_MAX_RTO / mResendTimeout);
+			transmit(mUnackedSegment, now);
+		}
+	}
+
+	uint32_t GetRetransmitCount() const
+	{
+		return mRetransmitCount;
+	}
+
+private:
+	struct Segment
+	{
+		std::vector<uint8_t> data;
+	};
+
+	// 데이터 세그먼트: 세그먼트 번호와 보낸 시각
+	// ack: 다음에 받을 세그먼트 번호와 ack를 만든 세그먼트의 보낸 시각
+	struct SegmentHeader
+	{
+		uint32_t index;
+		double transmitTime;
+	};
+
+	void transmit(const uint32_t index, const double now)
+	{
+		const Segment& segment = mSegments[index - mUnackedSegment];
+		const SegmentHeader header = { index, now };
+
+		std::vector<uint8_t> packet(sizeof(header) + segment.data.size());
+		memcpy(packet.data(), &header, sizeof(header));
+		memcpy(packet.data() + sizeof(header), segment.data.data(), segment.data.size());
+
+		if (index < mNextSegment)
+		{
+			++mRetransmitCount;
+			mTimerStartTime = now;
+		}
+
+		mDataLink.Push(packet.data(), packet.size(), now);
+	}
+
+	void onAck(const SegmentHeader& ackHeader, const double now)
+	{
+		const uint32_t ack = ackHeader.index;
+		if (ack > mUnackedSegment)
+		{
+			updateRtt(now - ackHeader.transmitTime);
+
+			mSegments.erase(mSegments.begin(), mSegments.begin() + (ack - mUnackedSegment));
+			mUnackedSegment = ack;
+			mDuplicateAckCount = 0;
+			mBackoff = 1.0;
+			mTimerStartTime = now;
+			return;
+		}
+
+		if (ack == mUnackedSegment && !mSegments.empty() && ++mDuplicateAckCount == TCP_DUPLICATE_ACK_THRESHOLD)
+		{
+			transmit(mUnackedSegment, now);
+		}
+	}
+
+	// RFC 6298, 최소값만 리눅스처럼 200ms
+	void updateRtt(const double rtt)
+	{
+		if (!mbHasRttSample)
+		{
+			mSmoothedRtt = rtt;
+			mRttVariance = rtt * 0.5;
+			mbHasRttSample = true;
+		}
+		else
+		{
+			mRttVariance = 0.75 * mRttVariance + 0.25 * std::fabs(mSmoothedRtt - rtt);
+			mSmoothedRtt = 0.875 * mSmoothedRtt + 0.125 * rtt;
+		}
+
+		mResendTimeout = std::max(mSmoothedRtt + 4.0 * mRttVariance, TCP_MIN_RTO);
+	}
+
+private:
+	Impairment::Link mDataLink;
+	Impairment::Link mAckLink;
+
+	// 보내는 쪽: ack 안 된 세그먼트, 앞이 mUnackedSegment
+	std::deque<Segment> mSegments;
+	uint32_t mNextSegment;
+	uint32_t mUnackedSegment;
+	uint32_t mDuplicateAckCount;
+
+	bool mbHasRttSample;
+	double mSmoothedRtt;
+	double mRttVariance;
+	double mResendTimeout;
+
+	// 재전송 타이머가 만료될 때마다 두 배, 새 데이터가 ack되면 되돌림
+	double mBackoff;
+	double mTimerStartTime;
+
+	// 받는 쪽
+	uint32_t mNextExpectedSegment;
+	std::map<uint32_t, std::vector<uint8_t>> mOutOfOrder;
+
+	uint32_t mRetransmitCount;
+};
+
+// App의 USE_UDP가 꺼진 경로: 같은 메시지를 TCP 스트림으로
+static Measurement runTcp(const LinkSettings& settings, const double duration)
+{
+	TcpModel tcp(settings);
+
+	Measurement measurement = {};
+	uint32_t nextTick = 0;
+	double newestSendTime = -1.0;
+
+	for (double now = 0.0; now < duration; now += TIME_STEP)
+	{
+		while (getSendTime(nextTick) <= now)
+		{
+			uint8_t message[Protocol::MAX_MESSAGE_SIZE];
+			const size_t messageSize = writePositionMessage(nextTick, message, sizeof(message));
+			tcp.Send(message, messageSize, now);
+
+			++nextTick;
+			++measurement.sentCount;
+		}
+
+		tcp.Update(now, [&](const uint8_t* pData, const size_t size)
+		{
+			Protocol::MessageView message;
+			size_t length;
+			if (Protocol::ParseMessage(pData, size, message, length) == Protocol::PARSE_OK)
+			{
+				const double sendTime = getSendTime(message.header.tick);
+				measurement.updateLatencies.push_back(now - sendTime);
+				newestSendTime = std::max(newestSendTime, sendTime);
+			}
+		});
+
+		if (newestSendTime >= 0.0)
+		{
+			measurement.stateAges.push_back(now - newestSendTime);
+		}
+	}
+
+	measurement.retransmitCount = tcp.GetRetransmitCount();
+
+	return measurement;
+}
+
+static double getPercentile(std::vector<double>& samples, const double percentile)
+{
+	if (samples.empty())
+	{
+		return 0.0;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	return samples[static_cast<size_t>(percentile * (samples.size() - 1) + 0.5)];
+}
+
+static void printMeasurement(const char* pName, Measurement& measurement)
+{
+	std::cout << "  " << std::left << std::setw(4) << pName << std::right
+		<< " update ms p50 " << std::setw(6) << getPercentile(measurement.updateLatencies, 0.5) * 1e3
+		<< " p99 " << std::setw(6) << getPercentile(measurement.updateLatencies, 0.99) * 1e3
+		<< " max " << std::setw(6) << getPercentile(measurement.updateLatencies, 1.0) * 1e3
+		<< " | state age ms p50 " << std::setw(6) << getPercentile(measurement.stateAges, 0.5) * 1e3
+		<< " p99 " << std::setw(6) << getPercentile(measurement.stateAges, 0.99) * 1e3
+		<< " | delivered " << std::setw(5) << 100.0 * measurement.updateLatencies.size() / measurement.sentCount << "%"
+		<< " | retransmits " << measurement.retransmitCount << std::endl;
+}
+
+// 틱마다 보내는 위치 갱신이 손실 링크에서 얼마나 늦게 반영되는지 UDP(UnreliableSequenced)와 TCP 비교
+// 두 쪽 모두 Impairment::Link로 같은 지연/손실을 줌, TCP는 재전송과 순서 대기만 흉내 낸 모델
+// update: 새 위치가 반영된 시점까지의 시간, state age: 1ms마다 잰 가장 새 위치의 나이
+// 사용법: SimpleNetworkTransportBench [--seconds S] [--delay S] [--jitter S] [--loss P] [--seed N]
+// --loss가 없으면 0, 1, 2, 5, 10%를 차례로 측정
+int main(int argc, char* argv[])
+{
+	double duration = 120.0;
+	LinkSettings settings = { 0.03, 0.005, 0.0, 1 };
+	std::vector<double> lossRates = { 0.0, 0.01, 0.02, 0.05, 0.1 };
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const bool bHasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--seconds") == 0 && bHasValue)
+		{
+			duration = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--delay") == 0 && bHasValue)
+		{
+			settings.delay = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--jitter") == 0 && bHasValue)
+		{
+			settings.jitter = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--loss") == 0 && bHasValue)
+		{
+			lossRates.assign(1, atof(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && bHasValue)
+		{
+			settings.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		}
+		else
+		{
+			std::cerr << "usage: SimpleNetworkTransportBench [--seconds S] [--delay S] [--jitter S] [--loss P] [--seed N]" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << std::fixed << std::setprecision(1);
+
+	for (const double lossRate : lossRates)
+	{
+		settings.lossRate = lossRate;
+
+		std::cout << "loss " << lossRate * 100.0 << "%, one-way delay " << settings.delay * 1e3 << " ms + jitter " << settings.jitter * 1e3 << " ms, "
+			<< Simulation::TICK_RATE_HZ << " updates/s for " << duration << " s" << std::endl;
+
+		Measurement udp = runUdp(settings, duration);
+		Measurement tcp = runTcp(settings, duration);
+
+		printMeasurement("udp", udp);
+		printMeasurement("tcp", tcp);
+	}
+
+	return 0;
+}